@@ -0,0 +1,277 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <vector>
+#include "BinContainer.h"
+#include "CalcPairsCore.h"
+#include "ElementProblemData.h"
+#include "Pairs.h"
+#include "Presolve.h"
+#include "RowSumScreener.h"
+#include "Timer.h"
+
+// Number of thresholds the pairs queries are timed at
+const std::size_t NUM_THRESHOLDS = 8;
+
+// Pairs per chunk of the pair tables, as PAIRS_PER_CHUNK in config.cfg
+const std::size_t PAIRS_PER_CHUNK = 4194304;
+
+struct Result {
+  std::string name;
+  std::size_t ops;
+  std::vector<double> seconds;
+};
+
+//------------------------------------------------------------------------------
+// Runs 'f' 'repeats' times and records the wall time of every run. 'ops' is the
+// number of calls of the benchmarked function a single run makes. 'setup', if
+// given, runs untimed before every run.
+//------------------------------------------------------------------------------
+void time_runs(std::vector<Result> &results,
+               const std::string &name,
+               const std::size_t ops,
+               const std::size_t repeats,
+               const std::function<void()> &f,
+               const std::function<void()> &setup = nullptr) {
+  Result result = {name, ops, std::vector<double>()};
+  Timer timer;
+  for (std::size_t r = 0; r < repeats; ++r) {
+    if (setup) {
+      setup();
+    }
+    timer.restart();
+    f();
+    timer.stop();
+    result.seconds.push_back(timer.elapsed_wall_time());
+  }
+  results.push_back(result);
+}
+
+//------------------------------------------------------------------------------
+// Returns NUM_THRESHOLDS thresholds spread evenly up to the largest number of
+// valid elements in 'lines'.
+//------------------------------------------------------------------------------
+std::vector<unsigned int> spread_thresholds(const BinContainer &data, const bool is_row, const std::vector<std::size_t> &lines) {
+  std::size_t max_valid = 0;
+  for (auto line : lines) {
+    max_valid = std::max(max_valid, is_row ? data.get_num_valid_in_row(line) : data.get_num_valid_in_col(line));
+  }
+
+  std::vector<unsigned int> thresholds;
+  for (std::size_t k = 1; k <= NUM_THRESHOLDS; ++k) {
+    thresholds.push_back(std::max<std::size_t>(1, max_valid * k / NUM_THRESHOLDS));
+  }
+  return thresholds;
+}
+
+//------------------------------------------------------------------------------
+// Times the queries a screening makes on 'pairs' of the free 'lines': the
+// number of partners at or above, and the partners below, every threshold.
+//------------------------------------------------------------------------------
+void time_pairs_queries(std::vector<Result> &results,
+                        const std::string &prefix,
+                        const BinContainer &data,
+                        const bool is_row,
+                        const std::vector<std::size_t> &lines,
+                        const Pairs &pairs,
+                        const std::size_t repeats) {
+  if (lines.size() < 2) {
+    return;
+  }
+
+  const std::vector<unsigned int> thresholds = spread_thresholds(data, is_row, lines);
+  const std::vector<int> valid(lines.size(), 1);
+  const std::size_t ops = thresholds.size() * lines.size();
+
+  // Summed so the queries cannot be optimized away
+  std::size_t checksum = 0;
+
+  time_runs(results, prefix + "Pairs::getNumPairsGteThresh", ops, repeats, [&]() {
+    for (auto thr : thresholds) {
+      for (std::size_t i = 0; i < lines.size(); ++i) {
+        checksum += pairs.getNumPairsGteThresh(i, thr, valid);
+      }
+    }
+  });
+
+  time_runs(results, prefix + "Pairs::getPairsLtThresh", ops, repeats, [&]() {
+    for (auto thr : thresholds) {
+      for (std::size_t i = 0; i < lines.size(); ++i) {
+        checksum += pairs.getPairsLtThresh(i, thr, valid).size();
+      }
+    }
+  });
+}
+
+FILE* open_file_for_write(const std::string &file_name) {
+  FILE* output;
+  if ((output = fopen(file_name.c_str(), "w")) == nullptr) {
+    fprintf(stderr, "ERROR - Could not open file (%s)\n", file_name.c_str());
+    exit(1);
+  }
+  return output;
+}
+
+//------------------------------------------------------------------------------
+// Writes the results as a JSON object with the matrix statistics and, for every
+// benchmark, the number of calls per run and the min, mean and max wall time.
+//------------------------------------------------------------------------------
+void write_json(const std::string &out_file,
+                const std::string &data_file,
+                const BinContainer &data,
+                const Presolve &presolve,
+                const std::size_t repeats,
+                const std::vector<Result> &results) {
+  FILE *output = open_file_for_write(out_file);
+
+  fprintf(output, "{\n");
+  fprintf(output, "  \"data_file\": \"%s\",\n", data_file.c_str());
+  fprintf(output, "  \"num_rows\": %lu,\n", data.get_num_data_rows());
+  fprintf(output, "  \"num_cols\": %lu,\n", data.get_num_data_cols());
+  fprintf(output, "  \"num_missing\": %lu,\n", data.get_num_na());
+  fprintf(output, "  \"sparse\": %s,\n", data.is_sparse() ? "true" : "false");
+  fprintf(output, "  \"num_free_rows\": %lu,\n", presolve.get_free_rows().size());
+  fprintf(output, "  \"num_free_cols\": %lu,\n", presolve.get_free_cols().size());
+  fprintf(output, "  \"incumbent_num_elements\": %lu,\n", presolve.get_incumbent_num_elements());
+  fprintf(output, "  \"repeats\": %lu,\n", repeats);
+  fprintf(output, "  \"benchmarks\": [\n");
+
+  for (std::size_t b = 0; b < results.size(); ++b) {
+    const Result &result = results[b];
+    double sum = 0.0;
+    for (auto s : result.seconds) {
+      sum += s;
+    }
+    fprintf(output, "    {\"name\": \"%s\", \"ops\": %lu, \"min_seconds\": %f, \"mean_seconds\": %f, \"max_seconds\": %f}%s\n",
+            result.name.c_str(),
+            result.ops,
+            *std::min_element(result.seconds.begin(), result.seconds.end()),
+            sum / result.seconds.size(),
+            *std::max_element(result.seconds.begin(), result.seconds.end()),
+            (b + 1 < results.size()) ? "," : "");
+  }
+
+  fprintf(output, "  ]\n");
+  fprintf(output, "}\n");
+  fclose(output);
+}
+
+//------------------------------------------------------------------------------
+// Times the stages of a run on 'data_file' in a single process: reading the
+// matrix, the presolve, counting the pairs, reading the pair tables, the pairs
+// queries, screening every row_sum the scheduler would start with and writing
+// the presolve incumbent. Every stage is run 'repeats' times and the results
+// are written to 'out_json'. The scratch directory is filled as calcPairs
+// would, so it can be passed on to elementIp.
+//------------------------------------------------------------------------------
+int main(int argc, char *argv[]) {
+  if (argc < 5 || argc > 6) {
+    fprintf(stderr, "Usage: %s <data_file> <na_symbol> <scratch_dir> <out_json> (opt)<repeats>\n", argv[0]);
+    exit(1);
+  }
+
+  const std::string data_file(argv[1]);
+  const std::string na_symbol(argv[2]);
+  const std::string scratch_dir(argv[3]);
+  const std::string out_json(argv[4]);
+  const std::size_t repeats = (argc > 5) ? std::stoul(argv[5]) : 3;
+
+  if (repeats < 1) {
+    fprintf(stderr, "ERROR - repeats must be at least 1\n");
+    exit(1);
+  }
+
+  std::vector<Result> results;
+
+  time_runs(results, "BinContainer::read", 1, repeats, [&]() {
+    BinContainer tmp(data_file, na_symbol);
+  });
+  BinContainer data(data_file, na_symbol);
+
+  time_runs(results, "Presolve::run", 1, repeats, [&]() {
+    Presolve tmp(data);
+    tmp.run();
+  });
+  Presolve presolve(data);
+  presolve.run();
+  presolve.write(scratch_dir);
+
+  std::vector<std::size_t> row_weights;
+  for (auto &members : presolve.get_row_classes()) {
+    row_weights.push_back(members.size());
+  }
+  std::vector<std::size_t> col_weights;
+  for (auto &members : presolve.get_col_classes()) {
+    col_weights.push_back(members.size());
+  }
+
+  // Every repeat counts every chunk, rather than keeping those of the last one
+  CalcPairsCore core(data,
+                     scratch_dir,
+                     presolve.get_forced_one_rows().size(),
+                     presolve.get_forced_one_cols().size(),
+                     presolve.get_free_rows(),
+                     presolve.get_free_cols(),
+                     row_weights,
+                     col_weights,
+                     PAIRS_PER_CHUNK,
+                     false);
+  time_runs(results, "CalcPairsCore::work", 1, repeats, [&]() {
+    core.work();
+  });
+
+  // Combining removes the chunks, so they are counted again before every run
+  time_runs(results, "CalcPairsCore::combine", 1, repeats, [&]() {
+    core.combine();
+  }, [&]() {
+    core.work();
+  });
+
+  time_runs(results, "ElementProblemData::read", 1, repeats, [&]() {
+    ElementProblemData tmp(data, scratch_dir);
+  });
+  ElementProblemData problem(data, scratch_dir);
+
+  time_pairs_queries(results, "row ", data, true, problem.get_free_rows(), problem.get_row_pairs(), repeats);
+  time_pairs_queries(results, "col ", data, false, problem.get_free_cols(), problem.get_col_pairs(), repeats);
+
+  // Screen every row_sum whose initial bound beats the incumbent, with the
+  // min_cols the scheduler would send it
+  const std::size_t num_rows = data.get_num_data_rows();
+  const std::size_t incumbent = presolve.get_incumbent_num_elements();
+  const std::vector<std::size_t> max_cols_possible = RowSumScreener::calc_max_cols_possible(data);
+  std::vector<std::size_t> row_sums;
+  for (std::size_t row_sum = std::max<std::size_t>(1, problem.get_forced_one_rows().size()); row_sum <= num_rows; ++row_sum) {
+    if (row_sum * max_cols_possible[row_sum-1] > incumbent) {
+      row_sums.push_back(row_sum);
+    }
+  }
+
+  RowSumScreener screener(data,
+                          problem.get_forced_one_rows(),
+                          problem.get_forced_one_cols(),
+                          problem.get_free_rows(),
+                          problem.get_free_cols(),
+                          problem.get_row_weights(),
+                          problem.get_col_weights(),
+                          problem.get_row_pairs(),
+                          problem.get_col_pairs());
+  time_runs(results, "RowSumScreener::screen", row_sums.size(), repeats, [&]() {
+    for (auto row_sum : row_sums) {
+      screener.screen(row_sum, (incumbent / row_sum) + 1);
+    }
+  });
+
+  std::vector<bool> rows_to_keep(num_rows, false);
+  std::vector<bool> cols_to_keep(data.get_num_data_cols(), false);
+  presolve.restore_incumbent(rows_to_keep, cols_to_keep);
+  time_runs(results, "BinContainer::write_orig", 1, repeats, [&]() {
+    data.write_orig(scratch_dir + "benchIncumbent.tsv", rows_to_keep, cols_to_keep);
+  });
+
+  write_json(out_json, data_file, data, presolve, repeats, results);
+
+  return 0;
+}
@@ -0,0 +1,172 @@
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------
+// Draws uniform and normal numbers from the raw output of std::mt19937_64,
+// which unlike the standard distributions is the same on every platform, so a
+// seed always gives the same matrix.
+//------------------------------------------------------------------------------
+class Random
+{
+private:
+  std::mt19937_64 engine;
+
+public:
+  Random(const std::uint64_t seed) : engine(seed) {}
+
+  // Uniform in [0, 1)
+  double uniform() {
+    return (engine() >> 11) * (1.0 / 9007199254740992.0);
+  }
+
+  // Uniform in [0, n)
+  std::size_t index(const std::size_t n) {
+    return static_cast<std::size_t>(uniform() * n);
+  }
+
+  // Standard normal, by the Box-Muller transform
+  double normal() {
+    const double u = 1.0 - uniform();
+    const double v = uniform();
+    return std::sqrt(-2.0 * std::log(u)) * std::cos(6.283185307179586 * v);
+  }
+};
+
+//------------------------------------------------------------------------------
+// Returns a log-normal factor with spread 'skew' for each of 'n' lines,
+// scaled to a mean of one. A skew of zero gives every line the same factor.
+//------------------------------------------------------------------------------
+std::vector<double> line_factors(Random &rng, const std::size_t n, const double skew) {
+  std::vector<double> factor(n);
+  double sum = 0.0;
+  for (std::size_t i = 0; i < n; ++i) {
+    factor[i] = std::exp(skew * rng.normal());
+    sum += factor[i];
+  }
+  for (std::size_t i = 0; i < n; ++i) {
+    factor[i] *= n / sum;
+  }
+  return factor;
+}
+
+//------------------------------------------------------------------------------
+// Writes a synthetic matrix with a header row and header column for benchmarks.
+// Cell (i, j) is missing with probability 'missing_rate' scaled by a factor for
+// row i and one for column j, drawn with spreads 'row_skew' and 'col_skew'.
+// With 'num_blocks' > 1 the rows and columns are split into that many
+// contiguous blocks and a cell can only be missing when its row and column are
+// in the same block, at a rate scaled up so the overall rate is unchanged.
+// Each row (then column) other than the first copies the pattern of a random
+// earlier one with probability 'dup_rate'.
+//------------------------------------------------------------------------------
+int main(int argc, char *argv[]) {
+  if (argc < 5 || argc > 10) {
+    fprintf(stderr, "Usage: %s <out_file> <num_rows> <num_cols> <missing_rate> (opt)<seed> (opt)<row_skew> (opt)<col_skew> (opt)<num_blocks> (opt)<dup_rate>\n", argv[0]);
+    exit(1);
+  }
+
+  const std::string out_file(argv[1]);
+  const std::size_t num_rows = std::stoul(argv[2]);
+  const std::size_t num_cols = std::stoul(argv[3]);
+  const double missing_rate = std::stod(argv[4]);
+  const std::uint64_t seed = (argc > 5) ? std::stoull(argv[5]) : 0;
+  const double row_skew = (argc > 6) ? std::stod(argv[6]) : 0.0;
+  const double col_skew = (argc > 7) ? std::stod(argv[7]) : 0.0;
+  const std::size_t num_blocks = (argc > 8) ? std::stoul(argv[8]) : 1;
+  const double dup_rate = (argc > 9) ? std::stod(argv[9]) : 0.0;
+
+  if (num_rows < 1 || num_cols < 1) {
+    fprintf(stderr, "ERROR - The matrix must have at least one row and one column\n");
+    exit(1);
+  }
+  if (missing_rate < 0.0 || missing_rate > 1.0 || dup_rate < 0.0 || dup_rate > 1.0) {
+    fprintf(stderr, "ERROR - missing_rate and dup_rate must be between 0 and 1\n");
+    exit(1);
+  }
+  if (row_skew < 0.0 || col_skew < 0.0) {
+    fprintf(stderr, "ERROR - row_skew and col_skew must not be negative\n");
+    exit(1);
+  }
+  if (num_blocks < 1 || num_blocks > num_rows || num_blocks > num_cols) {
+    fprintf(stderr, "ERROR - num_blocks must be between 1 and the number of rows and columns\n");
+    exit(1);
+  }
+
+  Random rng(seed);
+  const std::vector<double> row_factor = line_factors(rng, num_rows, row_skew);
+  const std::vector<double> col_factor = line_factors(rng, num_cols, col_skew);
+  const double block_rate = missing_rate * num_blocks;
+
+  // One bit per cell, set if the cell is missing
+  const std::size_t num_words = (num_cols + 63) / 64;
+  std::vector<std::vector<std::uint64_t>> missing(num_rows, std::vector<std::uint64_t>(num_words, 0));
+
+  for (std::size_t i = 0; i < num_rows; ++i) {
+    const std::size_t row_block = i * num_blocks / num_rows;
+    for (std::size_t j = 0; j < num_cols; ++j) {
+      if (j * num_blocks / num_cols != row_block) {
+        continue;
+      }
+      if (rng.uniform() < block_rate * row_factor[i] * col_factor[j]) {
+        missing[i][j / 64] |= (1ULL << (j % 64));
+      }
+    }
+  }
+
+  if (dup_rate > 0.0) {
+    for (std::size_t i = 1; i < num_rows; ++i) {
+      if (rng.uniform() < dup_rate) {
+        missing[i] = missing[rng.index(i)];
+      }
+    }
+    for (std::size_t j = 1; j < num_cols; ++j) {
+      if (rng.uniform() < dup_rate) {
+        const std::size_t k = rng.index(j);
+        for (std::size_t i = 0; i < num_rows; ++i) {
+          if ((missing[i][k / 64] >> (k % 64)) & 1ULL) {
+            missing[i][j / 64] |= (1ULL << (j % 64));
+          } else {
+            missing[i][j / 64] &= ~(1ULL << (j % 64));
+          }
+        }
+      }
+    }
+  }
+
+  FILE *output;
+  if ((output = fopen(out_file.c_str(), "w")) == nullptr) {
+    fprintf(stderr, "ERROR - Could not open file (%s)\n", out_file.c_str());
+    exit(1);
+  }
+
+  fprintf(output, "id");
+  for (std::size_t j = 0; j < num_cols; ++j) {
+    fprintf(output, "\tc%lu", j);
+  }
+  fprintf(output, "\n");
+
+  std::size_t num_missing = 0;
+  for (std::size_t i = 0; i < num_rows; ++i) {
+    fprintf(output, "r%lu", i);
+    for (std::size_t j = 0; j < num_cols; ++j) {
+      if ((missing[i][j / 64] >> (j % 64)) & 1ULL) {
+        fputs("\tNA", output);
+        ++num_missing;
+      } else {
+        fputs("\t1", output);
+      }
+    }
+    fputc('\n', output);
+  }
+  fclose(output);
+
+  printf("Wrote %lu x %lu matrix with %lu missing (%f) to %s\n", num_rows, num_cols, num_missing,
+         static_cast<double>(num_missing) / (num_rows * num_cols), out_file.c_str());
+
+  return 0;
+}
@@ -0,0 +1,182 @@
+#include "AddRowGreedy.h"
+#include <algorithm>
+#include <numeric>
+#include "ThreadPool.h"
+#include "Utils.h"
+
+//------------------------------------------------------------------------------
+// Constructor.
+//------------------------------------------------------------------------------
+AddRowGreedy::AddRowGreedy(const BinContainer &_data) : data(&_data),
+                                                        num_rows(data->get_num_data_rows()),
+                                                        num_cols(data->get_num_data_cols()),
+                                                        best_num_elements(0),
+                                                        best_start(0),
+                                                        best_rows_to_keep(num_rows, false),
+                                                        best_cols_to_keep(num_cols, false) {}
+
+//------------------------------------------------------------------------------
+// Destructor.
+//------------------------------------------------------------------------------
+AddRowGreedy::~AddRowGreedy() {}
+
+//------------------------------------------------------------------------------
+// Returns the rows ordered by increasing number of missing elements.
+//------------------------------------------------------------------------------
+std::vector<std::size_t> AddRowGreedy::order_by_missing() const {
+  std::vector<std::size_t> order(num_rows);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [this](const std::size_t lhs, const std::size_t rhs) {
+    return data->get_num_invalid_in_row(lhs) < data->get_num_invalid_in_row(rhs);
+  });
+  return order;
+}
+
+//------------------------------------------------------------------------------
+// Returns an ordering that starts with 'seed' and then adds the remaining rows
+// by increasing number of the seed's complete columns they would remove. Ties
+// keep the order of 'base_order'.
+//------------------------------------------------------------------------------
+std::vector<std::size_t> AddRowGreedy::order_from_seed(const std::size_t seed,
+                                                       const std::vector<std::size_t> &base_order) const {
+  const std::vector<std::uint64_t> &seed_bits = data->get_row_bits(seed);
+  std::vector<std::pair<std::size_t, std::size_t>> cost;
+  cost.reserve(num_rows - 1);
+
+  for (auto i : base_order) {
+    if (i == seed) continue;
+
+    const std::vector<std::uint64_t> &row_bits = data->get_row_bits(i);
+    std::size_t num_removed = 0;
+    for (std::size_t w = 0; w < seed_bits.size(); ++w) {
+      num_removed += __builtin_popcountll(seed_bits[w] & ~row_bits[w]);
+    }
+    cost.push_back(std::make_pair(num_removed, i));
+  }
+  std::stable_sort(cost.begin(), cost.end(), utils::SortPairByFirstItemIncreasing());
+
+  std::vector<std::size_t> order;
+  order.reserve(num_rows);
+  order.push_back(seed);
+  for (auto &c : cost) {
+    order.push_back(c.second);
+  }
+  return order;
+}
+
+//------------------------------------------------------------------------------
+// Adds the rows of 'order' one at a time while keeping a bitmask of the
+// columns that are still complete, so each prefix is scored with one AND and
+// popcount over the column words. Returns the length of the prefix with the
+// most elements and stores that number of elements in 'num_elements'.
+//------------------------------------------------------------------------------
+std::size_t AddRowGreedy::find_best_prefix(const std::vector<std::size_t> &order, std::size_t &num_elements) const {
+  std::vector<std::uint64_t> surviving_cols(data->get_num_row_words(), ~std::uint64_t(0));
+  std::size_t best_len = 0;
+  num_elements = 0;
+
+  for (std::size_t k = 0; k < order.size(); ++k) {
+    const std::size_t num_surviving = utils::and_count_bits(surviving_cols, data->get_row_bits(order[k]));
+    if (num_surviving == 0) {
+      break;
+    }
+    if ((k + 1) * num_surviving > num_elements) {
+      num_elements = (k + 1) * num_surviving;
+      best_len = k + 1;
+    }
+  }
+
+  return best_len;
+}
+
+//------------------------------------------------------------------------------
+// Stores the first 'prefix_len' rows of 'order' and their complete columns as
+// the solution.
+//------------------------------------------------------------------------------
+void AddRowGreedy::keep_prefix(const std::vector<std::size_t> &order, const std::size_t prefix_len) {
+  std::vector<std::uint64_t> surviving_cols(data->get_num_row_words(), ~std::uint64_t(0));
+
+  best_rows_to_keep.assign(num_rows, false);
+  for (std::size_t k = 0; k < prefix_len; ++k) {
+    utils::and_count_bits(surviving_cols, data->get_row_bits(order[k]));
+    best_rows_to_keep[order[k]] = true;
+  }
+
+  for (std::size_t j = 0; j < num_cols; ++j) {
+    best_cols_to_keep[j] = (prefix_len > 0) &&
+                           ((surviving_cols[j / BinContainer::BITS_PER_WORD] >> (j % BinContainer::BITS_PER_WORD)) & 1);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Runs the greedy from 'num_starts' row orderings and keeps the best solution.
+// Start 0 orders the rows by missingness; start s > 0 seeds the ordering with
+// the s-th least missing row. The starts are spread over 'num_threads' threads.
+//------------------------------------------------------------------------------
+void AddRowGreedy::solve(const std::size_t num_starts, const std::size_t num_threads) {
+  if (num_rows == 0 || num_cols == 0) {
+    return;
+  }
+
+  const std::vector<std::size_t> base_order = order_by_missing();
+  const std::size_t starts = std::max<std::size_t>(1, std::min(num_starts, num_rows + 1));
+
+  std::vector<std::size_t> num_elements(starts, 0), prefix_len(starts, 0);
+  auto run_start = [&](const std::size_t s) {
+    if (s == 0) {
+      prefix_len[s] = find_best_prefix(base_order, num_elements[s]);
+    } else {
+      prefix_len[s] = find_best_prefix(order_from_seed(base_order[s-1], base_order), num_elements[s]);
+    }
+  };
+
+  if (num_threads > 1 && starts > 1) {
+    ThreadPool pool(std::min(num_threads, starts));
+    for (std::size_t s = 0; s < starts; ++s) {
+      pool.submit([&run_start, s] { run_start(s); });
+    }
+    pool.wait();
+  } else {
+    for (std::size_t s = 0; s < starts; ++s) {
+      run_start(s);
+    }
+  }
+
+  best_start = 0;
+  for (std::size_t s = 1; s < starts; ++s) {
+    if (num_elements[s] > num_elements[best_start]) {
+      best_start = s;
+    }
+  }
+  best_num_elements = num_elements[best_start];
+
+  if (best_start == 0) {
+    keep_prefix(base_order, prefix_len[0]);
+  } else {
+    keep_prefix(order_from_seed(base_order[best_start-1], base_order), prefix_len[best_start]);
+  }
+}
+
+std::vector<bool> AddRowGreedy::get_rows_to_keep() const {
+  return best_rows_to_keep;
+}
+
+std::vector<bool> AddRowGreedy::get_cols_to_keep() const {
+  return best_cols_to_keep;
+}
+
+std::size_t AddRowGreedy::get_num_rows_to_keep() const {
+  return std::count(best_rows_to_keep.begin(), best_rows_to_keep.end(), true);
+}
+
+std::size_t AddRowGreedy::get_num_cols_to_keep() const {
+  return std::count(best_cols_to_keep.begin(), best_cols_to_keep.end(), true);
+}
+
+std::size_t AddRowGreedy::get_num_elements_to_keep() const {
+  return best_num_elements;
+}
+
+std::size_t AddRowGreedy::get_best_start() const {
+  return best_start;
+}
@@ -0,0 +1,38 @@
+#ifndef ADD_ROW_GREEDY_H
+#define ADD_ROW_GREEDY_H
+
+#include <vector>
+#include "BinContainer.h"
+
+class AddRowGreedy
+{
+private:
+  const BinContainer *data;
+  const std::size_t num_rows;
+  const std::size_t num_cols;
+
+  std::size_t best_num_elements;
+  std::size_t best_start;
+  std::vector<bool> best_rows_to_keep;
+  std::vector<bool> best_cols_to_keep;
+
+  std::vector<std::size_t> order_by_missing() const;
+  std::vector<std::size_t> order_from_seed(const std::size_t seed, const std::vector<std::size_t> &base_order) const;
+  std::size_t find_best_prefix(const std::vector<std::size_t> &order, std::size_t &num_elements) const;
+  void keep_prefix(const std::vector<std::size_t> &order, const std::size_t prefix_len);
+
+public:
+  AddRowGreedy(const BinContainer &_data);
+  ~AddRowGreedy();
+
+  void solve(const std::size_t num_starts = 1, const std::size_t num_threads = 1);
+
+  std::vector<bool> get_rows_to_keep() const;
+  std::vector<bool> get_cols_to_keep() const;
+  std::size_t get_num_rows_to_keep() const;
+  std::size_t get_num_cols_to_keep() const;
+  std::size_t get_num_elements_to_keep() const;
+  std::size_t get_best_start() const;
+};
+
+#endif
@@ -0,0 +1,81 @@
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <algorithm>
+#include "BinContainer.h"
+#include "AddRowGreedy.h"
+#include "Timer.h"
+#include "PhaseTimer.h"
+#include "ConfigParser.h"
+#include "NoMissSummary.h"
+
+int main(int argc, char *argv[]) {
+
+// Check user input
+  if (!((argc == 3) || (argc == 5))) {
+    fprintf(stderr, "Usage: %s <data_file> <na_symbol> (opt)<num_header_rows> (opt)<num_header_cols>\n", argv[0]);
+    exit(1);
+  }
+  std::string data_file(argv[1]);
+  std::string na_symbol(argv[2]);
+  std::size_t num_header_rows = 1;
+  std::size_t num_header_cols = 1;
+
+  if (argc == 5) {
+    num_header_rows = std::stoul(argv[3]);
+    num_header_cols = std::stoul(argv[4]);
+  }
+  
+  ConfigParser parser("config.cfg");
+  const bool PRINT_SUMMARY = parser.getBool("PRINT_SUMMARY");
+  const bool WRITE_STATS = parser.getBool("WRITE_STATS");
+  const std::size_t GREEDY_STARTS = parser.getSizeT("GREEDY_STARTS");
+  std::size_t NUM_THREADS = parser.getSizeT("NUM_THREADS");
+
+  if (NUM_THREADS == 0) {
+    NUM_THREADS = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  Timer timer;
+
+  // Read in data
+  BinContainer data(data_file, na_symbol, num_header_rows, num_header_cols);
+
+  // Run the greedy from every start
+  std::size_t num_rows_to_keep = 0, num_cols_to_keep = 0, num_val_elements = 0;
+  double run_time = 0.0;
+  std::vector<bool> rows_to_keep(data.get_num_data_rows(), false), cols_to_keep(data.get_num_data_cols(), false);
+
+  AddRowGreedy greedy(data);
+  timer.start();
+  greedy.solve(GREEDY_STARTS, NUM_THREADS);
+  timer.stop();
+  fprintf(stderr, "Best solution found by start %lu\n", greedy.get_best_start());
+
+  rows_to_keep = greedy.get_rows_to_keep();
+  cols_to_keep = greedy.get_cols_to_keep();
+  num_rows_to_keep = greedy.get_num_rows_to_keep();
+  num_cols_to_keep = greedy.get_num_cols_to_keep();
+  // CPU time is summed over all threads, so the wall time is reported instead
+  run_time = timer.elapsed_wall_time();
+  num_val_elements = data.get_num_valid_data_kept(rows_to_keep, cols_to_keep);
+
+  // Record results
+  if (PRINT_SUMMARY) {
+    noMissSummary::summarize_results(data, na_symbol, "AddRowGreedy", run_time, num_rows_to_keep, num_cols_to_keep, rows_to_keep, cols_to_keep);
+  }
+
+  // Wrtie statistics to file
+  if (WRITE_STATS) {
+    noMissSummary::write_stats_to_file("AddRowGreedy_summary.csv", data_file, timer.elapsed_cpu_time(), run_time, num_val_elements, num_rows_to_keep, num_cols_to_keep);
+  }
+
+  noMissSummary::write_solution_to_file("AddRowGreedy.sol", rows_to_keep, cols_to_keep);
+
+  if (WRITE_STATS) {
+    PhaseTimer::write_to_file("AddRowGreedy_phases.csv", data_file);
+  }
+
+  return 0;
+}
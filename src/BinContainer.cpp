@@ -1,4 +1,5 @@
 #include "BinContainer.h"
+#include "PhaseTimer.h"
 #include <fstream>
 #include <sstream>
 #include <algorithm>
@@ -9,9 +10,18 @@ BinContainer::BinContainer(const std::string &_file_name,
                            const std::size_t _num_header_cols) :  file_name(_file_name),
                                                                   na_symbol(_na_symbol),
                                                                   num_header_rows(_num_header_rows),
-                                                                  num_header_cols(_num_header_cols) {
+                                                                  num_header_cols(_num_header_cols),
+                                                                  num_data_rows(0),
+                                                                  num_data_cols(0),
+                                                                  sparse(false) {
+  PhaseTimer parse_timer("parse");
   read();
+  parse_timer.stop();
+
+  PhaseTimer valid_timer("calc_num_valid");
   calc_num_valid();
+  build_bitsets();
+  build_na_lists();
 }
 
 BinContainer::~BinContainer() {}
@@ -42,17 +52,14 @@ void BinContainer::read() {
       }
     }
 
-  const std::size_t num_data_rows = num_rows - num_header_rows;
-  const std::size_t num_data_cols = num_cols - num_header_cols;
+  num_data_rows = num_rows - num_header_rows;
+  num_data_cols = num_cols - num_header_cols;
 
   fprintf(stderr, "Num rows: %lu\n", num_rows);
   fprintf(stderr, "Num cols: %lu\n", num_cols);
 
   // Allocate memory
-  std::vector<bool> data_row(num_data_cols);
-  for (std::size_t i = 0; i < num_data_rows; ++i) {
-    data.push_back(data_row);
-  }
+  row_bits.assign(num_data_rows, std::vector<std::uint64_t>(get_num_row_words(), 0));
   fprintf(stderr, "Allocated memory\n");
 
   // Read in data
@@ -73,10 +80,8 @@ void BinContainer::read() {
       std::getline(iss, token, '\t');
       token = trim(token);
 
-      if (token.compare(na_symbol) == 0) {
-        data[i][j] = false;
-      } else {
-        data[i][j] = true;
+      if (token.compare(na_symbol) != 0) {
+        row_bits[i][j / BITS_PER_WORD] |= (std::uint64_t(1) << (j % BITS_PER_WORD));
       }
     }
   }
@@ -98,6 +103,60 @@ void BinContainer::calc_num_valid() {
   }
 }
 
+// Packs the valid flags of every column into 64-bit words, from the row
+// bitsets read from the file, so that sets of rows can be intersected one word
+// at a time as sets of columns are.
+void BinContainer::build_bitsets() {
+  const std::size_t num_rows = get_num_data_rows();
+
+  col_bits.assign(get_num_data_cols(), std::vector<std::uint64_t>(get_num_col_words(), 0));
+
+  for (std::size_t i = 0; i < num_rows; ++i) {
+    utils::for_each_set_bit(row_bits[i], [&](const std::size_t j) {
+      col_bits[j][i / BITS_PER_WORD] |= (std::uint64_t(1) << (i % BITS_PER_WORD));
+    });
+  }
+}
+
+// Lists the missing positions of every row and every column when there are
+// fewer of them than bitset words. Visiting them then costs O(NA) rather than
+// O(M*N/64), which matters for large, nearly complete matrices.
+void BinContainer::build_na_lists() {
+  const std::size_t num_rows = get_num_data_rows();
+  const std::size_t num_cols = get_num_data_cols();
+
+  sparse = (get_num_na() * BITS_PER_WORD < get_num_data());
+  if (!sparse) {
+    return;
+  }
+
+  row_na_start.assign(num_rows + 1, 0);
+  col_na_start.assign(num_cols + 1, 0);
+  for (std::size_t i = 0; i < num_rows; ++i) {
+    row_na_start[i + 1] = row_na_start[i] + get_num_invalid_in_row(i);
+  }
+  for (std::size_t j = 0; j < num_cols; ++j) {
+    col_na_start[j + 1] = col_na_start[j] + get_num_invalid_in_col(j);
+  }
+
+  row_na.resize(row_na_start[num_rows]);
+  col_na.resize(col_na_start[num_cols]);
+
+  // Filling the columns row by row keeps every column list sorted
+  std::vector<std::size_t> col_fill(col_na_start.begin(), col_na_start.end() - 1);
+  for (std::size_t i = 0; i < num_rows; ++i) {
+    std::size_t k = row_na_start[i];
+    utils::for_each_unset_bit(row_bits[i], num_cols, [&](const std::size_t j) {
+      row_na[k++] = j;
+      col_na[col_fill[j]++] = i;
+    });
+  }
+
+  #ifndef NDEBUG
+    fprintf(stderr, "Built sparse NA lists (%lu missing elements)\n", row_na.size());
+  #endif
+}
+
 std::string BinContainer::trim(std::string &str) const {
   size_t first = str.find_first_not_of(' ');
   if (std::string::npos == first) {
@@ -116,11 +175,11 @@ std::size_t BinContainer::get_num_header_cols() const {
 }
 
 std::size_t BinContainer::get_num_data_rows() const {
-  return data.size();
+  return num_data_rows;
 }
 
 std::size_t BinContainer::get_num_data_cols() const {
-  return data.empty() ? 0 : data[0].size();
+  return num_data_rows == 0 ? 0 : num_data_cols;
 }
 
 std::size_t BinContainer::get_num_data() const {
@@ -129,12 +188,8 @@ std::size_t BinContainer::get_num_data() const {
 
 std::size_t BinContainer::get_num_valid_data() const {
   std::size_t count = 0;
-  for (std::size_t i = 0; i < get_num_data_rows(); ++i) {
-    for (std::size_t j = 0; j < get_num_data_cols(); ++j) {
-      if (data[i][j]) {
-        ++count;
-      }
-    }
+  for (auto num_valid : num_valid_rows) {
+    count += num_valid;
   }
   return count;
 }
@@ -152,15 +207,14 @@ std::size_t BinContainer::get_num_valid_data_kept(const std::vector<bool> &keep_
     exit(EXIT_FAILURE);
   }
 
+  // Every kept element is valid unless it is in the NA list of a kept row
+  const std::size_t num_cols_kept = std::count(keep_col.begin(), keep_col.end(), true);
   std::size_t count = 0;
   for (std::size_t i = 0; i < get_num_data_rows(); ++i) {
     if (!keep_row[i]) { continue; }
 
-    for (std::size_t j = 0; j < get_num_data_cols(); ++j) {
-      if (keep_col[j] && !is_data_na(i, j)) {
-        ++count;
-      }
-    }
+    count += num_cols_kept;
+    for_each_na_in_row(i, [&](const std::size_t j) { count -= keep_col[j]; });
   }
   return count; 
 }
@@ -178,15 +232,13 @@ std::size_t BinContainer::get_num_valid_data_kept(const std::vector<int> &keep_r
     exit(EXIT_FAILURE);
   }
 
+  const std::size_t num_cols_kept = std::count(keep_col.begin(), keep_col.end(), 1);
   std::size_t count = 0;
   for (std::size_t i = 0; i < get_num_data_rows(); ++i) {
     if (keep_row[i] == 0) { continue; }
 
-    for (std::size_t j = 0; j < get_num_data_cols(); ++j) {
-      if ((keep_col[j]==1) && !is_data_na(i, j)) {
-        ++count;
-      }
-    }
+    count += num_cols_kept;
+    for_each_na_in_row(i, [&](const std::size_t j) { count -= (keep_col[j] == 1); });
   }
   return count; 
 }
@@ -196,7 +248,7 @@ std::size_t BinContainer::get_num_invalid_in_row(const std::size_t row) const {
     fprintf(stderr, "ERROR - BinContainer::get_num_invalid_in_row - Trying to access index out of bounds\n");
     exit(EXIT_FAILURE);
   }
-  return get_num_data_rows() - num_valid_rows[row];
+  return get_num_data_cols() - num_valid_rows[row];
 }
 
 std::size_t BinContainer::get_num_invalid_in_col(const std::size_t col) const {
@@ -204,7 +256,7 @@ std::size_t BinContainer::get_num_invalid_in_col(const std::size_t col) const {
     fprintf(stderr, "ERROR - BinContainer::get_num_invalid_in_col - Trying to access index out of bounds\n");
     exit(EXIT_FAILURE);
   }
-  return get_num_data_cols() - num_valid_cols[col];
+  return get_num_data_rows() - num_valid_cols[col];
 }
 
 std::size_t BinContainer::get_num_valid_in_row(const std::size_t row) const {
@@ -292,12 +344,81 @@ double BinContainer::get_min_perc_miss_col() const {
 }
 
 bool BinContainer::is_data_na(const std::size_t i, const std::size_t j) const {
-  return !data[i][j];
+  return !((row_bits[i][j / BITS_PER_WORD] >> (j % BITS_PER_WORD)) & 1);
+}
+
+// Number of words in each row bitset (one bit per column)
+std::size_t BinContainer::get_num_row_words() const {
+  return (get_num_data_cols() + BITS_PER_WORD - 1) / BITS_PER_WORD;
+}
+
+// Number of words in each column bitset (one bit per row)
+std::size_t BinContainer::get_num_col_words() const {
+  return (get_num_data_rows() + BITS_PER_WORD - 1) / BITS_PER_WORD;
+}
+
+const std::vector<std::uint64_t>& BinContainer::get_row_bits(const std::size_t row) const {
+  return row_bits[row];
+}
+
+// Returns a 64-bit FNV-1a hash of the dimensions and the valid elements of the
+// matrix, so that files written for it can tell a corrected matrix with the
+// same size and number of valid elements from the original.
+std::uint64_t BinContainer::get_content_hash() const {
+  std::uint64_t hash = 14695981039346656037ULL;
+  auto add = [&hash](const void *bytes, const std::size_t num_bytes) {
+    const unsigned char *p = static_cast<const unsigned char *>(bytes);
+    for (std::size_t i = 0; i < num_bytes; ++i) {
+      hash = (hash ^ p[i]) * 1099511628211ULL;
+    }
+  };
+
+  add(&num_data_rows, sizeof(num_data_rows));
+  add(&num_data_cols, sizeof(num_data_cols));
+  for (auto &bits : row_bits) {
+    add(bits.data(), bits.size() * sizeof(std::uint64_t));
+  }
+  return hash;
+}
+
+const std::vector<std::uint64_t>& BinContainer::get_col_bits(const std::size_t col) const {
+  return col_bits[col];
+}
+
+bool BinContainer::is_sparse() const {
+  return sparse;
+}
+
+std::size_t BinContainer::get_num_na() const {
+  std::size_t num_na = 0;
+  for (std::size_t i = 0; i < get_num_data_rows(); ++i) {
+    num_na += get_num_invalid_in_row(i);
+  }
+  return num_na;
+}
+
+// The NA lists only exist for sparse matrices; use for_each_na_in_row/col to
+// visit the missing positions of any matrix
+const std::size_t* BinContainer::get_row_na_begin(const std::size_t row) const {
+  return row_na.data() + row_na_start[row];
+}
+
+const std::size_t* BinContainer::get_row_na_end(const std::size_t row) const {
+  return row_na.data() + row_na_start[row + 1];
+}
+
+const std::size_t* BinContainer::get_col_na_begin(const std::size_t col) const {
+  return col_na.data() + col_na_start[col];
+}
+
+const std::size_t* BinContainer::get_col_na_end(const std::size_t col) const {
+  return col_na.data() + col_na_start[col + 1];
 }
 
 void BinContainer::write_orig(const std::string &out_file,
                               const std::vector<bool> &rows_to_keep,
                               const std::vector<bool> &cols_to_keep) const {
+  PhaseTimer write_timer("write");
   if (get_num_data_rows() != rows_to_keep.size()) {
     fprintf(stderr, "ERROR - BinContainer::write_orig - Size of 'rows_to_keep' does not match the number of data rows\n");
     exit(EXIT_FAILURE);
@@ -431,7 +552,7 @@ void BinContainer::print_stats() const {
 
   for (std::size_t i = 0; i < M; ++i) {
     for (std::size_t j = 0; j < N; ++j) {
-      if (!data[i][j]) {
+      if (is_data_na(i, j)) {
         ++perc_miss_row[i];
         ++total_perc_miss;
       }
@@ -441,7 +562,7 @@ void BinContainer::print_stats() const {
 
   for (std::size_t j = 0; j < N; ++j) {
     for (std::size_t i = 0; i < M; ++i) {    
-      if (!data[i][j]) {
+      if (is_data_na(i, j)) {
         ++perc_miss_col[j];
       }
     }
@@ -1,8 +1,11 @@
 #ifndef BIN_CONTAINER_H
 #define BIN_CONTAINER_H
 
+#include <cstdint>
 #include <string>
 #include <vector>
+#include "Utils.h"
+
 class BinContainer {
 private:
   const std::string file_name;
@@ -13,10 +16,27 @@ private:
   std::vector<std::size_t> num_valid_rows;
   std::vector<std::size_t> num_valid_cols;
 
-  std::vector<std::vector<bool>> data;
+  std::size_t num_data_rows;
+  std::size_t num_data_cols;
+
+  // Bit j of row_bits[i], and bit i of col_bits[j], is set when (i,j) is valid.
+  // The row bitsets are the only copy of the matrix.
+  std::vector<std::vector<std::uint64_t>> row_bits;
+  std::vector<std::vector<std::uint64_t>> col_bits;
+
+  // CSR (CSC) lists of the missing columns (rows) of every row (column). They
+  // are only built when the matrix has fewer missing elements than bitset
+  // words, as scanning the bitsets is cheaper otherwise.
+  bool sparse;
+  std::vector<std::size_t> row_na_start;
+  std::vector<std::size_t> row_na;
+  std::vector<std::size_t> col_na_start;
+  std::vector<std::size_t> col_na;
   
   void read();
   void calc_num_valid();
+  void build_bitsets();
+  void build_na_lists();
   std::string trim(std::string &str) const;
 
 public:  
@@ -48,6 +68,45 @@ public:
 
   bool is_data_na(const std::size_t i, const std::size_t j) const;
 
+  static const std::size_t BITS_PER_WORD = 64;
+  std::size_t get_num_row_words() const;
+  std::size_t get_num_col_words() const;
+  const std::vector<std::uint64_t>& get_row_bits(const std::size_t row) const;
+  const std::vector<std::uint64_t>& get_col_bits(const std::size_t col) const;
+  std::uint64_t get_content_hash() const;
+
+  bool is_sparse() const;
+  std::size_t get_num_na() const;
+  const std::size_t* get_row_na_begin(const std::size_t row) const;
+  const std::size_t* get_row_na_end(const std::size_t row) const;
+  const std::size_t* get_col_na_begin(const std::size_t col) const;
+  const std::size_t* get_col_na_end(const std::size_t col) const;
+
+  // Calls 'f' with every missing column of 'row' in increasing order, walking
+  // the NA list of sparse matrices and the row bitset of dense ones
+  template<typename F>
+  void for_each_na_in_row(const std::size_t row, F f) const {
+    if (sparse) {
+      for (auto p = get_row_na_begin(row); p != get_row_na_end(row); ++p) {
+        f(*p);
+      }
+    } else {
+      utils::for_each_unset_bit(row_bits[row], get_num_data_cols(), f);
+    }
+  }
+
+  // Calls 'f' with every missing row of 'col' in increasing order
+  template<typename F>
+  void for_each_na_in_col(const std::size_t col, F f) const {
+    if (sparse) {
+      for (auto p = get_col_na_begin(col); p != get_col_na_end(col); ++p) {
+        f(*p);
+      }
+    } else {
+      utils::for_each_unset_bit(col_bits[col], get_num_data_rows(), f);
+    }
+  }
+
   void write_orig(const std::string &out_file,
                   const std::vector<bool> &rows_to_keep,
                   const std::vector<bool> &cols_to_keep) const;
@@ -1,29 +1,59 @@
 #include "CalcPairsController.h"
 
+#include <algorithm>
 #include <fstream>
+#include <functional>
 
 #include <assert.h>
 
 #include "Parallel.h"
 #include "CalcPairsCore.h"
+#include "PhaseTimer.h"
 
 //------------------------------------------------------------------------------
-// Constructor.
+// Constructor. The forced and free rows and columns, and the size of the class
+// every free one stands for, are taken from 'presolve', which writes them to
+// the scratch directory for the workers. When 'incremental' is set, the pair
+// tables of the previous run in the scratch directory are updated rather than
+// recomputed whenever they still apply. The tables are counted in chunks of
+// about '_pairs_per_chunk' pairs, which are staged in '_local_dir' on every
+// node unless it is empty.
 //------------------------------------------------------------------------------
 CalcPairsController::CalcPairsController(const BinContainer &_data,
-                                         const std::string &_scratch_dir) : data(&_data),
-                                                                            num_rows(data->get_num_data_rows()),
-                                                                            num_cols(data->get_num_data_cols()),
-                                                                            scratch_dir(_scratch_dir),
-                                                                            world_size(Parallel::get_world_size()) {
+                                         const std::string &_scratch_dir,
+                                         const Presolve &presolve,
+                                         const std::size_t _pairs_per_chunk,
+                                         const bool _incremental,
+                                         const std::string &_local_dir) : data(&_data),
+                                                                          num_rows(data->get_num_data_rows()),
+                                                                          num_cols(data->get_num_data_cols()),
+                                                                          scratch_dir(_scratch_dir),
+                                                                          world_size(Parallel::get_world_size()),
+                                                                          pairs_per_chunk(_pairs_per_chunk),
+                                                                          incremental(_incremental),
+                                                                          local_dir(_local_dir),
+                                                                          forced_one_rows(presolve.get_forced_one_rows()),
+                                                                          forced_one_cols(presolve.get_forced_one_cols()),
+                                                                          free_rows(presolve.get_free_rows()),
+                                                                          free_cols(presolve.get_free_cols()) {
   for (std::size_t i = world_size - 1; i > 0; --i) {
     available_workers.push(i);
+    Parallel::enqueue(i);
   }
+  alive_rows = forced_one_rows;
+  alive_cols = forced_one_cols;
+  for (auto &members : presolve.get_row_classes()) {
+    row_weights.push_back(members.size());
+    alive_rows.insert(alive_rows.end(), members.begin(), members.end());
+  }
+  for (auto &members : presolve.get_col_classes()) {
+    col_weights.push_back(members.size());
+    alive_cols.insert(alive_cols.end(), members.begin(), members.end());
+  }
+  std::sort(alive_rows.begin(), alive_rows.end());
+  std::sort(alive_cols.begin(), alive_cols.end());
 
-  calc_free_rows();
-  calc_free_cols();
-  record_free_rows();
-  record_free_cols();  
+  presolve.write(scratch_dir);
 }
 
 //------------------------------------------------------------------------------
@@ -31,34 +61,6 @@ CalcPairsController::CalcPairsController(const BinContainer &_data,
 //------------------------------------------------------------------------------
 CalcPairsController::~CalcPairsController() {}
 
-//------------------------------------------------------------------------------
-// Add all rows with no invalid elements to the 'forced_one_rows' vector and
-// add all other rows to the 'free_rows' vector.
-//------------------------------------------------------------------------------
-void CalcPairsController::calc_free_rows() {
-  for (std::size_t i = 0; i < num_rows; ++i) {
-    if (data->get_num_invalid_in_row(i) == 0) {
-      forced_one_rows.push_back(i);
-    } else {
-      free_rows.push_back(i);
-    }
-  }
-}
-
-//------------------------------------------------------------------------------
-// Add all columns with no invalid elements to the 'forced_one_cols' vector and
-// add all other columns to the 'free_cols' vector.
-//------------------------------------------------------------------------------
-void CalcPairsController::calc_free_cols() {
-  for (std::size_t j = 0; j < num_cols; ++j) {
-    if (data->get_num_invalid_in_col(j) == 0) {
-      forced_one_cols.push_back(j);
-    } else {
-      free_cols.push_back(j);
-    }
-  }
-}
-
 //------------------------------------------------------------------------------
 // Tries to open a file based on the passed 'file_name'. Prints an error and 
 // exits if file cannot be opened. Returns the stream to file if successfully
@@ -73,44 +75,6 @@ FILE* CalcPairsController::open_file(const std::string &file_name) const {
   return out;
 }
 
-//------------------------------------------------------------------------------
-// Records the 'free rows' and 'rows forced to 1' in seperate files.
-//------------------------------------------------------------------------------
-void CalcPairsController::record_free_rows() const {
-  std::string file_name = scratch_dir + "freeRows.txt";
-  FILE* out = open_file(file_name);
-  for (auto r : free_rows) {
-    fprintf(out, "%lu\n", r);
-  }
-  fclose(out);
-  
-  file_name = scratch_dir + "forcedOneRows.txt";
-  out = open_file(file_name);
-  for (auto r : forced_one_rows) {
-    fprintf(out, "%lu\n", r);
-  }
-  fclose(out);
-}
-
-//------------------------------------------------------------------------------
-// Records the 'free cols' and 'cols forced to 1' in seperate files.
-//------------------------------------------------------------------------------
-void CalcPairsController::record_free_cols() const {
-  std::string file_name = scratch_dir + "freeCols.txt";
-  FILE* out = open_file(file_name);
-  for (auto c : free_cols) {
-    fprintf(out, "%lu\n", c);
-  }
-  fclose(out);
-
-  file_name = scratch_dir + "forcedOneCols.txt";
-  out = open_file(file_name);
-  for (auto c : forced_one_cols) {
-    fprintf(out, "%lu\n", c);
-  }
-  fclose(out);
-}
-
 //------------------------------------------------------------------------------
 // Records the 'pair_count' vector using the provided stream
 //------------------------------------------------------------------------------
@@ -132,13 +96,14 @@ void CalcPairsController::send_problem(const int rowCol, const std::size_t idx)
   fprintf(stderr, "Sending problem to rank %d\n", worker);
 
   // Indicate whether a row or column index is being sent
-  MPI_Send(&rowCol, 1, MPI_INT, worker, Parallel::SPARSE_TAG, MPI_COMM_WORLD);
+  Parallel::send(&rowCol, 1, MPI_INT, worker, Parallel::SPARSE_TAG);
 
   // Send the index
-  MPI_Send(&idx, 1, CUSTOM_SIZE_T, worker, Parallel::SPARSE_TAG, MPI_COMM_WORLD);
+  Parallel::send(&idx, 1, CUSTOM_SIZE_T, worker, Parallel::SPARSE_TAG);
 
   // Make the worker unavailable
   available_workers.pop();
+  Parallel::dequeue(worker);
   unavailable_workers.insert(worker);
 }
 
@@ -148,22 +113,73 @@ void CalcPairsController::send_start() {
 
   while (!available_workers.empty()) {
     const int worker = available_workers.top();
-    MPI_Send(&start, 1, MPI_INT, worker, Parallel::SPARSE_TAG, MPI_COMM_WORLD);
+    Parallel::send(&start, 1, MPI_INT, worker, Parallel::SPARSE_TAG);
+
+    // The workers take the presolve result from here rather than every one
+    // reading it from the scratch directory
+    send_indices(forced_one_rows, worker);
+    send_indices(forced_one_cols, worker);
+    send_indices(free_rows, worker);
+    send_indices(free_cols, worker);
+    send_indices(row_weights, worker);
+    send_indices(col_weights, worker);
     // Make the worker unavailable
     available_workers.pop();
+    Parallel::dequeue(worker);
     unavailable_workers.insert(worker);
   }
 }
 
+//------------------------------------------------------------------------------
+// Sends 'indices' to 'worker' as its size followed by its elements.
+//------------------------------------------------------------------------------
+void CalcPairsController::send_indices(const std::vector<std::size_t> &indices, const int worker) const {
+  const std::size_t n = indices.size();
+  Parallel::send(&n, 1, CUSTOM_SIZE_T, worker, Parallel::SPARSE_TAG);
+  if (n > 0) {
+    Parallel::send(indices.data(), n, CUSTOM_SIZE_T, worker, Parallel::SPARSE_TAG);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Asks worker 'owner' for its staged chunk of the row (column) table. Returns
+// false if the owner does not have the chunk complete.
+//------------------------------------------------------------------------------
+bool CalcPairsController::fetch_chunk(const int owner,
+                                      const bool is_row,
+                                      const std::size_t chunk,
+                                      std::string &contents) const {
+  const std::size_t request[2] = {is_row ? 1u : 0u, chunk};
+  Parallel::send(request, 2, CUSTOM_SIZE_T, owner, Parallel::CHUNK_TAG);
+
+  std::size_t reply[2];
+  Parallel::recv(reply, 2, CUSTOM_SIZE_T, owner, Parallel::CHUNK_TAG);
+  contents.resize(reply[1]);
+  if (reply[1] > 0) {
+    Parallel::recv(&contents[0], reply[1], MPI_CHAR, owner, Parallel::CHUNK_TAG);
+  }
+  return reply[0] == 1;
+}
+
+//------------------------------------------------------------------------------
+// Tells every worker serving its staged chunks that the tables are combined.
+//------------------------------------------------------------------------------
+void CalcPairsController::send_end_of_chunks() const {
+  const std::size_t request[2] = {0, Parallel::END_OF_CHUNKS};
+  for (std::size_t worker = 1; worker < world_size; ++worker) {
+    Parallel::send(request, 2, CUSTOM_SIZE_T, worker, Parallel::CHUNK_TAG);
+  }
+}
+
 void CalcPairsController::receive_completion() {
   assert(available_workers.size() < world_size - 1); // Cannot receive problem when no workers are working
 
   MPI_Status status;
   
-  MPI_Probe(MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &status);
+  Parallel::probe(MPI_ANY_SOURCE, status);
 
   int flag;
-  MPI_Recv(&flag, 1, MPI_INT, status.MPI_SOURCE, Parallel::SPARSE_TAG, MPI_COMM_WORLD, &status);
+  Parallel::recv(&flag, 1, MPI_INT, status.MPI_SOURCE, Parallel::SPARSE_TAG, &status);
 
   if (flag != 1) {
     fprintf(stderr, "Received inknown flag\n");
@@ -171,6 +187,7 @@ void CalcPairsController::receive_completion() {
 
   available_workers.push(status.MPI_SOURCE);
   unavailable_workers.erase(status.MPI_SOURCE);
+  Parallel::enqueue(status.MPI_SOURCE);
   // // Receive the solution
   
   // fprintf(stderr, "Rank %d receive solution from %d\n", 0, status.MPI_SOURCE);
@@ -206,29 +223,162 @@ void CalcPairsController::receive_completion() {
 }
 
 void CalcPairsController::work() {
+  CalcPairsCore core(*data, scratch_dir, forced_one_rows.size(), forced_one_cols.size(), free_rows, free_cols, row_weights, col_weights,
+                     pairs_per_chunk, true, local_dir, 0, world_size);
+
+  // Only the changed pairs of a previous run are recounted, by this rank alone
+  std::vector<std::size_t> old_free_rows, old_free_cols;
+  std::vector<bool> changed_rows, changed_cols;
+  if (incremental && find_changes(old_free_rows, old_free_cols, changed_rows, changed_cols)) {
+    core.update(old_free_rows, old_free_cols, changed_rows, changed_cols);
+    write_cache();
+    return;
+  }
+
   // Test workeres to start once free_row and free_col have been recorded
   send_start();
 
-  // Create local core and calculare alloted pairs
-  CalcPairsCore core(*data, scratch_dir, free_rows, free_cols);
+  // Calculate the alloted pairs with the local core
   core.work();
 
   // Wait for all workes to finish
+  PhaseTimer wait_timer("wait");
   while (workers_still_working()) {
     receive_completion();
   }
+  wait_timer.stop();
   
-  // Combine the various row_pairs file
-  combine_row_pair_files();
+  // Combine the chunks of every rank, which must all be complete. Staged
+  // chunks are sent by the workers that counted them.
+  PhaseTimer write_timer("pair_write");
+  if (local_dir.empty()) {
+    core.combine();
+  } else {
+    core.combine([this](const std::size_t owner, const bool is_row, const std::size_t chunk, std::string &contents) {
+      return fetch_chunk(owner, is_row, chunk, contents);
+    });
+    send_end_of_chunks();
+  }
+  write_timer.stop();
+
+  if (incremental) {
+    write_cache();
+  }
+}
+
+//------------------------------------------------------------------------------
+// Compares the matrix with the one cached by the previous run. A row pair
+// counts the columns valid in both rows among the forced columns and the
+// members of the free column classes, so the previous row table still holds
+// the count of every pair of unchanged rows that were free if those columns
+// are the same; likewise for the column table. Returns false if there is no
+// cache or the counted rows or columns differ. Otherwise returns the previous
+// free rows and columns and flags the rows and columns with a changed element.
+//------------------------------------------------------------------------------
+bool CalcPairsController::find_changes(std::vector<std::size_t> &old_free_rows,
+                                       std::vector<std::size_t> &old_free_cols,
+                                       std::vector<bool> &changed_rows,
+                                       std::vector<bool> &changed_cols) const {
+  const std::string file_name = scratch_dir + "pairsCache.bin";
+  FILE* input;
+  if ((input = fopen(file_name.c_str(), "rb")) == nullptr) {
+    fprintf(stderr, "No pair cache in %s, counting every pair\n", scratch_dir.c_str());
+    return false;
+  }
+
+  // Reads a vector written as its size followed by its elements
+  const std::size_t max_size = num_rows + num_cols;
+  auto read_vector = [input, max_size](std::vector<std::size_t> &v) {
+    std::size_t n = 0;
+    if (fread(&n, sizeof(std::size_t), 1, input) != 1 || n > max_size) {
+      return false;
+    }
+    v.resize(n);
+    return (n == 0 || fread(v.data(), sizeof(std::size_t), n, input) == n);
+  };
+
+  // The tables are updated a line at a time, which needs the free lines of
+  // both runs in increasing order
+  auto increasing = [](const std::vector<std::size_t> &v) {
+    return std::adjacent_find(v.begin(), v.end(), std::greater_equal<std::size_t>()) == v.end();
+  };
+
+  std::vector<std::size_t> dims, cached_alive_rows, cached_alive_cols;
+  const bool same_lines = read_vector(dims) &&
+                          read_vector(old_free_rows) && read_vector(old_free_cols) &&
+                          read_vector(cached_alive_rows) && read_vector(cached_alive_cols) &&
+                          dims == std::vector<std::size_t>{num_rows, num_cols} &&
+                          cached_alive_rows == alive_rows && cached_alive_cols == alive_cols &&
+                          increasing(old_free_rows) && increasing(old_free_cols) &&
+                          increasing(free_rows) && increasing(free_cols);
+  if (!same_lines) {
+    fclose(input);
+    fprintf(stderr, "The pair cache counts other rows and columns, counting every pair\n");
+    return false;
+  }
+
+  changed_rows.assign(num_rows, false);
+  changed_cols.assign(num_cols, false);
+  std::vector<std::uint64_t> cached_bits(data->get_num_row_words());
+  for (std::size_t i = 0; i < num_rows; ++i) {
+    if (fread(cached_bits.data(), sizeof(std::uint64_t), cached_bits.size(), input) != cached_bits.size()) {
+      fclose(input);
+      fprintf(stderr, "The pair cache is truncated, counting every pair\n");
+      return false;
+    }
+    const std::vector<std::uint64_t> &bits = data->get_row_bits(i);
+    for (std::size_t w = 0; w < bits.size(); ++w) {
+      std::uint64_t diff = bits[w] ^ cached_bits[w];
+      changed_rows[i] = changed_rows[i] || (diff != 0);
+      while (diff) {
+        changed_cols[w * BinContainer::BITS_PER_WORD + __builtin_ctzll(diff)] = true;
+        diff &= diff - 1;
+      }
+    }
+  }
+  fclose(input);
 
-  // Combine the various col_pairs file
-  combine_col_pair_files();
+  fprintf(stderr, "Updating the pairs of %lu changed rows and %lu changed columns\n",
+          std::count(changed_rows.begin(), changed_rows.end(), true),
+          std::count(changed_cols.begin(), changed_cols.end(), true));
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Writes the dimensions, the free and counted lines and the row bitsets of the
+// matrix behind the pair tables to the scratch directory.
+//------------------------------------------------------------------------------
+void CalcPairsController::write_cache() const {
+  const std::string file_name = scratch_dir + "pairsCache.bin";
+  FILE* output;
+  if ((output = fopen(file_name.c_str(), "wb")) == nullptr) {
+    fprintf(stderr, "ERROR - Could not open file %s\n", file_name.c_str());
+    exit(1);
+  }
+
+  auto write_vector = [output](const std::vector<std::size_t> &v) {
+    const std::size_t n = v.size();
+    fwrite(&n, sizeof(std::size_t), 1, output);
+    fwrite(v.data(), sizeof(std::size_t), n, output);
+  };
+
+  write_vector(std::vector<std::size_t>{num_rows, num_cols});
+  write_vector(free_rows);
+  write_vector(free_cols);
+  write_vector(alive_rows);
+  write_vector(alive_cols);
+  for (std::size_t i = 0; i < num_rows; ++i) {
+    const std::vector<std::uint64_t> &bits = data->get_row_bits(i);
+    fwrite(bits.data(), sizeof(std::uint64_t), bits.size(), output);
+  }
+
+  fclose(output);
 }
 
 void CalcPairsController::signal_workers_to_end() {
   char signal = 0;
   for (std::size_t i = 1; i < world_size; ++i) {
-    MPI_Send(&signal, 1, MPI_CHAR, i, Parallel::CONVERGE_TAG, MPI_COMM_WORLD);
+    Parallel::send(&signal, 1, MPI_CHAR, i, Parallel::CONVERGE_TAG);
   }
 }
 
@@ -240,27 +390,3 @@ bool CalcPairsController::workers_still_working() {
   return (available_workers.size() < (world_size - 1));
 }
 
-
-void CalcPairsController::combine_row_pair_files() {
-  std::string file_name = scratch_dir + "rowPairs.csv";
-  std::ofstream output(file_name, std::ios_base::binary);
-
-  for (std::size_t p = 0; p < world_size; ++p) {
-    std::string input_file = scratch_dir + "rowPairs_part" + std::to_string(p) + ".csv";
-    std::ifstream input(input_file.c_str(), std::ios_base::binary);
-
-    output << input.rdbuf();
-  }
-}
-
-void CalcPairsController::combine_col_pair_files() {
-  std::string file_name = scratch_dir + "colPairs.csv";
-  std::ofstream output(file_name, std::ios_base::binary);
-
-  for (std::size_t p = 0; p < world_size; ++p) {
-    std::string input_file = scratch_dir + "colPairs_part" + std::to_string(p) + ".csv";
-    std::ifstream input(input_file.c_str(), std::ios_base::binary);
-
-    output << input.rdbuf();
-  }
-}
\ No newline at end of file
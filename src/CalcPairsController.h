@@ -7,6 +7,7 @@
 #include <string>
 
 #include "BinContainer.h"
+#include "Presolve.h"
 
 class CalcPairsController
 {
@@ -17,6 +18,9 @@ private:
   const std::string scratch_dir;
 
   const std::size_t world_size;
+  const std::size_t pairs_per_chunk;
+  const bool incremental;
+  const std::string local_dir;
 
   std::stack<int> available_workers;
   std::set<int> unavailable_workers;
@@ -26,25 +30,40 @@ private:
 
   std::vector<std::size_t> free_rows;
   std::vector<std::size_t> free_cols;
+  std::vector<std::size_t> row_weights;
+  std::vector<std::size_t> col_weights;
 
-  FILE *output;
+  // Rows (columns) counted by the pair tables: the forced ones and every
+  // member of a free class, in increasing order
+  std::vector<std::size_t> alive_rows;
+  std::vector<std::size_t> alive_cols;
 
-  void calc_free_rows();
-  void calc_free_cols();
+  FILE *output;
 
   FILE* open_file(const std::string &file_name) const;
-  void record_free_rows() const;
-  void record_free_cols() const;
   void record_pair_count(FILE* stream, const std::vector<std::size_t> &pairs) const;
 
   void send_problem(const int rowCol, const std::size_t idx);
   void receive_completion();
 
   void send_start();
+  void send_indices(const std::vector<std::size_t> &indices, const int worker) const;
+  bool fetch_chunk(const int owner, const bool is_row, const std::size_t chunk, std::string &contents) const;
+  void send_end_of_chunks() const;
+
+  bool find_changes(std::vector<std::size_t> &old_free_rows,
+                    std::vector<std::size_t> &old_free_cols,
+                    std::vector<bool> &changed_rows,
+                    std::vector<bool> &changed_cols) const;
+  void write_cache() const;
 
 public:
   CalcPairsController(const BinContainer &_data,
-                      const std::string &_scratch_dir);
+                      const std::string &_scratch_dir,
+                      const Presolve &presolve,
+                      const std::size_t _pairs_per_chunk,
+                      const bool _incremental = false,
+                      const std::string &_local_dir = "");
   ~CalcPairsController();
 
   void work();
@@ -52,8 +71,6 @@ public:
   void wait_for_workers();
   bool workers_still_working();
 
-  void combine_row_pair_files();
-  void combine_col_pair_files();
 };
 
 #endif
\ No newline at end of file
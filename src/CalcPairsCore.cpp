@@ -1,85 +1,612 @@
 #include "CalcPairsCore.h"
-#include "Parallel.h"
+#include "PhaseTimer.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+  const std::uint64_t FNV_OFFSET = 14695981039346656037ULL;
+  const std::uint64_t FNV_PRIME = 1099511628211ULL;
+
+  // Adds 'num_bytes' bytes to the 64-bit FNV-1a hash 'hash'
+  std::uint64_t fnv1a(std::uint64_t hash, const void *bytes, const std::size_t num_bytes) {
+    const unsigned char *p = static_cast<const unsigned char *>(bytes);
+    for (std::size_t i = 0; i < num_bytes; ++i) {
+      hash = (hash ^ p[i]) * FNV_PRIME;
+    }
+    return hash;
+  }
+
+  std::uint64_t fnv1a(const std::uint64_t hash, const std::vector<std::size_t> &v) {
+    const std::size_t n = v.size();
+    return fnv1a(fnv1a(hash, &n, sizeof(n)), v.data(), n * sizeof(std::size_t));
+  }
+}
 
 CalcPairsCore::CalcPairsCore(const BinContainer &_data,
                              const std::string &_scratch_dir,
+                             const std::size_t _num_forced_one_rows,
+                             const std::size_t _num_forced_one_cols,
                              const std::vector<std::size_t> &_free_rows,
-                             const std::vector<std::size_t> &_free_cols) :  data(&_data),
+                             const std::vector<std::size_t> &_free_cols,
+                             const std::vector<std::size_t> &_row_weights,
+                             const std::vector<std::size_t> &_col_weights,
+                             const std::size_t _pairs_per_chunk,
+                             const bool _resume,
+                             const std::string &_local_dir,
+                             const std::size_t _world_rank,
+                             const std::size_t _world_size) :  data(&_data),
                                                                             num_rows(data->get_num_data_rows()),
                                                                             num_cols(data->get_num_data_cols()),
                                                                             scratch_dir(_scratch_dir),
-                                                                            world_rank(Parallel::get_world_rank()),
-                                                                            world_size(Parallel::get_world_size()),
+                                                                            world_rank(_world_rank),
+                                                                            world_size(_world_size > 0 ? _world_size : 1),
+                                                                            num_forced_one_rows(_num_forced_one_rows),
+                                                                            num_forced_one_cols(_num_forced_one_cols),
+                                                                            pairs_per_chunk(_pairs_per_chunk > 0 ? _pairs_per_chunk : 1),
+                                                                            resume(_resume),
+                                                                            local_dir(_local_dir),
                                                                             free_rows(_free_rows),
-                                                                            free_cols(_free_cols)
+                                                                            free_cols(_free_cols),
+                                                                            row_weights(_row_weights),
+                                                                            col_weights(_col_weights)
 {}
 
 CalcPairsCore::~CalcPairsCore() {}
 
+// Counts, for every pair of free rows (columns), the forced and free columns
+// (rows) valid in both. Rows and columns dropped by the presolve are in
+// neither list and are not counted. A free row (column) stands for its class
+// of identical rows (columns), so it counts as many times as the class size.
+// The tables are written in chunks, which the ranks take in turn; see
+// count_pairs().
 void CalcPairsCore::work() {
-  std::string file_name = scratch_dir + "rowPairs_part" + std::to_string(world_rank) + ".csv";
-  open_file(file_name);
-
-  for (std::size_t idx = world_rank; idx < free_rows.size()-1; idx+=world_size) {
-    const std::size_t i1 = free_rows[idx];
-    const std::size_t num_pairs = free_rows.size()-1-idx;
-    std::vector<std::size_t> count(num_pairs, num_cols);
-
-    std::vector<std::size_t> valid_cols;
-    for (auto j : free_cols) {
-      if (!data->is_data_na(i1, j)) {
-        valid_cols.push_back(j);
-      }
-    }
+  count_pairs(true, free_rows, free_cols, col_weights);
+  count_pairs(false, free_cols, free_rows, row_weights);
+}
+
+// Concatenates the chunks of the row and column tables into rowPairs.csv and
+// colPairs.csv, after checking that every chunk is complete, and removes the
+// chunks, which the combined tables replace. When the chunks are staged, the
+// chunks of the other ranks, which must be in serve_chunks(), are copied with
+// 'fetch'; those ranks remove their own once rank 0 is done.
+void CalcPairsCore::combine(const ChunkFetcher &fetch) const {
+  combine_chunks(true, free_rows, fetch);
+  combine_chunks(false, free_cols, fetch);
+
+  if (local_dir.empty()) {
+    remove_chunks(0, 1);
+    return;
+  }
+
+  // Only the last rank of the node to empty the staging directory removes it
+  remove_chunks(world_rank, world_size);
+  rmdir(local_dir.c_str());
+}
 
-    for (std::size_t idx2 = idx + 1; idx2 < free_rows.size(); ++idx2) {
-      count[idx2 - idx - 1] -= (free_cols.size() - valid_cols.size());
-      const std::size_t i2 = free_rows[idx2];
-     
-      for (auto j : valid_cols) {
-        if (data->is_data_na(i2, j)) {
-          --count[idx2 - idx - 1];
+// Answers the requests of rank 0 for the staged chunks of this rank while it
+// combines the tables, until it has combined them all. A chunk that is
+// missing or does not match its marker is reported as such. The staged chunks
+// are then removed.
+void CalcPairsCore::serve_chunks(const ChunkRequest &next_request, const ChunkReply &reply) const {
+  const std::vector<std::size_t> starts[2] = {get_chunk_starts(free_cols.size()), get_chunk_starts(free_rows.size())};
+  const std::uint64_t keys[2] = {get_table_key(false), get_table_key(true)};
+
+  std::string contents;
+  bool is_row;
+  std::size_t chunk;
+  while (next_request(is_row, chunk)) {
+    const std::vector<std::size_t> &s = starts[is_row];
+    const bool found = (chunk + 1 < s.size() && read_chunk(is_row, chunk, s[chunk], s[chunk+1], keys[is_row], contents));
+    reply(is_row, chunk, found, contents);
+  }
+
+  remove_chunks(world_rank, world_size);
+  rmdir(local_dir.c_str());
+}
+
+// Updates the combined pair tables of a previous run in the scratch directory,
+// over the free rows 'old_free_rows' and columns 'old_free_cols', after the
+// rows 'changed_rows' and columns 'changed_cols' of the matrix have changed.
+// A row pair can only change when one of its rows did, and likewise for
+// columns, so only the pairs of changed or newly free lines are recounted.
+void CalcPairsCore::update(const std::vector<std::size_t> &old_free_rows,
+                           const std::vector<std::size_t> &old_free_cols,
+                           const std::vector<bool> &changed_rows,
+                           const std::vector<bool> &changed_cols) {
+  update_pairs(true, free_rows, old_free_rows, free_cols, col_weights, get_total_weight(true), changed_rows, scratch_dir + "rowPairs.csv");
+  update_pairs(false, free_cols, old_free_cols, free_rows, row_weights, get_total_weight(false), changed_cols, scratch_dir + "colPairs.csv");
+}
+
+//------------------------------------------------------------------------------
+// Counts the row (column) table in this process and builds 'pairs' from it
+// without writing any file; 'max_thresholds' is passed on to Pairs::begin().
+// 'num_threads' threads count a chunk each, and the lines of a round of chunks
+// are added to 'pairs' before the next round starts, so at most one chunk per
+// thread is held at a time.
+//------------------------------------------------------------------------------
+void CalcPairsCore::count(const bool is_row,
+                          const std::vector<unsigned int> &max_thresholds,
+                          const std::size_t num_threads,
+                          Pairs &pairs) {
+  const std::vector<std::size_t> &lines = (is_row ? free_rows : free_cols);
+  if (lines.size() < 2) {
+    return;
+  }
+
+  Timer timer(true), add_timer;
+  build_na_lists(is_row, lines, (is_row ? free_cols : free_rows), (is_row ? col_weights : row_weights));
+  const std::vector<std::size_t> starts = get_chunk_starts(lines.size());
+  const std::size_t total_weight = get_total_weight(is_row);
+
+  pairs.set_size(lines.size() - 1);
+  pairs.begin(max_thresholds);
+
+  ThreadPool pool(num_threads > 0 ? num_threads : 1);
+  std::vector<std::vector<std::vector<std::size_t>>> counts(pool.size());
+  for (std::size_t round = 0; round + 1 < starts.size(); round += pool.size()) {
+    const std::size_t num_chunks = std::min(pool.size(), starts.size() - 1 - round);
+    for (std::size_t t = 0; t < num_chunks; ++t) {
+      pool.submit([&, t] {
+        const std::size_t chunk = round + t;
+        counts[t].clear();
+        for (std::size_t idx = starts[chunk]; idx < starts[chunk+1]; ++idx) {
+          std::vector<std::size_t> count(lines.size()-1-idx, 0);
+          for (std::size_t idx2 = idx + 1; idx2 < lines.size(); ++idx2) {
+            count[idx2 - idx - 1] = count_pair(is_row, lines, idx, idx2, total_weight);
+          }
+          counts[t].push_back(std::move(count));
         }
+      });
+    }
+    pool.wait();
+
+    add_timer.start();
+    for (std::size_t t = 0; t < num_chunks; ++t) {
+      for (std::size_t k = 0; k < counts[t].size(); ++k) {
+        pairs.add_line(starts[round + t] + k, counts[t][k]);
       }
     }
+    add_timer.stop();
+  }
+
+  add_timer.start();
+  pairs.finish();
+  add_timer.stop();
 
-    record_pair_count(count, output);
+  timer.stop();
+  PhaseTimer::add("pair_build", add_timer.elapsed_wall_time(), add_timer.elapsed_cpu_time());
+  PhaseTimer::add("pair_compute",
+                  timer.elapsed_wall_time() - add_timer.elapsed_wall_time(),
+                  timer.elapsed_cpu_time() - add_timer.elapsed_cpu_time());
+}
+
+// Returns the total weight of the lines the row (column) pairs are counted
+// over: the forced columns (rows) and every member of a free class.
+std::size_t CalcPairsCore::get_total_weight(const bool is_row) const {
+  std::size_t total_weight = (is_row ? num_forced_one_cols : num_forced_one_rows);
+  for (auto w : (is_row ? col_weights : row_weights)) {
+    total_weight += w;
+  }
+  return total_weight;
+}
+
+// Splits the 'num_lines' lines of a table into chunks of consecutive lines
+// holding about 'pairs_per_chunk' pairs each. Line idx has num_lines-1-idx
+// pairs, so the first chunks have fewer lines. Returns the first line of every
+// chunk, followed by num_lines-1, the end of the last chunk. The chunks only
+// depend on the table, so a restart with a different number of ranks keeps
+// them.
+std::vector<std::size_t> CalcPairsCore::get_chunk_starts(const std::size_t num_lines) const {
+  std::vector<std::size_t> starts(1, 0);
+  std::size_t num_pairs = 0;
+  for (std::size_t idx = 0; idx + 1 < num_lines; ++idx) {
+    num_pairs += num_lines - 1 - idx;
+    if (num_pairs >= pairs_per_chunk && idx + 2 < num_lines) {
+      starts.push_back(idx + 1);
+      num_pairs = 0;
+    }
+  }
+  starts.push_back(num_lines > 0 ? num_lines - 1 : 0);
+  return starts;
+}
+
+// Returns a hash of everything the row (column) table depends on: the size of
+// the matrix, its missing data, the free and forced lines and the class sizes.
+// A chunk written for another table is recounted.
+std::uint64_t CalcPairsCore::get_table_key(const bool is_row) const {
+  std::uint64_t key = fnv1a(FNV_OFFSET, &is_row, sizeof(is_row));
+  key = fnv1a(key, std::vector<std::size_t>{num_rows, num_cols, num_forced_one_rows, num_forced_one_cols});
+  key = fnv1a(key, free_rows);
+  key = fnv1a(key, free_cols);
+  key = fnv1a(key, row_weights);
+  key = fnv1a(key, col_weights);
+  const std::uint64_t content = data->get_content_hash();
+  return fnv1a(key, &content, sizeof(content));
+}
+
+// Returns the name of a chunk of the row (column) table, without extension.
+// The chunk is in the .csv file and its completion marker in the .done file.
+std::string CalcPairsCore::get_chunk_file(const bool is_row, const std::size_t chunk) const {
+  return (local_dir.empty() ? scratch_dir : local_dir) + (is_row ? "rowPairs" : "colPairs") + "_chunk" + std::to_string(chunk);
+}
+
+// Reads a chunk holding the pairs of lines first to last-1 into 'contents'.
+// Returns false unless the chunk has a completion marker for the same lines
+// and table 'key', and the size and checksum of the chunk match the marker.
+bool CalcPairsCore::read_chunk(const bool is_row,
+                               const std::size_t chunk,
+                               const std::size_t first,
+                               const std::size_t last,
+                               const std::uint64_t key,
+                               std::string &contents) const {
+  const std::string file_name = get_chunk_file(is_row, chunk);
+
+  FILE *marker;
+  if ((marker = fopen((file_name + ".done").c_str(), "r")) == nullptr) {
+    return false;
+  }
+  std::uint64_t marker_key, checksum;
+  std::size_t marker_first, marker_last, num_bytes;
+  const int num_read = fscanf(marker, "%lu,%lu,%lu,%lu,%lu", &marker_key, &marker_first, &marker_last, &num_bytes, &checksum);
+  fclose(marker);
+  if (num_read != 5 || marker_key != key || marker_first != first || marker_last != last) {
+    return false;
   }
 
+  std::ifstream input((file_name + ".csv").c_str(), std::ios_base::binary);
+  if (!input) {
+    return false;
+  }
+  contents.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+  return contents.size() == num_bytes && fnv1a(FNV_OFFSET, contents.data(), contents.size()) == checksum;
+}
+
+// Counts the pairs of lines first to last-1 and writes them to the chunk's
+// .csv file. Its completion marker, holding the table key, the lines, and the
+// size and checksum of the chunk, is written once the chunk is closed, under a
+// temporary name that is then renamed, so a chunk with a marker is complete.
+void CalcPairsCore::write_chunk(const bool is_row,
+                                const std::size_t chunk,
+                                const std::size_t first,
+                                const std::size_t last,
+                                const std::uint64_t key,
+                                const std::vector<std::size_t> &lines,
+                                const std::size_t total_weight,
+                                Timer &write_timer) {
+  const std::string file_name = get_chunk_file(is_row, chunk);
+  remove((file_name + ".done").c_str());
+  open_file(file_name + ".csv");
+
+  std::uint64_t checksum = FNV_OFFSET;
+  std::size_t num_bytes = 0;
+  for (std::size_t idx = first; idx < last; ++idx) {
+    std::vector<std::size_t> count(lines.size()-1-idx, 0);
+    for (std::size_t idx2 = idx + 1; idx2 < lines.size(); ++idx2) {
+      count[idx2 - idx - 1] = count_pair(is_row, lines, idx, idx2, total_weight);
+    }
+    write_timer.start();
+    const std::string line = format_pair_count(count);
+    checksum = fnv1a(checksum, line.data(), line.size());
+    num_bytes += line.size();
+    fwrite(line.data(), 1, line.size(), output);
+    write_timer.stop();
+  }
+
+  write_timer.start();
+  if (ferror(output)) {
+    fprintf(stderr, "ERROR - Could not write file %s.csv\n", file_name.c_str());
+    exit(1);
+  }
   close_file();
 
+  const std::string tmp_name = file_name + ".done.tmp";
+  FILE *marker;
+  if ((marker = fopen(tmp_name.c_str(), "w")) == nullptr) {
+    fprintf(stderr, "ERROR - Could not open file %s\n", tmp_name.c_str());
+    exit(1);
+  }
+  fprintf(marker, "%lu,%lu,%lu,%lu,%lu\n", key, first, last, num_bytes, checksum);
+  fclose(marker);
+  if (rename(tmp_name.c_str(), (file_name + ".done").c_str()) != 0) {
+    fprintf(stderr, "ERROR - Could not rename %s\n", tmp_name.c_str());
+    exit(1);
+  }
+  write_timer.stop();
+}
 
-  std::string col_file_name = scratch_dir + "colPairs_part" + std::to_string(world_rank) + ".csv";
-  open_file(col_file_name);
+// Concatenates the chunks of the row (column) table in order. Exits with an
+// error naming the first chunk that is missing or does not match its marker;
+// running calcPairs again recounts only the chunks that failed.
+void CalcPairsCore::combine_chunks(const bool is_row,
+                                   const std::vector<std::size_t> &lines,
+                                   const ChunkFetcher &fetch) const {
+  const std::string file_name = scratch_dir + (is_row ? "rowPairs.csv" : "colPairs.csv");
+  std::ofstream output(file_name, std::ios_base::binary);
+  if (!output) {
+    fprintf(stderr, "ERROR - Could not open file %s\n", file_name.c_str());
+    exit(1);
+  }
+
+  const std::vector<std::size_t> starts = get_chunk_starts(lines.size());
+  const std::uint64_t key = get_table_key(is_row);
+  std::string contents;
+  for (std::size_t chunk = 0; chunk + 1 < starts.size(); ++chunk) {
+    // A staged chunk is on the node of the rank that counted it
+    const std::size_t owner = chunk % world_size;
+    const bool found = (local_dir.empty() || owner == world_rank || !fetch ?
+                        read_chunk(is_row, chunk, starts[chunk], starts[chunk+1], key, contents) :
+                        fetch(owner, is_row, chunk, contents));
+    if (!found) {
+      fprintf(stderr, "ERROR - %s.csv is missing or incomplete\n", get_chunk_file(is_row, chunk).c_str());
+      exit(1);
+    }
+    output << contents;
+  }
+}
 
-  for (std::size_t idx = world_rank; idx < free_cols.size()-1; idx+=world_size) {
-    const std::size_t j1 = free_cols[idx];
-    const std::size_t num_pairs = free_cols.size()-1-idx;
-    std::vector<std::size_t> count(num_pairs, num_rows);
+// Removes every 'step'-th chunk of both tables, starting with chunk 'first',
+// and their markers, once the tables are combined.
+void CalcPairsCore::remove_chunks(const std::size_t first, const std::size_t step) const {
+  for (int is_row = 0; is_row < 2; ++is_row) {
+    const std::vector<std::size_t> starts = get_chunk_starts(is_row ? free_rows.size() : free_cols.size());
+    for (std::size_t chunk = first; chunk + 1 < starts.size(); chunk += step) {
+      const std::string file_name = get_chunk_file(is_row, chunk);
+      remove((file_name + ".csv").c_str());
+      remove((file_name + ".done").c_str());
+    }
+  }
+}
+
+// Returns the directory under 'local_root', a node-local file system such as
+// /dev/shm or a local SSD, that calcPairs stages the chunks of 'scratch_dir'
+// in, and creates it on this node. The name depends on the scratch directory
+// alone, so a killed run that is restarted on the same nodes finds the chunks
+// it staged.
+std::string CalcPairsCore::make_local_dir(const std::string &local_root, const std::string &scratch_dir) {
+  char *resolved = realpath((scratch_dir.empty() ? "." : scratch_dir.c_str()), nullptr);
+  const std::string path = (resolved != nullptr ? std::string(resolved) : scratch_dir);
+  free(resolved);
+
+  std::ostringstream oss;
+  oss << local_root << (local_root.back() == '/' ? "" : "/") << "calcPairs_" << std::hex << fnv1a(FNV_OFFSET, path.data(), path.size()) << "/";
+  const std::string dir = oss.str();
+  if (mkdir(dir.c_str(), 0700) != 0 && errno != EEXIST) {
+    fprintf(stderr, "ERROR - Could not create directory %s\n", dir.c_str());
+    exit(1);
+  }
+  return dir;
+}
 
-    std::vector<std::size_t> valid_rows;
-    for (auto i : free_rows) {
-      if (!data->is_data_na(i, j1)) {
-        valid_rows.push_back(i);
+// Builds, for every one of 'lines', the sorted list of the free
+// 'other_lines' it is missing and their total weight, w(NA). The weight of
+// every other line is kept by its index in the matrix, and is 0 if not free.
+void CalcPairsCore::build_na_lists(const bool is_row,
+                                   const std::vector<std::size_t> &lines,
+                                   const std::vector<std::size_t> &other_lines,
+                                   const std::vector<std::size_t> &other_weights) {
+  const std::size_t num_other = (is_row ? num_cols : num_rows);
+
+  weight_of.assign(num_other, 0);
+  free_mask.assign((num_other + BinContainer::BITS_PER_WORD - 1) / BinContainer::BITS_PER_WORD, 0);
+  for (std::size_t k = 0; k < other_lines.size(); ++k) {
+    weight_of[other_lines[k]] = other_weights[k];
+    free_mask[other_lines[k] / BinContainer::BITS_PER_WORD] |= (std::uint64_t(1) << (other_lines[k] % BinContainer::BITS_PER_WORD));
+  }
+
+  na_start.assign(lines.size() + 1, 0);
+  na_list.clear();
+  na_weight.assign(lines.size(), 0);
+  for (std::size_t idx = 0; idx < lines.size(); ++idx) {
+    for_each_na(is_row, lines[idx], [&](const std::size_t k) {
+      if (weight_of[k] > 0) {
+        na_list.push_back(k);
+        na_weight[idx] += weight_of[k];
+      }
+    });
+    na_start[idx + 1] = na_list.size();
+  }
+}
+
+// Counts the pair (lines[idx], lines[idx2]) as
+//   total - w(NA_a) - w(NA_b) + w(NA_a & NA_b),
+// picking the cheapest way to intersect the two NA lists: galloping when one
+// list is much shorter than the other, merging when both are short, and the
+// bitsets when the lists are longer than a bitset.
+std::size_t CalcPairsCore::count_pair(const bool is_row,
+                                      const std::vector<std::size_t> &lines,
+                                      const std::size_t idx,
+                                      const std::size_t idx2,
+                                      const std::size_t total_weight) const {
+  const std::size_t *a = na_list.data() + na_start[idx];
+  const std::size_t *a_end = na_list.data() + na_start[idx + 1];
+  const std::size_t *b = na_list.data() + na_start[idx2];
+  const std::size_t *b_end = na_list.data() + na_start[idx2 + 1];
+  const std::size_t len_a = a_end - a;
+  const std::size_t len_b = b_end - b;
+
+  std::size_t shared_weight = 0;
+  auto add_shared = [&](const std::size_t k) { shared_weight += weight_of[k]; };
+
+  if (len_a == 0 || len_b == 0) {
+    // Nothing is missing from both
+  } else if (len_a + len_b > free_mask.size()) {
+    const std::vector<std::uint64_t> &a_bits = (is_row ? data->get_row_bits(lines[idx]) : data->get_col_bits(lines[idx]));
+    const std::vector<std::uint64_t> &b_bits = (is_row ? data->get_row_bits(lines[idx2]) : data->get_col_bits(lines[idx2]));
+    for (std::size_t w = 0; w < free_mask.size(); ++w) {
+      std::uint64_t both_na = ~a_bits[w] & ~b_bits[w] & free_mask[w];
+      while (both_na) {
+        add_shared(w * BinContainer::BITS_PER_WORD + __builtin_ctzll(both_na));
+        both_na &= both_na - 1;
       }
     }
+  } else if (len_a * GALLOP_RATIO < len_b) {
+    utils::for_each_common_gallop(a, a_end, b, b_end, add_shared);
+  } else if (len_b * GALLOP_RATIO < len_a) {
+    utils::for_each_common_gallop(b, b_end, a, a_end, add_shared);
+  } else {
+    utils::for_each_common(a, a_end, b, b_end, add_shared);
+  }
 
-    for (std::size_t idx2 = idx + 1; idx2 < free_cols.size(); ++idx2) {
-      count[idx2 - idx - 1] -= (free_rows.size() - valid_rows.size());
-      const std::size_t j2 = free_cols[idx2];
-     
-      for (auto i : valid_rows) {
-        if (data->is_data_na(i, j2)) {
-          --count[idx2 - idx - 1];
-        }
+  return total_weight - na_weight[idx] - na_weight[idx2] + shared_weight;
+}
+
+// Counts this rank's share of the pairs of 'lines': every world_size-th chunk,
+// starting with chunk world_rank. When resuming, a chunk already completed by
+// a previous run of the same table is kept.
+void CalcPairsCore::count_pairs(const bool is_row,
+                                const std::vector<std::size_t> &lines,
+                                const std::vector<std::size_t> &other_lines,
+                                const std::vector<std::size_t> &other_weights) {
+  Timer timer(true), write_timer;
+  const std::vector<std::size_t> starts = get_chunk_starts(lines.size());
+  const std::uint64_t key = get_table_key(is_row);
+  const std::size_t total_weight = get_total_weight(is_row);
+
+  bool built = false;
+  std::size_t num_kept = 0, num_counted = 0;
+  std::string contents;
+  for (std::size_t chunk = world_rank; chunk + 1 < starts.size(); chunk += world_size) {
+    if (resume && read_chunk(is_row, chunk, starts[chunk], starts[chunk+1], key, contents)) {
+      ++num_kept;
+      continue;
+    }
+    if (!built) {
+      build_na_lists(is_row, lines, other_lines, other_weights);
+      built = true;
+    }
+    write_chunk(is_row, chunk, starts[chunk], starts[chunk+1], key, lines, total_weight, write_timer);
+    ++num_counted;
+  }
+
+  timer.stop();
+  record_phases(timer, write_timer);
+
+  if (num_kept > 0) {
+    fprintf(stderr, "Rank %lu kept %lu and counted %lu %s pair chunks\n",
+            world_rank, num_kept, num_counted, is_row ? "row" : "column");
+  }
+}
+
+// Rewrites the pair table in 'file_name', written by a previous run over
+// 'old_lines', for 'lines'. A pair of lines that were both in 'old_lines' and
+// are not flagged in 'changed' keeps its old count; every other pair is
+// recounted. Both lists are in increasing order, so such a pair keeps its
+// order and its old count is in the old line of its first line. The old table
+// is written in line order, so it is read alongside the new one, which is
+// written to a temporary file, and only one old line is held at a time.
+void CalcPairsCore::update_pairs(const bool is_row,
+                                 const std::vector<std::size_t> &lines,
+                                 const std::vector<std::size_t> &old_lines,
+                                 const std::vector<std::size_t> &other_lines,
+                                 const std::vector<std::size_t> &other_weights,
+                                 const std::size_t total_weight,
+                                 const std::vector<bool> &changed,
+                                 const std::string &file_name) {
+  std::ifstream input(file_name.c_str());
+  if (!input) {
+    fprintf(stderr, "ERROR - Could not open file %s\n", file_name.c_str());
+    exit(1);
+  }
+
+  Timer timer(true), read_timer, write_timer;
+  build_na_lists(is_row, lines, other_lines, other_weights);
+
+  // Position of every line in 'old_lines', if it was free and has not changed
+  std::vector<long> old_position(changed.size(), -1);
+  for (std::size_t k = 0; k < old_lines.size(); ++k) {
+    if (!changed[old_lines[k]]) {
+      old_position[old_lines[k]] = k;
+    }
+  }
+
+  // Reads the old lines up to 'a', keeping line 'a' in 'old_count'
+  std::size_t next_old = 0;
+  std::vector<std::size_t> old_count;
+  auto read_old_line = [&](const std::size_t a) {
+    read_timer.start();
+    std::string line, token;
+    while (next_old <= a) {
+      if (!std::getline(input, line)) {
+        fprintf(stderr, "ERROR - %s has fewer lines than there are pairs\n", file_name.c_str());
+        exit(1);
+      }
+      old_count.clear();
+      std::istringstream iss(line);
+      while (std::getline(iss, token, ',')) {
+        old_count.push_back(std::stoul(token));
+      }
+      if (old_count.size() != old_lines.size()-1-next_old) {
+        fprintf(stderr, "ERROR - %s does not match the previous free lines\n", file_name.c_str());
+        exit(1);
+      }
+      ++next_old;
+    }
+    read_timer.stop();
+  };
+
+  const std::string tmp_name = file_name + ".tmp";
+  open_file(tmp_name);
+  std::size_t num_recounted = 0;
+  for (std::size_t idx = 0; idx + 1 < lines.size(); ++idx) {
+    std::vector<std::size_t> count(lines.size()-1-idx, 0);
+    const long a = old_position[lines[idx]];
+    if (a >= 0 && static_cast<std::size_t>(a) + 1 < old_lines.size()) {
+      read_old_line(a);
+    }
+    for (std::size_t idx2 = idx + 1; idx2 < lines.size(); ++idx2) {
+      const long b = old_position[lines[idx2]];
+      if (a >= 0 && b >= 0) {
+        count[idx2 - idx - 1] = old_count[b - a - 1];
+      } else {
+        count[idx2 - idx - 1] = count_pair(is_row, lines, idx, idx2, total_weight);
+        ++num_recounted;
       }
     }
+    write_timer.start();
+    const std::string line = format_pair_count(count);
+    fwrite(line.data(), 1, line.size(), output);
+    write_timer.stop();
+  }
+  input.close();
 
-    record_pair_count(count, output);
+  write_timer.start();
+  if (ferror(output)) {
+    fprintf(stderr, "ERROR - Could not write file %s\n", tmp_name.c_str());
+    exit(1);
   }
   close_file();
+  if (rename(tmp_name.c_str(), file_name.c_str()) != 0) {
+    fprintf(stderr, "ERROR - Could not rename %s\n", tmp_name.c_str());
+    exit(1);
+  }
+  write_timer.stop();
+
+  // Reading the old table is counted apart from computing the new one
+  timer.stop();
+  PhaseTimer::add("pair_read", read_timer.elapsed_wall_time(), read_timer.elapsed_cpu_time());
+  PhaseTimer::add("pair_write", write_timer.elapsed_wall_time(), write_timer.elapsed_cpu_time());
+  PhaseTimer::add("pair_compute",
+                  timer.elapsed_wall_time() - read_timer.elapsed_wall_time() - write_timer.elapsed_wall_time(),
+                  timer.elapsed_cpu_time() - read_timer.elapsed_cpu_time() - write_timer.elapsed_cpu_time());
+
+  fprintf(stderr, "Recounted %lu of the %s pairs\n", num_recounted, is_row ? "row" : "column");
 }
 
+// Adds the time 'total' taken to count a pair table, of which 'write' was spent
+// writing it, to the pair_compute and pair_write phases
+void CalcPairsCore::record_phases(const Timer &total, const Timer &write) const {
+  PhaseTimer::add("pair_write", write.elapsed_wall_time(), write.elapsed_cpu_time());
+  PhaseTimer::add("pair_compute",
+                  total.elapsed_wall_time() - write.elapsed_wall_time(),
+                  total.elapsed_cpu_time() - write.elapsed_cpu_time());
+}
 
 void CalcPairsCore::open_file(const std::string &file_name) {
   if ((output = fopen(file_name.c_str(), "w")) == nullptr) {
@@ -92,9 +619,13 @@ void CalcPairsCore::close_file() {
   fclose(output);
 }
 
-void CalcPairsCore::record_pair_count(const std::vector<std::size_t> &count, FILE *stream) const {
-  for (std::size_t i = 0; i < count.size()-1; ++i) {
-    fprintf(output, "%lu,", count[i]);
+// Returns the line of a pair table holding 'count'
+std::string CalcPairsCore::format_pair_count(const std::vector<std::size_t> &count) const {
+  std::string line;
+  char buffer[24];
+  for (std::size_t i = 0; i < count.size(); ++i) {
+    const int n = snprintf(buffer, sizeof(buffer), (i + 1 < count.size()) ? "%lu," : "%lu\n", count[i]);
+    line.append(buffer, n);
   }
-  fprintf(output, "%lu\n", count[count.size()-1]);
+  return line;
 }
\ No newline at end of file
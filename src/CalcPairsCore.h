@@ -1,12 +1,29 @@
 #ifndef CALC_PAIRS_CORE_H
 #define CALC_PAIRS_CORE_H
 
+#include <cstdint>
+#include <functional>
 #include <vector>
 #include <string>
 #include "BinContainer.h"
+#include "Pairs.h"
+#include "Timer.h"
 
 class CalcPairsCore
 {
+public:
+  // Copies the staged chunk 'chunk' of the row (column) table from the rank
+  // 'owner' that counted it into 'contents'. Returns false if the owner does
+  // not have the chunk complete.
+  typedef std::function<bool(const std::size_t owner, const bool is_row, const std::size_t chunk, std::string &contents)> ChunkFetcher;
+
+  // Waits for the next request for a staged chunk of this rank. Returns false
+  // once every chunk has been combined.
+  typedef std::function<bool(bool &is_row, std::size_t &chunk)> ChunkRequest;
+
+  // Answers the request for a chunk with its contents, if 'found'
+  typedef std::function<void(const bool is_row, const std::size_t chunk, const bool found, const std::string &contents)> ChunkReply;
+
 private:
   const BinContainer *data;
   const std::size_t num_rows;
@@ -14,24 +31,124 @@ private:
   const std::string scratch_dir;
   const std::size_t world_rank;  
   const std::size_t world_size;
+  const std::size_t num_forced_one_rows;
+  const std::size_t num_forced_one_cols;
+
+  // Pairs counted per chunk, and whether verified chunks of a previous run are
+  // kept rather than recounted
+  const std::size_t pairs_per_chunk;
+  const bool resume;
+
+  // Node-local directory the chunks are staged in, or empty to write them to
+  // the scratch directory. Staged chunks are sent to rank 0 to be combined.
+  const std::string local_dir;
+
+  // A pair gallops through the longer NA list when it is this many times
+  // longer than the shorter one
+  static const std::size_t GALLOP_RATIO = 16;
 
   std::vector<std::size_t> free_rows;
   std::vector<std::size_t> free_cols;
+  std::vector<std::size_t> row_weights;
+  std::vector<std::size_t> col_weights;
+
+  // NA lists of the lines whose pairs are being counted, restricted to the
+  // free other lines, and the weight of every other line by its index
+  std::vector<std::size_t> weight_of;
+  std::vector<std::uint64_t> free_mask;
+  std::vector<std::size_t> na_start;
+  std::vector<std::size_t> na_list;
+  std::vector<std::size_t> na_weight;
 
   FILE *output;
   
   void open_file(const std::string &file_name);
   void close_file();
-  void record_pair_count(const std::vector<std::size_t> &count, FILE *stream) const;
+  std::string format_pair_count(const std::vector<std::size_t> &count) const;
+  void record_phases(const Timer &total, const Timer &write) const;
+
+  std::size_t get_total_weight(const bool is_row) const;
+  std::vector<std::size_t> get_chunk_starts(const std::size_t num_lines) const;
+  std::uint64_t get_table_key(const bool is_row) const;
+  std::string get_chunk_file(const bool is_row, const std::size_t chunk) const;
+  bool read_chunk(const bool is_row,
+                  const std::size_t chunk,
+                  const std::size_t first,
+                  const std::size_t last,
+                  const std::uint64_t key,
+                  std::string &contents) const;
+  void write_chunk(const bool is_row,
+                   const std::size_t chunk,
+                   const std::size_t first,
+                   const std::size_t last,
+                   const std::uint64_t key,
+                   const std::vector<std::size_t> &lines,
+                   const std::size_t total_weight,
+                   Timer &write_timer);
+  void build_na_lists(const bool is_row,
+                      const std::vector<std::size_t> &lines,
+                      const std::vector<std::size_t> &other_lines,
+                      const std::vector<std::size_t> &other_weights);
+  std::size_t count_pair(const bool is_row,
+                         const std::vector<std::size_t> &lines,
+                         const std::size_t idx,
+                         const std::size_t idx2,
+                         const std::size_t total_weight) const;
+  void count_pairs(const bool is_row,
+                   const std::vector<std::size_t> &lines,
+                   const std::vector<std::size_t> &other_lines,
+                   const std::vector<std::size_t> &other_weights);
+  void combine_chunks(const bool is_row,
+                      const std::vector<std::size_t> &lines,
+                      const ChunkFetcher &fetch) const;
+  void remove_chunks(const std::size_t first, const std::size_t step) const;
+  void update_pairs(const bool is_row,
+                    const std::vector<std::size_t> &lines,
+                    const std::vector<std::size_t> &old_lines,
+                    const std::vector<std::size_t> &other_lines,
+                    const std::vector<std::size_t> &other_weights,
+                    const std::size_t total_weight,
+                    const std::vector<bool> &changed,
+                    const std::string &file_name);
+
+  template<typename F>
+  void for_each_na(const bool is_row, const std::size_t line, F f) const {
+    if (is_row) {
+      data->for_each_na_in_row(line, f);
+    } else {
+      data->for_each_na_in_col(line, f);
+    }
+  }
 
 public:
   CalcPairsCore(const BinContainer &_data,
                 const std::string &_scratch_dir,
+                const std::size_t _num_forced_one_rows,
+                const std::size_t _num_forced_one_cols,
                 const std::vector<std::size_t> &_free_rows,
-                const std::vector<std::size_t> &_free_cols);
+                const std::vector<std::size_t> &_free_cols,
+                const std::vector<std::size_t> &_row_weights,
+                const std::vector<std::size_t> &_col_weights,
+                const std::size_t _pairs_per_chunk,
+                const bool _resume = true,
+                const std::string &_local_dir = "",
+                const std::size_t _world_rank = 0,
+                const std::size_t _world_size = 1);
   ~CalcPairsCore();
 
   void work();
+  void combine(const ChunkFetcher &fetch = nullptr) const;
+  void serve_chunks(const ChunkRequest &next_request, const ChunkReply &reply) const;
+  void count(const bool is_row,
+             const std::vector<unsigned int> &max_thresholds,
+             const std::size_t num_threads,
+             Pairs &pairs);
+  void update(const std::vector<std::size_t> &old_free_rows,
+              const std::vector<std::size_t> &old_free_cols,
+              const std::vector<bool> &changed_rows,
+              const std::vector<bool> &changed_cols);
+
+  static std::string make_local_dir(const std::string &local_root, const std::string &scratch_dir);
 };
 
 
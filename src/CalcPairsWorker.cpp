@@ -1,91 +1,113 @@
 #include "CalcPairsWorker.h"
 #include "Parallel.h"
 #include "CalcPairsCore.h"
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
 
 CalcPairsWorker::CalcPairsWorker(const BinContainer &_data,
-                                 const std::string &_scratch_dir) : data(&_data),
-                                                                    num_rows(data->get_num_data_rows()),
-                                                                    num_cols(data->get_num_data_cols()),
-                                                                    scratch_dir(_scratch_dir),
-                                                                    world_rank(Parallel::get_world_rank()) {}
+                                 const std::string &_scratch_dir,
+                                 const std::size_t _pairs_per_chunk,
+                                 const std::string &_local_dir) : data(&_data),
+                                                                  num_rows(data->get_num_data_rows()),
+                                                                  num_cols(data->get_num_data_cols()),
+                                                                  scratch_dir(_scratch_dir),
+                                                                  world_rank(Parallel::get_world_rank()),
+                                                                  world_size(Parallel::get_world_size()),
+                                                                  pairs_per_chunk(_pairs_per_chunk),
+                                                                  local_dir(_local_dir),
+                                                                  end_(false) {}
 
 CalcPairsWorker::~CalcPairsWorker() {}
 
 void CalcPairsWorker::work() {
+  // The controller ends the workers without starting them when it updates the
+  // pairs of a previous run on its own
   receive_start();
-
-  read_free_rows();
-  read_free_cols();
-
-  CalcPairsCore core(*data, scratch_dir, free_rows, free_cols);
+  if (end_) {return;}
+
+  // The presolve result follows the start, so no rank reads it from the
+  // scratch directory
+  receive_indices(forced_one_rows);
+  receive_indices(forced_one_cols);
+  receive_indices(free_rows);
+  receive_indices(free_cols);
+  receive_indices(row_weights);
+  receive_indices(col_weights);
+
+  CalcPairsCore core(*data, scratch_dir, forced_one_rows.size(), forced_one_cols.size(), free_rows, free_cols, row_weights, col_weights,
+                     pairs_per_chunk, true, local_dir, world_rank, world_size);
   core.work();
 
   send_completion();
+
+  // Staged chunks are only on this node until the controller has combined them
+  if (!local_dir.empty()) {
+    core.serve_chunks([this](bool &is_row, std::size_t &chunk) {
+      return receive_chunk_request(is_row, chunk);
+    }, [this](const bool is_row, const std::size_t chunk, const bool found, const std::string &contents) {
+      send_chunk(is_row, chunk, found, contents);
+    });
+  }
 }
 
 bool CalcPairsWorker::end() const {
   return end_;
 }
 
-FILE* CalcPairsWorker::open_file_for_read(const std::string &file_name) const {
-  FILE* input;
-  if ((input = fopen(file_name.c_str(), "r")) == nullptr) {
-    fprintf(stderr, "ERROR - Could not open file %s\n", file_name.c_str());
-    exit(1);
+// Receives a list of indices sent by the controller as its size followed by
+// its elements.
+void CalcPairsWorker::receive_indices(std::vector<std::size_t> &indices) {
+  std::size_t n;
+  Parallel::recv(&n, 1, CUSTOM_SIZE_T, 0, Parallel::SPARSE_TAG);
+  indices.resize(n);
+  if (n > 0) {
+    Parallel::recv(indices.data(), n, CUSTOM_SIZE_T, 0, Parallel::SPARSE_TAG);
   }
-  return input;
 }
 
-void CalcPairsWorker::read_free_rows() {
-  std::string file_name = scratch_dir + "freeRows.txt";
-  FILE* input = open_file_for_read(file_name);
-  char tmp_str[50];
-
-  while (true) {
-    fscanf(input, "%s", tmp_str);
-
-    if (feof(input)) {
-      break;
-    }
-
-    free_rows.push_back(std::stoul(tmp_str));
-  }
-
-  fclose(input);
+// Receives the controller's request for a staged chunk of this rank. Returns
+// false once the controller has combined every chunk.
+bool CalcPairsWorker::receive_chunk_request(bool &is_row, std::size_t &chunk) const {
+  std::size_t request[2];
+  Parallel::recv(request, 2, CUSTOM_SIZE_T, 0, Parallel::CHUNK_TAG);
+  is_row = (request[0] == 1);
+  chunk = request[1];
+  return chunk != Parallel::END_OF_CHUNKS;
 }
 
-void CalcPairsWorker::read_free_cols() {
-  std::string file_name = scratch_dir + "freeCols.txt";
-  FILE* input = open_file_for_read(file_name);
-  char tmp_str[50];
-
-  while (true) {
-    fscanf(input, "%s", tmp_str);
-
-    if (feof(input)) {
-      break;
-    }
-
-    free_cols.push_back(std::stoul(tmp_str));
+// Sends the requested chunk of the row (column) table to the controller as
+// whether it was found and its size, followed by its contents.
+void CalcPairsWorker::send_chunk(const bool is_row,
+                                 const std::size_t chunk,
+                                 const bool found,
+                                 const std::string &contents) const {
+  if (found && contents.size() > INT_MAX) {
+    fprintf(stderr, "ERROR - Chunk %lu of the %s pairs holds more than %d bytes, lower PAIRS_PER_CHUNK\n", chunk, is_row ? "row" : "column", INT_MAX);
+    exit(1);
   }
 
-  fclose(input);
+  const std::size_t reply[2] = {found ? 1u : 0u, found ? contents.size() : 0};
+  Parallel::send(reply, 2, CUSTOM_SIZE_T, 0, Parallel::CHUNK_TAG);
+  if (reply[1] > 0) {
+    Parallel::send(contents.data(), reply[1], MPI_CHAR, 0, Parallel::CHUNK_TAG);
+  }
 }
 
 void CalcPairsWorker::send_completion() {
   const int status = 1;
 
-  MPI_Send(&status, 1, MPI_INT, 0, Parallel::SPARSE_TAG, MPI_COMM_WORLD);
+  Parallel::send(&status, 1, MPI_INT, 0, Parallel::SPARSE_TAG);
 }
 
 void CalcPairsWorker::receive_start() {
   MPI_Status status;
 
   // Check if received a signal to end
-  MPI_Probe(0, MPI_ANY_TAG, MPI_COMM_WORLD, &status);
+  Parallel::probe(0, status);
   if (status.MPI_TAG == Parallel::CONVERGE_TAG) {
     char signal;
-    MPI_Recv(&signal, 1, MPI_CHAR, 0, Parallel::CONVERGE_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    Parallel::recv(&signal, 1, MPI_CHAR, 0, Parallel::CONVERGE_TAG);
     end_ = true;
     
     #ifndef NDEBUG
@@ -96,5 +118,5 @@ void CalcPairsWorker::receive_start() {
   }
 
   int start;
-  MPI_Recv(&start, 1, MPI_INT, status.MPI_SOURCE, Parallel::SPARSE_TAG, MPI_COMM_WORLD, &status);  
+  Parallel::recv(&start, 1, MPI_INT, status.MPI_SOURCE, Parallel::SPARSE_TAG, &status);  
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #ifndef CALC_PAIRS_WORKER_H
 #define CALC_PAIRS_WORKER_H
 
+#include <string>
 #include <vector>
 #include "BinContainer.h"
 
@@ -12,9 +13,16 @@ private:
   const std::size_t num_cols;
   const std::string scratch_dir;
   const std::size_t world_rank;
+  const std::size_t world_size;
+  const std::size_t pairs_per_chunk;
+  const std::string local_dir;
 
+  std::vector<std::size_t> forced_one_rows;
+  std::vector<std::size_t> forced_one_cols;
   std::vector<std::size_t> free_rows;
   std::vector<std::size_t> free_cols;
+  std::vector<std::size_t> row_weights;
+  std::vector<std::size_t> col_weights;
 
   int row_col;
   std::size_t idx;
@@ -22,16 +30,19 @@ private:
 
   bool end_;
 
-  FILE* open_file_for_read(const std::string &file_name) const;
-  void read_free_rows();
-  void read_free_cols();
+  void receive_indices(std::vector<std::size_t> &indices);
 
   void send_completion();
   void receive_start();
 
+  bool receive_chunk_request(bool &is_row, std::size_t &chunk) const;
+  void send_chunk(const bool is_row, const std::size_t chunk, const bool found, const std::string &contents) const;
+
 public:
   CalcPairsWorker(const BinContainer &_data, 
-                  const std::string &_scratch_dir);
+                  const std::string &_scratch_dir,
+                  const std::size_t _pairs_per_chunk,
+                  const std::string &_local_dir = "");
   ~CalcPairsWorker();
 
   void work();
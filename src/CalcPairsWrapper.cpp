@@ -3,9 +3,13 @@
 
 #include "BinContainer.h"
 #include "Timer.h"
+#include "ConfigParser.h"
+#include "Presolve.h"
 #include "CalcPairsController.h"
 #include "CalcPairsWorker.h"
+#include "CalcPairsCore.h"
 #include "Parallel.h"
+#include "PhaseTimer.h"
 
 int main(int argc, char* argv[]) {
   //*
@@ -33,12 +37,27 @@ int main(int argc, char* argv[]) {
     std::size_t num_header_cols = std::stoul(argv[5]);
     
     BinContainer data(data_file, na_symbol, num_header_rows, num_header_cols);
+    ConfigParser parser("config.cfg");
+    const bool WRITE_STATS = parser.getBool("WRITE_STATS");
+    const std::size_t PAIRS_PER_CHUNK = parser.getSizeT("PAIRS_PER_CHUNK");
+    const std::string LOCAL_SCRATCH_DIR = parser.getString("LOCAL_SCRATCH_DIR");
+
+    // Chunks are staged on node-local storage and only the combined tables
+    // are written to the scratch directory
+    const std::string local_dir = (LOCAL_SCRATCH_DIR == "none" ? "" : CalcPairsCore::make_local_dir(LOCAL_SCRATCH_DIR, scratch_dir));
 
     switch (world_rank) {
       case 0: {
+        const bool PRESOLVE = parser.getBool("PRESOLVE");
+        const bool INCREMENTAL_PAIRS = parser.getBool("INCREMENTAL_PAIRS");
+
         Timer timer;
         timer.start();
-        CalcPairsController controller(data, scratch_dir);
+        Presolve presolve(data);
+        if (PRESOLVE) {
+          presolve.run();
+        }
+        CalcPairsController controller(data, scratch_dir, presolve, PAIRS_PER_CHUNK, INCREMENTAL_PAIRS, local_dir);
 
         controller.work();
 
@@ -55,17 +74,17 @@ int main(int argc, char* argv[]) {
           fprintf(output, "ERROR - Could not open file (%s)\n", file_name.c_str());
           exit(1);
         }
-        fprintf(output, "%s,%lf\n", data_file.c_str(), timer.elapsed_cpu_time());
+        fprintf(output, "%s,%lf,%lf\n", data_file.c_str(), timer.elapsed_cpu_time(), timer.elapsed_wall_time());
         fclose(output);
 
         fprintf(stderr, "Summary of CalcPairs\n");
-        fprintf(stderr, "\tTook %lf seconds\n\n", timer.elapsed_cpu_time());
+        fprintf(stderr, "\tTook %lf seconds\n\n", timer.elapsed_wall_time());
         
         break;
       }
 
       default: {
-        CalcPairsWorker worker(data, scratch_dir);
+        CalcPairsWorker worker(data, scratch_dir, PAIRS_PER_CHUNK, local_dir);
         // while (!worker.end()) {
           worker.work();
         // }
@@ -73,6 +92,12 @@ int main(int argc, char* argv[]) {
         break;
       }
     }
+
+    // Every rank appends the phases it timed
+    if (WRITE_STATS) {
+      PhaseTimer::write_to_file("CalcPairs_phases.csv", data_file, world_rank);
+    }
+    Parallel::report(WRITE_STATS ? "CalcPairs_mpi.csv" : "", data_file);
   } catch (std::exception &e) {
     fprintf(stderr, "  *** Fatal error reported by rank_%d: %s *** \n", world_rank, e.what());    
     MPI_Abort(MPI_COMM_WORLD, 1);
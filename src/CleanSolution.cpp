@@ -97,9 +97,12 @@ void CleanSolution::write_to_file(const std::string &file_name) {
   fclose(sol);
 }
 
+// Reads a solution written either by write_to_file (rows, then columns, each
+// on one tab-separated line) or by noMissSummary::write_solution_to_file (one
+// value per line). Both list the rows before the columns.
 void CleanSolution::read_from_file(const std::string &file_name) {
   std::ifstream sol;
-  std::string line, s;
+  std::string s;
 
   sol.open(file_name.c_str());
   if (!sol) {
@@ -107,41 +110,23 @@ void CleanSolution::read_from_file(const std::string &file_name) {
     exit(EXIT_FAILURE);
   }
 
-  std::getline(sol, line); // Read in first line  
-  std::istringstream iss(line);
-  std::vector<int> tmp_rows, tmp_cols;
-
-  while (std::getline(iss, s, '\t')) {
-    if (s.compare("1") == 0) {
-      tmp_rows.push_back(1);
-    } else if (s.compare("0") == 0) {
-      tmp_rows.push_back(0);
-    } else {
-      fprintf(stderr, "ERROR - unkwown value in solutions file %s in %s\n", s.c_str(), file_name.c_str());
-    }
-  }
-  if (tmp_rows.size() != rows_to_keep.size()) {
-    fprintf(stderr, "ERROR - Read in %lu rows from solution, but expected %lu.\n", tmp_rows.size(), rows_to_keep.size());
-  }
-
-  std::getline(sol, line); // Read in first line 
-  iss.clear();
-  iss.str(line);
-  while (std::getline(iss, s, '\t')) {
+  std::vector<int> values;
+  while (sol >> s) {
     if (s.compare("1") == 0) {
-      tmp_cols.push_back(1);
+      values.push_back(1);
     } else if (s.compare("0") == 0) {
-      tmp_cols.push_back(0);
+      values.push_back(0);
     } else {
       fprintf(stderr, "ERROR - unkwown value in solutions file %s in %s\n", s.c_str(), file_name.c_str());
     }
   }
-  if (tmp_cols.size() != cols_to_keep.size()) {
-    fprintf(stderr, "ERROR - Read in %lu rows from solution, but expected %lu.\n", tmp_cols.size(), cols_to_keep.size());
+  if (values.size() != rows_to_keep.size() + cols_to_keep.size()) {
+    fprintf(stderr, "ERROR - Read in %lu values from solution, but expected %lu.\n", values.size(), rows_to_keep.size() + cols_to_keep.size());
+    exit(1);
   }
 
-  rows_to_keep = tmp_rows;
-  cols_to_keep = tmp_cols;
+  std::copy(values.begin(), values.begin() + rows_to_keep.size(), rows_to_keep.begin());
+  std::copy(values.begin() + rows_to_keep.size(), values.end(), cols_to_keep.begin());
 }
 
 std::vector<int> CleanSolution::get_rows_to_keep() const {
@@ -0,0 +1,414 @@
+#include "ComponentDecomposition.h"
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include "ThreadPool.h"
+#include "Utils.h"
+
+//------------------------------------------------------------------------------
+// Constructor. Components whose smaller side has at most 'max_enum_size' lines
+// are enumerated; larger ones are only bounded. The size may not exceed 63, as
+// an enumerated subset is stored in one word.
+//------------------------------------------------------------------------------
+ComponentDecomposition::ComponentDecomposition(const BinContainer &_data,
+                                               const std::size_t _max_enum_size) : data(&_data),
+                                                                                   num_rows(data->get_num_data_rows()),
+                                                                                   num_cols(data->get_num_data_cols()),
+                                                                                   max_enum_size(_max_enum_size),
+                                                                                   row_position(num_rows, 0),
+                                                                                   col_position(num_cols, 0),
+                                                                                   num_elements(0),
+                                                                                   upper_bound(0),
+                                                                                   rows_to_keep(num_rows, false),
+                                                                                   cols_to_keep(num_cols, false) {
+  if (max_enum_size > 63) {
+    fprintf(stderr, "ERROR - Components can only be enumerated up to 63 rows or columns\n");
+    exit(1);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Destructor.
+//------------------------------------------------------------------------------
+ComponentDecomposition::~ComponentDecomposition() {}
+
+//------------------------------------------------------------------------------
+// Joins every row with the columns it is missing using union-find. Rows and
+// columns missing no data are left out of the components.
+//------------------------------------------------------------------------------
+void ComponentDecomposition::find_components() {
+  std::vector<std::size_t> parent(num_rows + num_cols);
+  std::iota(parent.begin(), parent.end(), 0);
+  auto find = [&parent](std::size_t x) {
+    while (parent[x] != x) {
+      parent[x] = parent[parent[x]];
+      x = parent[x];
+    }
+    return x;
+  };
+
+  for (std::size_t i = 0; i < num_rows; ++i) {
+    data->for_each_na_in_row(i, [&](const std::size_t j) {
+      const std::size_t a = find(i);
+      const std::size_t b = find(num_rows + j);
+      if (a != b) {
+        parent[std::max(a, b)] = std::min(a, b);
+      }
+    });
+  }
+
+  complete_rows.clear();
+  complete_cols.clear();
+  components.clear();
+  std::vector<long> component_of(num_rows + num_cols, -1);
+  for (std::size_t i = 0; i < num_rows; ++i) {
+    if (data->get_num_invalid_in_row(i) == 0) {
+      complete_rows.push_back(i);
+      continue;
+    }
+    const std::size_t root = find(i);
+    if (component_of[root] < 0) {
+      component_of[root] = components.size();
+      components.push_back(Component());
+    }
+    Component &comp = components[component_of[root]];
+    row_position[i] = comp.rows.size();
+    comp.rows.push_back(i);
+  }
+  for (std::size_t j = 0; j < num_cols; ++j) {
+    if (data->get_num_invalid_in_col(j) == 0) {
+      complete_cols.push_back(j);
+      continue;
+    }
+    Component &comp = components[component_of[find(num_rows + j)]];
+    col_position[j] = comp.cols.size();
+    comp.cols.push_back(j);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Returns, for every row of 'comp', the bitset of the component columns it is
+// missing, or for every column the bitset of the component rows if 'by_cols'.
+//------------------------------------------------------------------------------
+std::vector<std::vector<std::uint64_t>> ComponentDecomposition::local_missing(const Component &comp, const bool by_cols) const {
+  const std::vector<std::size_t> &lines = by_cols ? comp.cols : comp.rows;
+  const std::size_t num_other = by_cols ? comp.rows.size() : comp.cols.size();
+  const std::size_t num_words = (num_other + BinContainer::BITS_PER_WORD - 1) / BinContainer::BITS_PER_WORD;
+
+  std::vector<std::vector<std::uint64_t>> missing(lines.size(), std::vector<std::uint64_t>(num_words, 0));
+  for (std::size_t k = 0; k < lines.size(); ++k) {
+    std::vector<std::uint64_t> &bits = missing[k];
+    auto set = [&bits](const std::size_t pos) {
+      bits[pos / BinContainer::BITS_PER_WORD] |= std::uint64_t(1) << (pos % BinContainer::BITS_PER_WORD);
+    };
+    if (by_cols) {
+      data->for_each_na_in_col(lines[k], [&](const std::size_t i) { set(row_position[i]); });
+    } else {
+      data->for_each_na_in_row(lines[k], [&](const std::size_t j) { set(col_position[j]); });
+    }
+  }
+  return missing;
+}
+
+//------------------------------------------------------------------------------
+// Finds the exact frontier of 'comp' by trying every subset of its rows, or of
+// its columns if 'by_cols'. A subset of rows keeps the columns none of them
+// is missing, and a subset of columns the rows missing none of them. Keeping
+// fewer rows never loses a column, so the frontier is then made
+// non-increasing.
+//------------------------------------------------------------------------------
+void ComponentDecomposition::enumerate(Component &comp, const bool by_cols) const {
+  const std::size_t num_lines = by_cols ? comp.cols.size() : comp.rows.size();
+  const std::size_t num_other = by_cols ? comp.rows.size() : comp.cols.size();
+  const std::vector<std::vector<std::uint64_t>> missing = local_missing(comp, by_cols);
+
+  comp.by_cols = by_cols;
+  comp.lower.assign(comp.rows.size() + 1, 0);
+  comp.best_subset.assign(comp.rows.size() + 1, 0);
+  comp.lower[0] = comp.cols.size();
+  if (by_cols) {
+    comp.best_subset[0] = (std::uint64_t(1) << num_lines) - 1;
+  }
+
+  // Union of the missing sets of the lines chosen so far, at every depth
+  std::vector<std::vector<std::uint64_t>> unions(num_lines + 1, std::vector<std::uint64_t>(missing.empty() ? 0 : missing[0].size(), 0));
+  std::function<void(std::size_t, std::size_t, std::uint64_t)> search = [&](const std::size_t next,
+                                                                            const std::size_t depth,
+                                                                            const std::uint64_t subset) {
+    const std::size_t num_kept = num_other - utils::count_bits(unions[depth]);
+    const std::size_t a = by_cols ? num_kept : depth;
+    const std::size_t b = by_cols ? depth : num_kept;
+    if (b > comp.lower[a]) {
+      comp.lower[a] = b;
+      comp.best_subset[a] = subset;
+    }
+    if (num_kept == 0) return;
+
+    for (std::size_t k = next; k < num_lines; ++k) {
+      for (std::size_t w = 0; w < unions[depth].size(); ++w) {
+        unions[depth+1][w] = unions[depth][w] | missing[k][w];
+      }
+      search(k + 1, depth + 1, subset | (std::uint64_t(1) << k));
+    }
+  };
+  search(0, 0, 0);
+
+  for (std::size_t a = comp.rows.size(); a-- > 0;) {
+    if (comp.lower[a+1] > comp.lower[a]) {
+      comp.lower[a] = comp.lower[a+1];
+      comp.best_subset[a] = comp.best_subset[a+1];
+    }
+  }
+  comp.upper = comp.lower;
+  comp.exact = true;
+}
+
+//------------------------------------------------------------------------------
+// Bounds the frontier of 'comp' when it is too large to enumerate. The lower
+// frontier comes from a greedy that adds the row missing the fewest of the
+// remaining columns. With 'a' rows kept, every kept column is valid in all of
+// them and every kept row in all kept columns, so neither the number of
+// columns valid in at least 'a' rows nor the valid count of the a-th most
+// complete row can be exceeded.
+//------------------------------------------------------------------------------
+void ComponentDecomposition::bound(Component &comp) const {
+  const std::size_t num_comp_rows = comp.rows.size();
+  const std::size_t num_comp_cols = comp.cols.size();
+  const std::vector<std::vector<std::uint64_t>> row_missing = local_missing(comp, false);
+  const std::vector<std::vector<std::uint64_t>> col_missing = local_missing(comp, true);
+
+  // Greedy lower frontier. 'conflicts' counts the remaining columns a row misses
+  std::vector<std::size_t> conflicts(num_comp_rows);
+  for (std::size_t r = 0; r < num_comp_rows; ++r) {
+    conflicts[r] = utils::count_bits(row_missing[r]);
+  }
+  std::vector<bool> col_left(num_comp_cols, true);
+  std::vector<bool> row_used(num_comp_rows, false);
+  std::size_t num_cols_left = num_comp_cols;
+
+  comp.by_cols = false;
+  comp.best_subset.clear();
+  comp.row_order.clear();
+  comp.lower.assign(num_comp_rows + 1, 0);
+  comp.lower[0] = num_comp_cols;
+  for (std::size_t a = 1; a <= num_comp_rows; ++a) {
+    std::size_t best = num_comp_rows;
+    for (std::size_t r = 0; r < num_comp_rows; ++r) {
+      if (!row_used[r] && (best == num_comp_rows || conflicts[r] < conflicts[best])) {
+        best = r;
+      }
+    }
+    row_used[best] = true;
+    comp.row_order.push_back(best);
+    num_cols_left -= conflicts[best];
+    utils::for_each_set_bit(row_missing[best], [&](const std::size_t c) {
+      if (!col_left[c]) return;
+      col_left[c] = false;
+      utils::for_each_set_bit(col_missing[c], [&conflicts](const std::size_t r) { --conflicts[r]; });
+    });
+    comp.lower[a] = num_cols_left;
+  }
+
+  // Upper frontier
+  std::vector<std::size_t> valid_in_col(num_comp_cols), valid_in_row(num_comp_rows);
+  for (std::size_t c = 0; c < num_comp_cols; ++c) {
+    valid_in_col[c] = num_comp_rows - utils::count_bits(col_missing[c]);
+  }
+  for (std::size_t r = 0; r < num_comp_rows; ++r) {
+    valid_in_row[r] = num_comp_cols - utils::count_bits(row_missing[r]);
+  }
+  std::sort(valid_in_col.begin(), valid_in_col.end(), std::greater<std::size_t>());
+  std::sort(valid_in_row.begin(), valid_in_row.end(), std::greater<std::size_t>());
+
+  comp.upper.assign(num_comp_rows + 1, 0);
+  comp.upper[0] = num_comp_cols;
+  std::size_t num_cols_with_a = num_comp_cols;
+  for (std::size_t a = 1; a <= num_comp_rows; ++a) {
+    while (num_cols_with_a > 0 && valid_in_col[num_cols_with_a-1] < a) {
+      --num_cols_with_a;
+    }
+    comp.upper[a] = std::min(num_cols_with_a, valid_in_row[a-1]);
+  }
+  comp.exact = comp.upper == comp.lower;
+}
+
+void ComponentDecomposition::solve_component(Component &comp) const {
+  if (std::min(comp.rows.size(), comp.cols.size()) <= max_enum_size) {
+    enumerate(comp, comp.cols.size() < comp.rows.size());
+  } else {
+    bound(comp);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Keeps 'num_comp_rows' rows of 'comp' as chosen when its frontier was found,
+// and every column of the component valid in all of them.
+//------------------------------------------------------------------------------
+void ComponentDecomposition::keep_component(const Component &comp, const std::size_t num_comp_rows) {
+  std::vector<std::size_t> rows;
+  if (comp.lower[num_comp_rows] == 0) {
+    rows.assign(comp.rows.begin(), comp.rows.begin() + num_comp_rows);
+  } else if (comp.best_subset.empty()) {
+    for (std::size_t k = 0; k < num_comp_rows; ++k) {
+      rows.push_back(comp.rows[comp.row_order[k]]);
+    }
+  } else if (!comp.by_cols) {
+    const std::uint64_t subset = comp.best_subset[num_comp_rows];
+    for (std::size_t r = 0; r < comp.rows.size() && rows.size() < num_comp_rows; ++r) {
+      if (subset >> r & 1) {
+        rows.push_back(comp.rows[r]);
+      }
+    }
+  } else {
+    const std::uint64_t subset = comp.best_subset[num_comp_rows];
+    for (std::size_t r = 0; r < comp.rows.size() && rows.size() < num_comp_rows; ++r) {
+      bool valid = true;
+      for (std::size_t c = 0; c < comp.cols.size() && valid; ++c) {
+        valid = !(subset >> c & 1) || !data->is_data_na(comp.rows[r], comp.cols[c]);
+      }
+      if (valid) {
+        rows.push_back(comp.rows[r]);
+      }
+    }
+  }
+
+  for (auto i : rows) {
+    rows_to_keep[i] = true;
+  }
+  for (auto j : comp.cols) {
+    bool valid = true;
+    for (std::size_t k = 0; k < rows.size() && valid; ++k) {
+      valid = !data->is_data_na(rows[k], j);
+    }
+    cols_to_keep[j] = valid;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Combines the component frontiers. Components share no missing data, so any
+// choice of rows and columns per component is valid together, and keeping r
+// component rows gives at most the knapsack-style sum of the component
+// frontiers over the ways of splitting r between them. The best product with
+// the complete rows and columns is kept, and the same merge over the upper
+// frontiers bounds the optimum.
+//------------------------------------------------------------------------------
+void ComponentDecomposition::merge() {
+  std::vector<long> lower_cols(1, 0), upper_cols(1, 0);
+  std::vector<std::vector<std::uint32_t>> choice(components.size());
+
+  for (std::size_t t = 0; t < components.size(); ++t) {
+    const Component &comp = components[t];
+    const std::size_t size = lower_cols.size() + comp.rows.size();
+    std::vector<long> next_lower(size, -1), next_upper(size, -1);
+    choice[t].assign(size, 0);
+
+    for (std::size_t r = 0; r < lower_cols.size(); ++r) {
+      for (std::size_t a = 0; a <= comp.rows.size(); ++a) {
+        const long lower = lower_cols[r] + static_cast<long>(comp.lower[a]);
+        if (lower > next_lower[r+a]) {
+          next_lower[r+a] = lower;
+          choice[t][r+a] = a;
+        }
+        next_upper[r+a] = std::max(next_upper[r+a], upper_cols[r] + static_cast<long>(comp.upper[a]));
+      }
+    }
+    lower_cols.swap(next_lower);
+    upper_cols.swap(next_upper);
+  }
+
+  std::size_t best_r = 0;
+  num_elements = 0;
+  upper_bound = 0;
+  for (std::size_t r = 0; r < lower_cols.size(); ++r) {
+    const std::size_t kept_rows = complete_rows.size() + r;
+    const std::size_t lower = kept_rows * (complete_cols.size() + lower_cols[r]);
+    if (lower > num_elements) {
+      num_elements = lower;
+      best_r = r;
+    }
+    upper_bound = std::max(upper_bound, kept_rows * (complete_cols.size() + upper_cols[r]));
+  }
+
+  std::fill(rows_to_keep.begin(), rows_to_keep.end(), false);
+  std::fill(cols_to_keep.begin(), cols_to_keep.end(), false);
+  for (auto i : complete_rows) {
+    rows_to_keep[i] = true;
+  }
+  for (auto j : complete_cols) {
+    cols_to_keep[j] = true;
+  }
+  for (std::size_t t = components.size(); t-- > 0;) {
+    const std::size_t a = choice[t][best_r];
+    keep_component(components[t], a);
+    best_r -= a;
+  }
+  num_elements = data->get_num_valid_data_kept(rows_to_keep, cols_to_keep);
+}
+
+//------------------------------------------------------------------------------
+// Finds the components, solves or bounds them with 'num_threads' threads,
+// largest first, and merges the results.
+//------------------------------------------------------------------------------
+void ComponentDecomposition::solve(const std::size_t num_threads) {
+  find_components();
+
+  std::vector<std::size_t> order(components.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [this](const std::size_t lhs, const std::size_t rhs) {
+    return components[lhs].rows.size() + components[lhs].cols.size() > components[rhs].rows.size() + components[rhs].cols.size();
+  });
+
+  if (num_threads > 1 && components.size() > 1) {
+    ThreadPool pool(std::min(num_threads, components.size()));
+    for (auto t : order) {
+      pool.submit([this, t] { solve_component(components[t]); });
+    }
+    pool.wait();
+  } else {
+    for (auto t : order) {
+      solve_component(components[t]);
+    }
+  }
+
+  merge();
+}
+
+std::size_t ComponentDecomposition::get_num_components() const {
+  return components.size();
+}
+
+std::size_t ComponentDecomposition::get_num_exact_components() const {
+  return std::count_if(components.begin(), components.end(), [](const Component &comp) { return comp.exact; });
+}
+
+std::size_t ComponentDecomposition::get_largest_component_size() const {
+  std::size_t largest = 0;
+  for (auto &comp : components) {
+    largest = std::max(largest, comp.rows.size() + comp.cols.size());
+  }
+  return largest;
+}
+
+std::size_t ComponentDecomposition::get_upper_bound() const {
+  return upper_bound;
+}
+
+std::vector<bool> ComponentDecomposition::get_rows_to_keep() const {
+  return rows_to_keep;
+}
+
+std::vector<bool> ComponentDecomposition::get_cols_to_keep() const {
+  return cols_to_keep;
+}
+
+std::size_t ComponentDecomposition::get_num_rows_to_keep() const {
+  return std::count(rows_to_keep.begin(), rows_to_keep.end(), true);
+}
+
+std::size_t ComponentDecomposition::get_num_cols_to_keep() const {
+  return std::count(cols_to_keep.begin(), cols_to_keep.end(), true);
+}
+
+std::size_t ComponentDecomposition::get_num_elements_to_keep() const {
+  return num_elements;
+}
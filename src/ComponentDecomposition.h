@@ -0,0 +1,74 @@
+#ifndef COMPONENT_DECOMPOSITION_H
+#define COMPONENT_DECOMPOSITION_H
+
+#include <cstdint>
+#include <vector>
+#include "BinContainer.h"
+
+class ComponentDecomposition
+{
+private:
+  // A connected component of the bipartite graph linking every row to the
+  // columns it is missing. 'lower[a]' is the most columns of the component
+  // found with 'a' of its rows kept and 'upper[a]' a bound on it; the two are
+  // equal when the component was enumerated.
+  struct Component {
+    std::vector<std::size_t> rows;
+    std::vector<std::size_t> cols;
+    std::vector<std::size_t> lower;
+    std::vector<std::size_t> upper;
+    bool exact;
+
+    // Enumerated components keep, for every 'a', the subset of rows (columns
+    // if 'by_cols') giving 'lower[a]'. Bounded components keep the order in
+    // which the greedy added their rows.
+    bool by_cols;
+    std::vector<std::uint64_t> best_subset;
+    std::vector<std::size_t> row_order;
+  };
+
+  const BinContainer *data;
+  const std::size_t num_rows;
+  const std::size_t num_cols;
+  const std::size_t max_enum_size;
+
+  // Rows and columns missing no data are in no component and always kept
+  std::vector<std::size_t> complete_rows;
+  std::vector<std::size_t> complete_cols;
+  std::vector<Component> components;
+
+  // Position of every row (column) within its component
+  std::vector<std::size_t> row_position;
+  std::vector<std::size_t> col_position;
+
+  std::size_t num_elements;
+  std::size_t upper_bound;
+  std::vector<bool> rows_to_keep;
+  std::vector<bool> cols_to_keep;
+
+  void find_components();
+  std::vector<std::vector<std::uint64_t>> local_missing(const Component &comp, const bool by_cols) const;
+  void enumerate(Component &comp, const bool by_cols) const;
+  void bound(Component &comp) const;
+  void solve_component(Component &comp) const;
+  void keep_component(const Component &comp, const std::size_t num_comp_rows);
+  void merge();
+
+public:
+  ComponentDecomposition(const BinContainer &_data, const std::size_t _max_enum_size);
+  ~ComponentDecomposition();
+
+  void solve(const std::size_t num_threads = 1);
+
+  std::size_t get_num_components() const;
+  std::size_t get_num_exact_components() const;
+  std::size_t get_largest_component_size() const;
+  std::size_t get_upper_bound() const;
+  std::vector<bool> get_rows_to_keep() const;
+  std::vector<bool> get_cols_to_keep() const;
+  std::size_t get_num_rows_to_keep() const;
+  std::size_t get_num_cols_to_keep() const;
+  std::size_t get_num_elements_to_keep() const;
+};
+
+#endif
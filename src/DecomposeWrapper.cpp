@@ -0,0 +1,79 @@
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <algorithm>
+#include "BinContainer.h"
+#include "ComponentDecomposition.h"
+#include "Timer.h"
+#include "PhaseTimer.h"
+#include "ConfigParser.h"
+#include "NoMissSummary.h"
+
+int main(int argc, char *argv[]) {
+
+// Check user input
+  if (!((argc == 3) || (argc == 5))) {
+    fprintf(stderr, "Usage: %s <data_file> <na_symbol> (opt)<num_header_rows> (opt)<num_header_cols>\n", argv[0]);
+    exit(1);
+  }
+  std::string data_file(argv[1]);
+  std::string na_symbol(argv[2]);
+  std::size_t num_header_rows = 1;
+  std::size_t num_header_cols = 1;
+
+  if (argc == 5) {
+    num_header_rows = std::stoul(argv[3]);
+    num_header_cols = std::stoul(argv[4]);
+  }
+
+  ConfigParser parser("config.cfg");
+  const bool PRINT_SUMMARY = parser.getBool("PRINT_SUMMARY");
+  const bool WRITE_STATS = parser.getBool("WRITE_STATS");
+  const std::size_t DECOMPOSE_MAX_ENUM = parser.getSizeT("DECOMPOSE_MAX_ENUM");
+  std::size_t NUM_THREADS = parser.getSizeT("NUM_THREADS");
+
+  if (NUM_THREADS == 0) {
+    NUM_THREADS = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  Timer timer;
+
+  // Read in data
+  BinContainer data(data_file, na_symbol, num_header_rows, num_header_cols);
+
+  // Solve or bound every component and merge them
+  ComponentDecomposition decomposition(data, DECOMPOSE_MAX_ENUM);
+  timer.start();
+  decomposition.solve(NUM_THREADS);
+  timer.stop();
+
+  std::vector<bool> rows_to_keep = decomposition.get_rows_to_keep();
+  std::vector<bool> cols_to_keep = decomposition.get_cols_to_keep();
+  const std::size_t num_rows_to_keep = decomposition.get_num_rows_to_keep();
+  const std::size_t num_cols_to_keep = decomposition.get_num_cols_to_keep();
+  const double run_time = timer.elapsed_wall_time();
+  const std::size_t num_val_elements = decomposition.get_num_elements_to_keep();
+
+  fprintf(stderr, "Found %lu components (largest has %lu rows and columns), %lu solved exactly\n",
+          decomposition.get_num_components(), decomposition.get_largest_component_size(), decomposition.get_num_exact_components());
+  fprintf(stderr, "Decomposition kept %lu elements, upper bound %lu\n", num_val_elements, decomposition.get_upper_bound());
+
+  // Record results
+  if (PRINT_SUMMARY) {
+    noMissSummary::summarize_results(data, na_symbol, "Decompose", run_time, num_rows_to_keep, num_cols_to_keep, rows_to_keep, cols_to_keep);
+  }
+
+  // Wrtie statistics to file
+  if (WRITE_STATS) {
+    noMissSummary::write_stats_to_file("Decompose_summary.csv", data_file, timer.elapsed_cpu_time(), run_time, num_val_elements, num_rows_to_keep, num_cols_to_keep);
+  }
+
+  noMissSummary::write_solution_to_file("Decompose.sol", rows_to_keep, cols_to_keep);
+
+  if (WRITE_STATS) {
+    PhaseTimer::write_to_file("Decompose_phases.csv", data_file);
+  }
+
+  return 0;
+}
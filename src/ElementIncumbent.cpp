@@ -0,0 +1,152 @@
+#include "ElementIncumbent.h"
+#include <algorithm>
+#include <cstdio>
+#include "IncumbentHeuristic.h"
+#include "NoMissSummary.h"
+
+//------------------------------------------------------------------------------
+// Constructor. Improves 'incumbent' with the combinatorial heuristic before
+// any problem is dispatched, so that the first min_cols values already prune,
+// and writes the result to '_sol_file'.
+//------------------------------------------------------------------------------
+ElementIncumbent::ElementIncumbent(const BinContainer &_data,
+                                   const CleanSolution &incumbent,
+                                   const double HEURISTIC_TIME_LIMIT,
+                                   const std::string &_sol_file) : data(&_data),
+                                                                   sol_file(_sol_file),
+                                                                   best_num_elements(incumbent.get_num_rows_kept() * incumbent.get_num_cols_kept()),
+                                                                   best_rows_to_keep(incumbent.get_rows_to_keep()),
+                                                                   best_cols_to_keep(incumbent.get_cols_to_keep()),
+                                                                   store(nullptr),
+                                                                   store_version(0) {
+  if (HEURISTIC_TIME_LIMIT > 0) {
+    IncumbentHeuristic heuristic(*data, HEURISTIC_TIME_LIMIT);
+    heuristic.run(best_rows_to_keep, best_cols_to_keep);
+    if (heuristic.get_best_num_elements() > best_num_elements) {
+      best_rows_to_keep = heuristic.get_rows_to_keep();
+      best_cols_to_keep = heuristic.get_cols_to_keep();
+      best_num_elements = heuristic.get_best_num_elements();
+    }
+    fprintf(stderr, "Heuristic incumbent: %lu\n", best_num_elements);
+  }
+
+  noMissSummary::write_solution_to_file(sol_file, best_rows_to_keep, best_cols_to_keep);
+}
+
+//------------------------------------------------------------------------------
+// Destructor.
+//------------------------------------------------------------------------------
+ElementIncumbent::~ElementIncumbent() {}
+
+//------------------------------------------------------------------------------
+// Reads the incumbent in 'incumbent_file', if any, and replaces it with the
+// presolve incumbent in 'scratch_dir' when that one is better. calcPairs
+// dropped the rows and columns that cannot beat its presolve incumbent, so the
+// sweep must start from at least that incumbent.
+//------------------------------------------------------------------------------
+CleanSolution ElementIncumbent::read(const BinContainer &_data,
+                                     const std::string &incumbent_file,
+                                     const std::string &scratch_dir) {
+  CleanSolution sol(_data.get_num_data_rows(), _data.get_num_data_cols());
+  if (!incumbent_file.empty()) {
+    sol.read_from_file(incumbent_file);
+  }
+
+  const std::string presolve_file = scratch_dir + "Presolve.sol";
+  FILE *test;
+  if ((test = fopen(presolve_file.c_str(), "r")) != nullptr) {
+    fclose(test);
+    CleanSolution presolved(_data.get_num_data_rows(), _data.get_num_data_cols());
+    presolved.read_from_file(presolve_file);
+    if (presolved.get_num_rows_kept() * presolved.get_num_cols_kept() > sol.get_num_rows_kept() * sol.get_num_cols_kept()) {
+      return presolved;
+    }
+  }
+  return sol;
+}
+
+void ElementIncumbent::keep(const std::vector<int> &rows_to_keep,
+                            const std::vector<int> &cols_to_keep,
+                            const std::size_t num_elements) {
+  best_rows_to_keep = rows_to_keep;
+  best_cols_to_keep = cols_to_keep;
+  best_num_elements = num_elements;
+  noMissSummary::write_solution_to_file(sol_file, best_rows_to_keep, best_cols_to_keep);
+}
+
+//------------------------------------------------------------------------------
+// Keeps a solution found by the sweep, with 'num_elements' elements, if it
+// beats the incumbent, and offers it to the store. Returns whether it was
+// kept.
+//------------------------------------------------------------------------------
+bool ElementIncumbent::update(const std::vector<int> &rows_to_keep,
+                              const std::vector<int> &cols_to_keep,
+                              const std::size_t num_elements) {
+  if (num_elements <= best_num_elements) {
+    return false;
+  }
+
+  keep(rows_to_keep, cols_to_keep, num_elements);
+  if (store != nullptr) {
+    store->offer(best_rows_to_keep, best_cols_to_keep, "elementIp");
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Exchanges the incumbent with the store of a portfolio run: the incumbent is
+// offered to the store, and any better solution published to it later is
+// taken by adopt_shared().
+//------------------------------------------------------------------------------
+void ElementIncumbent::set_store(IncumbentStore &_store) {
+  store = &_store;
+  store->offer(best_rows_to_keep, best_cols_to_keep, "elementIp");
+}
+
+//------------------------------------------------------------------------------
+// Adopts the best solution of the store if it beats the incumbent. Returns
+// whether it was adopted, so the solver can raise min_cols before its next
+// dispatch.
+//------------------------------------------------------------------------------
+bool ElementIncumbent::adopt_shared() {
+  if (store == nullptr) {
+    return false;
+  }
+
+  store->poll();
+  const std::size_t version = store->get_version();
+  if (version == store_version) {
+    return false;
+  }
+  store_version = version;
+
+  std::vector<int> rows_to_keep, cols_to_keep;
+  const std::size_t num_elements = store->get_best(rows_to_keep, cols_to_keep);
+  if (num_elements <= best_num_elements) {
+    return false;
+  }
+
+  keep(rows_to_keep, cols_to_keep, num_elements);
+  fprintf(stderr, "*** New shared incumbent: %lu ***\n", num_elements);
+  return true;
+}
+
+std::size_t ElementIncumbent::get_num_elements() const {
+  return best_num_elements;
+}
+
+const std::vector<int> &ElementIncumbent::get_rows_to_keep() const {
+  return best_rows_to_keep;
+}
+
+const std::vector<int> &ElementIncumbent::get_cols_to_keep() const {
+  return best_cols_to_keep;
+}
+
+std::size_t ElementIncumbent::get_num_rows_to_keep() const {
+  return std::count(best_rows_to_keep.begin(), best_rows_to_keep.end(), 1);
+}
+
+std::size_t ElementIncumbent::get_num_cols_to_keep() const {
+  return std::count(best_cols_to_keep.begin(), best_cols_to_keep.end(), 1);
+}
@@ -0,0 +1,58 @@
+#ifndef ELEMENT_INCUMBENT_H
+#define ELEMENT_INCUMBENT_H
+
+#include <string>
+#include <vector>
+#include "BinContainer.h"
+#include "CleanSolution.h"
+#include "IncumbentStore.h"
+
+// Incumbent of a row_sum sweep, shared by elementIp's controller and
+// elementIpThreaded. It starts from the given solution, improved by the
+// combinatorial heuristic, and every better solution is kept in 'sol_file'
+// and, in a portfolio run, exchanged with an IncumbentStore. The incumbent is
+// not locked; a solver running tasks on several threads must hold its own lock.
+class ElementIncumbent
+{
+private:
+  const BinContainer *data;
+  const std::string sol_file;
+
+  std::size_t best_num_elements;
+  std::vector<int> best_rows_to_keep;
+  std::vector<int> best_cols_to_keep;
+
+  // Portfolio store the incumbent is exchanged with, if any, and its version
+  // when the incumbent was last compared with it
+  IncumbentStore *store;
+  std::size_t store_version;
+
+  void keep(const std::vector<int> &rows_to_keep,
+            const std::vector<int> &cols_to_keep,
+            const std::size_t num_elements);
+
+public:
+  ElementIncumbent(const BinContainer &_data,
+                   const CleanSolution &incumbent,
+                   const double HEURISTIC_TIME_LIMIT,
+                   const std::string &_sol_file);
+  ~ElementIncumbent();
+
+  bool update(const std::vector<int> &rows_to_keep,
+              const std::vector<int> &cols_to_keep,
+              const std::size_t num_elements);
+  void set_store(IncumbentStore &_store);
+  bool adopt_shared();
+
+  std::size_t get_num_elements() const;
+  const std::vector<int> &get_rows_to_keep() const;
+  const std::vector<int> &get_cols_to_keep() const;
+  std::size_t get_num_rows_to_keep() const;
+  std::size_t get_num_cols_to_keep() const;
+
+  static CleanSolution read(const BinContainer &_data,
+                            const std::string &incumbent_file,
+                            const std::string &scratch_dir);
+};
+
+#endif
@@ -1,4 +1,5 @@
 #include "ElementIpSolver.h"
+#include "PhaseTimer.h"
 #include <assert.h>
 #include <cmath>
 
@@ -9,40 +10,69 @@ ElementIpSolver::ElementIpSolver(const BinContainer &_data,
                                  const std::vector<size_t> &_forced_one_cols,
                                  const std::vector<std::size_t> &_free_rows,
                                  const std::vector<std::size_t> &_free_cols,
-                                 const std::size_t _LARGE_MATRIX,
+                                 const std::vector<std::vector<std::size_t>> &_row_classes,
+                                 const std::vector<std::vector<std::size_t>> &_col_classes,
+                                 const Formulation::Type _formulation,
                                  const double _TOL) : data(&_data),
                                                       forced_one_rows(&_forced_one_rows),
                                                       forced_one_cols(&_forced_one_cols),
                                                       free_rows(&_free_rows),
                                                       free_cols(&_free_cols),
+                                                      row_classes(&_row_classes),
+                                                      col_classes(&_col_classes),
                                                       num_rows(free_rows->size()),
                                                       num_cols(free_cols->size()),
                                                       row_sum(_row_sum),
                                                       min_cols(_min_cols),
-                                                      LARGE_MATRIX(_LARGE_MATRIX),
+                                                      formulation(_formulation != Formulation::AUTO ? _formulation :
+                                                                  Formulation::select(Formulation::count_na(_data, _free_rows, _free_cols))),
                                                       TOL(_TOL),
+                                                      num_threads(1),
                                                       r_var(num_rows),
                                                       c_var(num_cols),
+                                                      count_idx(num_rows, -1),
                                                       obj_value(0),
+                                                      num_nodes(0),
                                                       env(IloEnv()),
                                                       cplex(IloCplex(env)),
                                                       model(IloModel(env)),
                                                       r(IloNumVarArray(env, num_rows, 0, 1, ILOINT)),
                                                       c(IloNumVarArray(env, num_cols, 0, 1, ILOINT)),
+                                                      n(IloNumVarArray(env)),
                                                       r_copy(IloNumArray(env, num_rows)),
                                                       c_copy(IloNumArray(env, num_cols)),
+                                                      n_copy(IloNumArray(env)),
                                                       obj(IloExpr(env)) {
+  assert(row_classes->size() == num_rows && col_classes->size() == num_cols);
+
+  for (std::size_t i = 0; i < num_rows; ++i) {
+    const std::size_t size = row_classes->at(i).size();
+    if (size > 1) {
+      count_idx[i] = n.getSize();
+      n.add(IloNumVar(env, 0, static_cast<IloNum>(size), ILOINT));
+    }
+  }
+  n_var.resize(n.getSize());
+  n_copy.add(n.getSize(), 0.0);
+
   r.setNames("r");
   c.setNames("c");
+  n.setNames("n");
   build_model();
 }
 
 ElementIpSolver::~ElementIpSolver() {}
 
+// Every free row (column) stands for a class of rows (columns) with identical
+// patterns. A column class is kept whole, since any solution keeping one of its
+// columns can keep them all, so c[j] is weighted by the class size. A row class
+// may be kept in part to meet the row_sum, so r[i] says whether the class is
+// used and the count variable n[i], bounded by the class size, how many of its
+// rows are kept. The missing-data constraints and the cuts only need r[i].
 void ElementIpSolver::build_model() {
   // Add the objective value
   for (std::size_t j = 0; j < num_cols; ++j) {
-    obj += c[j];
+    obj += static_cast<IloNum>(col_classes->at(j).size()) * c[j];
   }
   obj += static_cast<IloNum>(forced_one_cols->size());
   model.add(IloMaximize(env, obj, "Objective"));
@@ -50,40 +80,65 @@ void ElementIpSolver::build_model() {
   // Add the constraint for the row_sum
   IloExpr row_sum_expr(env);
   for (std::size_t i = 0; i < num_rows; ++i) {
-    row_sum_expr += r[i];
+    if (count_idx[i] < 0) {
+      row_sum_expr += r[i];
+    } else {
+      const IloNumVar &count = n[count_idx[i]];
+      row_sum_expr += count;
+      model.add(count <= static_cast<IloNum>(row_classes->at(i).size()) * r[i]);
+      model.add(count >= r[i]);
+    }
   }
   model.add(row_sum_expr == static_cast<IloNum>(row_sum - forced_one_rows->size()));
 
-  // Add constraints for missing data
-  if (is_large_matrix()) {
-    for (std::size_t local_i = 0; local_i < num_rows; ++local_i) {
-      const std::size_t i = free_rows->at(local_i);
+  // Add constraints for missing data, visiting only the missing elements of
+  // every free row (column) and mapping them back to the free lists
+  std::vector<long> local_row(data->get_num_data_rows(), -1);
+  std::vector<long> local_col(data->get_num_data_cols(), -1);
+  for (std::size_t local_i = 0; local_i < num_rows; ++local_i) {
+    local_row[free_rows->at(local_i)] = local_i;
+  }
+  for (std::size_t local_j = 0; local_j < num_cols; ++local_j) {
+    local_col[free_cols->at(local_j)] = local_j;
+  }
 
+  if (formulation == Formulation::ROW_AGGREGATED) {
+    for (std::size_t local_i = 0; local_i < num_rows; ++local_i) {
       std::size_t num_excluded = 0;
       IloExpr col_sum_expr(env);
-      for (std::size_t local_j = 0; local_j < num_cols; ++local_j) {
-        const std::size_t j = free_cols->at(local_j);        
-        if (data->is_data_na(i,j)) {
-          col_sum_expr += c[local_j];
+      data->for_each_na_in_row(free_rows->at(local_i), [&](const std::size_t j) {
+        if (local_col[j] >= 0) {
+          col_sum_expr += c[local_col[j]];
           ++num_excluded;
         }
-      }
+      });
       if (num_excluded > 0) {
         model.add(static_cast<IloNum>(num_excluded) * r[local_i] + col_sum_expr <= static_cast<IloNum>(num_excluded));
       }
       col_sum_expr.end();
     }
+  } else if (formulation == Formulation::COL_AGGREGATED) {
+    for (std::size_t local_j = 0; local_j < num_cols; ++local_j) {
+      std::size_t num_excluded = 0;
+      IloExpr row_sum_expr(env);
+      data->for_each_na_in_col(free_cols->at(local_j), [&](const std::size_t i) {
+        if (local_row[i] >= 0) {
+          row_sum_expr += r[local_row[i]];
+          ++num_excluded;
+        }
+      });
+      if (num_excluded > 0) {
+        model.add(static_cast<IloNum>(num_excluded) * c[local_j] + row_sum_expr <= static_cast<IloNum>(num_excluded));
+      }
+      row_sum_expr.end();
+    }
   } else {
     for (std::size_t local_i = 0; local_i < num_rows; ++local_i) {
-      const std::size_t i = free_rows->at(local_i);
-
-      for (std::size_t local_j = 0; local_j < num_cols; ++local_j) {
-        const std::size_t j = free_cols->at(local_j);
-
-        if (data->is_data_na(i,j)) {
-          model.add(r[local_i] + c[local_j] <= 1);
+      data->for_each_na_in_row(free_rows->at(local_i), [&](const std::size_t j) {
+        if (local_col[j] >= 0) {
+          model.add(r[local_i] + c[local_col[j]] <= 1);
         }
-      }
+      });
     }
   }
 }
@@ -105,8 +160,8 @@ void ElementIpSolver::round_extreme_values() {
   }
 }
 
-bool ElementIpSolver::is_large_matrix() const {
-  return num_rows * num_cols >= LARGE_MATRIX;
+bool ElementIpSolver::is_aggregated() const {
+  return formulation != Formulation::PER_ELEMENT;
 }
 
 void ElementIpSolver::set_row_to_zero(const std::size_t row_idx) {
@@ -133,7 +188,7 @@ void ElementIpSolver::add_row_pairs_cut(const std::size_t row_idx, const std::ve
   assert(row_idx < num_rows);
   assert(pairs.size() > 0);
 
-  if (is_large_matrix()) {
+  if (is_aggregated()) {
     if (!pairs.empty()) {
       IloExpr row_sum_epxr(env);
       for (auto p : pairs) {
@@ -153,7 +208,7 @@ void ElementIpSolver::add_col_pairs_cut(const std::size_t col_idx, const std::ve
   assert(col_idx < num_cols);
   assert(pairs.size() > 0);
 
-  if (is_large_matrix()) {
+  if (is_aggregated()) {
     if (!pairs.empty()) {
       IloExpr col_sum_epxr(env);
       for (auto p : pairs) {
@@ -169,20 +224,43 @@ void ElementIpSolver::add_col_pairs_cut(const std::size_t col_idx, const std::ve
   }
 }
 
-void ElementIpSolver::solve() {
-  cplex.extract(model);
-// cplex.exportModel("element.lp");
+// Keeps the row (column) only if the row (column) whose missing data it contains
+// is also kept.
+void ElementIpSolver::add_row_dominance_cut(const std::size_t row_idx, const std::size_t dominating_idx) {
+  assert(row_idx < num_rows && dominating_idx < num_rows);
+  model.add(r[row_idx] <= r[dominating_idx]);
+}
+
+void ElementIpSolver::add_col_dominance_cut(const std::size_t col_idx, const std::size_t dominating_idx) {
+  assert(col_idx < num_cols && dominating_idx < num_cols);
+  model.add(c[col_idx] <= c[dominating_idx]);
+}
+
+void ElementIpSolver::set_num_threads(const std::size_t _num_threads) {
+  assert(_num_threads > 0);
+  num_threads = _num_threads;
+}
+
+void ElementIpSolver::set_params() {
   if (min_cols > 0) {
     cplex.setParam(IloCplex::Param::MIP::Tolerances::LowerCutoff, min_cols);
   }
-
-  obj_value = 0;
   cplex.setParam(IloCplex::Param::RandomSeed, 0);
-  cplex.setParam(IloCplex::Param::Threads, 1);
+  cplex.setParam(IloCplex::Param::Threads, static_cast<IloInt>(num_threads));
   cplex.setOut(env.getNullStream());
+}
+
+void ElementIpSolver::solve() {
+  PhaseTimer solve_timer("cplex_solve");
+  cplex.extract(model);
+// cplex.exportModel("element.lp");
+  set_params();
+
+  obj_value = 0;
 
   try {
     cplex.solve();
+    num_nodes = cplex.getNnodes();
 
     if (cplex.getStatus() == IloAlgorithm::Infeasible) {
       // printf("Infeasible Solution\n");
@@ -198,6 +276,12 @@ void ElementIpSolver::solve() {
       for (std::size_t j = 0; j < c_var.size(); ++j) {
         c_var[j] = c_copy[j];
       }
+      if (n.getSize() > 0) {
+        cplex.getValues(n, n_copy);
+        for (std::size_t k = 0; k < n_var.size(); ++k) {
+          n_var[k] = std::round(n_copy[k]);
+        }
+      }
 
       round_extreme_values();
     }
@@ -210,6 +294,43 @@ void ElementIpSolver::solve() {
   }
 }
 
+// Solves the LP relaxation of the model and returns its objective value, or 0
+// if the relaxation is infeasible. Must be called before solve(), which ends the
+// environment.
+double ElementIpSolver::solve_relaxation() {
+  IloConversion r_relax(env, r, ILOFLOAT);
+  IloConversion c_relax(env, c, ILOFLOAT);
+  IloConversion n_relax(env, n, ILOFLOAT);
+  model.add(r_relax);
+  model.add(c_relax);
+  model.add(n_relax);
+
+  cplex.extract(model);
+  set_params();
+
+  double bound = 0.0;
+  try {
+    if (cplex.solve()) {
+      bound = cplex.getObjValue();
+    }
+  } catch (IloException& e) {
+    std::cerr << "Concert exception caught: " << e << std::endl;
+  }
+
+  model.remove(r_relax);
+  model.remove(c_relax);
+  model.remove(n_relax);
+  r_relax.end();
+  c_relax.end();
+  n_relax.end();
+
+  return bound;
+}
+
+Formulation::Type ElementIpSolver::get_formulation() const {
+  return formulation;
+}
+
 std::size_t ElementIpSolver::get_obj_value() const {
   return obj_value;
 }
@@ -218,15 +339,24 @@ std::size_t ElementIpSolver::get_num_elements() const {
   return obj_value * row_sum;
 }
 
+// Number of branch-and-bound nodes explored by the last solve()
+std::size_t ElementIpSolver::get_num_nodes() const {
+  return num_nodes;
+}
+
 std::vector<int> ElementIpSolver::get_rows_to_keep() const {
-  std::vector<int> rows_to_keep(num_rows + forced_one_rows->size(), 0);
+  std::vector<int> rows_to_keep(data->get_num_data_rows(), 0);
 
   for (std::size_t i = 0; i < forced_one_rows->size(); ++i) {
     rows_to_keep[forced_one_rows->at(i)] = 1;
   }
   for (std::size_t i = 0; i < num_rows; ++i) {
-    if (r_var[i] == 1.0) {
-      rows_to_keep[free_rows->at(i)] = 1;
+    if (r_var[i] != 1.0) continue;
+
+    const std::vector<std::size_t> &members = row_classes->at(i);
+    const std::size_t count = count_idx[i] < 0 ? 1 : static_cast<std::size_t>(n_var[count_idx[i]]);
+    for (std::size_t k = 0; k < count && k < members.size(); ++k) {
+      rows_to_keep[members[k]] = 1;
     }
   }
 
@@ -234,14 +364,16 @@ std::vector<int> ElementIpSolver::get_rows_to_keep() const {
 }
 
 std::vector<int> ElementIpSolver::get_cols_to_keep() const {
-  std::vector<int> cols_to_keep(num_cols + forced_one_cols->size(), 0);
+  std::vector<int> cols_to_keep(data->get_num_data_cols(), 0);
 
   for (std::size_t j = 0; j < forced_one_cols->size(); ++j) {
     cols_to_keep[forced_one_cols->at(j)] = 1;
   }
   for (std::size_t j = 0; j < num_cols; ++j) {
     if (c_var[j] == 1.0) {
-      cols_to_keep[free_cols->at(j)] = 1;
+      for (auto col : col_classes->at(j)) {
+        cols_to_keep[col] = 1;
+      }
     }
   }
 
@@ -6,6 +6,7 @@
 #include <ilconcert/ilomodel.h>
 
 #include "BinContainer.h"
+#include "Formulation.h"
 
 class ElementIpSolver
 {
@@ -15,29 +16,41 @@ private:
   const std::vector<size_t> *forced_one_cols;
   const std::vector<std::size_t> *free_rows;
   const std::vector<std::size_t> *free_cols;
+  const std::vector<std::vector<std::size_t>> *row_classes;
+  const std::vector<std::vector<std::size_t>> *col_classes;
   const std::size_t num_rows;
   const std::size_t num_cols;
   const std::size_t row_sum;
   const std::size_t min_cols;
-  const std::size_t LARGE_MATRIX;
+  const Formulation::Type formulation;
   const double TOL;
+  std::size_t num_threads;
 
   std::vector<double> r_var;
   std::vector<double> c_var;
+  std::vector<double> n_var;
+
+  // Position in 'n' of the count variable of every row class with more than
+  // one row, or -1 if the class has a single row
+  std::vector<long> count_idx;
   std::size_t obj_value;
+  std::size_t num_nodes;
 
   IloEnv env;
   IloCplex cplex;
   IloModel model;
   IloNumVarArray r;
   IloNumVarArray c;
+  IloNumVarArray n;
   IloNumArray r_copy;
   IloNumArray c_copy;
+  IloNumArray n_copy;
   IloExpr obj;
 
   void build_model();
   void round_extreme_values();
-  bool is_large_matrix() const;
+  bool is_aggregated() const;
+  void set_params();
 
 public:
   ElementIpSolver(const BinContainer &_data,
@@ -47,7 +60,9 @@ public:
                   const std::vector<size_t> &_forced_one_cols,
                   const std::vector<std::size_t> &_free_rows,
                   const std::vector<std::size_t> &_free_cols,
-                  const std::size_t _LARGE_MATRIX,
+                  const std::vector<std::vector<std::size_t>> &_row_classes,
+                  const std::vector<std::vector<std::size_t>> &_col_classes,
+                  const Formulation::Type _formulation,
                   const double _TOL = 0.00001);
   ~ElementIpSolver();
 
@@ -57,10 +72,16 @@ public:
   void set_col_to_one(const std::size_t col_idx);
   void add_row_pairs_cut(const std::size_t row_idx, const std::vector<std::size_t> &pairs);
   void add_col_pairs_cut(const std::size_t col_idx, const std::vector<std::size_t> &pairs);
+  void add_row_dominance_cut(const std::size_t row_idx, const std::size_t dominating_idx);
+  void add_col_dominance_cut(const std::size_t col_idx, const std::size_t dominating_idx);
+  void set_num_threads(const std::size_t _num_threads);
   void solve();
+  double solve_relaxation();
 
+  Formulation::Type get_formulation() const;
   std::size_t get_obj_value() const;
   std::size_t get_num_elements() const;
+  std::size_t get_num_nodes() const;
   std::vector<int> get_rows_to_keep() const;
   std::vector<int> get_cols_to_keep() const;
 };
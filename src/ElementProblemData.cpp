@@ -0,0 +1,275 @@
+#include "ElementProblemData.h"
+#include "PhaseTimer.h"
+#include <cstdlib>
+#include <sstream>
+#include <unordered_map>
+
+//------------------------------------------------------------------------------
+// Constructor. Reads the forced/free rows and columns, their duplicates, the
+// row/col pairs and the dominance pairs written to the scratch directory by calcPairs. The
+// presolve can leave fewer than two free rows or columns, in which case there
+// are no pairs to read. The screener drops a row (column) with fewer valid
+// elements than the threshold before looking at its pairs, so the number of
+// valid elements in every free row (column) bounds the thresholds its pairs
+// are compared against. An index file found in '_index_files', as broadcast by
+// Parallel::broadcast_files, is taken from there rather than read again.
+//------------------------------------------------------------------------------
+ElementProblemData::ElementProblemData(const BinContainer &data,
+                                       const std::string &_scratch_dir,
+                                       const std::map<std::string, std::string> &_index_files) : scratch_file(_scratch_dir),
+                                                                                                 index_files(_index_files) {
+  read_index_file(scratch_file + "forcedOneRows.txt", forced_one_rows);
+  read_index_file(scratch_file + "forcedOneCols.txt", forced_one_cols);
+  read_index_file(scratch_file + "freeRows.txt", free_rows);
+  read_index_file(scratch_file + "freeCols.txt", free_cols);
+  read_class_file(scratch_file + "rowDuplicates.txt", free_rows, row_classes, row_weights);
+  read_class_file(scratch_file + "colDuplicates.txt", free_cols, col_classes, col_weights);
+
+  PhaseTimer read_timer("pair_read");
+  if (free_rows.size() > 1) {
+    row_pairs.set_size(free_rows.size()-1);
+    row_pairs.read(scratch_file + "rowPairs.csv", get_max_thresholds(data, true, free_rows));
+  }
+
+  if (free_cols.size() > 1) {
+    col_pairs.set_size(free_cols.size()-1);
+    col_pairs.read(scratch_file + "colPairs.csv", get_max_thresholds(data, false, free_cols));
+  }
+  read_timer.stop();
+
+  read_dominance_file(scratch_file + "rowDominance.txt", free_rows, row_dominance);
+  read_dominance_file(scratch_file + "colDominance.txt", free_cols, col_dominance);
+}
+
+//------------------------------------------------------------------------------
+// Constructor for a problem built in memory from the presolve result, with
+// the pair tables already counted. The tables are taken from '_row_pairs' and
+// '_col_pairs', which are left empty. There is no scratch directory.
+//------------------------------------------------------------------------------
+ElementProblemData::ElementProblemData(const std::vector<std::size_t> &_forced_one_rows,
+                                       const std::vector<std::size_t> &_forced_one_cols,
+                                       const std::vector<std::size_t> &_free_rows,
+                                       const std::vector<std::size_t> &_free_cols,
+                                       const std::vector<std::vector<std::size_t>> &_row_classes,
+                                       const std::vector<std::vector<std::size_t>> &_col_classes,
+                                       const std::vector<std::pair<std::size_t, std::size_t>> &_row_dominance,
+                                       const std::vector<std::pair<std::size_t, std::size_t>> &_col_dominance,
+                                       Pairs &_row_pairs,
+                                       Pairs &_col_pairs) : scratch_file(""),
+                                                            forced_one_rows(_forced_one_rows),
+                                                            forced_one_cols(_forced_one_cols),
+                                                            free_rows(_free_rows),
+                                                            free_cols(_free_cols),
+                                                            row_classes(_row_classes),
+                                                            col_classes(_col_classes) {
+  for (auto &members : row_classes) {
+    row_weights.push_back(members.size());
+  }
+  for (auto &members : col_classes) {
+    col_weights.push_back(members.size());
+  }
+
+  row_pairs.swap(_row_pairs);
+  col_pairs.swap(_col_pairs);
+
+  set_dominance("Presolve", _row_dominance, free_rows, row_dominance);
+  set_dominance("Presolve", _col_dominance, free_cols, col_dominance);
+}
+
+//------------------------------------------------------------------------------
+// Destructor.
+//------------------------------------------------------------------------------
+ElementProblemData::~ElementProblemData() {}
+
+//------------------------------------------------------------------------------
+// Returns the index files calcPairs writes to 'scratch_dir', which every
+// elementIp worker reads.
+//------------------------------------------------------------------------------
+std::vector<std::string> ElementProblemData::get_index_files(const std::string &scratch_dir) {
+  return {scratch_dir + "forcedOneRows.txt", scratch_dir + "forcedOneCols.txt",
+          scratch_dir + "freeRows.txt", scratch_dir + "freeCols.txt",
+          scratch_dir + "rowDuplicates.txt", scratch_dir + "colDuplicates.txt",
+          scratch_dir + "rowDominance.txt", scratch_dir + "colDominance.txt"};
+}
+
+//------------------------------------------------------------------------------
+// Returns the largest threshold a query about each index of 'free' can use:
+// the number of valid entries of the row (column).
+//------------------------------------------------------------------------------
+std::vector<unsigned int> ElementProblemData::get_max_thresholds(const BinContainer &data,
+                                                                 const bool is_row,
+                                                                 const std::vector<std::size_t> &free) {
+  std::vector<unsigned int> max_thresholds(free.size());
+  for (std::size_t k = 0; k < free.size(); ++k) {
+    max_thresholds[k] = (is_row ? data.get_num_valid_in_row(free[k]) : data.get_num_valid_in_col(free[k]));
+  }
+  return max_thresholds;
+}
+
+FILE* ElementProblemData::open_file_for_read(const std::string &file_name) const {
+  FILE* input;
+  if ((input = fopen(file_name.c_str(), "r")) == nullptr) {
+    fprintf(stderr, "ERROR - Could not open file %s\n", file_name.c_str());
+    exit(1);
+  }
+  return input;
+}
+
+//------------------------------------------------------------------------------
+// Returns the contents of 'file_name', from the broadcast index files if it is
+// one of them.
+//------------------------------------------------------------------------------
+std::string ElementProblemData::read_contents(const std::string &file_name) const {
+  auto it = index_files.find(file_name);
+  if (it != index_files.end()) {
+    return it->second;
+  }
+
+  FILE* input = open_file_for_read(file_name);
+  std::string contents;
+  char block[4096];
+  std::size_t num_read;
+  while ((num_read = fread(block, 1, sizeof(block), input)) > 0) {
+    contents.append(block, num_read);
+  }
+  fclose(input);
+  return contents;
+}
+
+//------------------------------------------------------------------------------
+// Reads a whitespace separated list of indices into 'indices'.
+//------------------------------------------------------------------------------
+void ElementProblemData::read_index_file(const std::string &file_name, std::vector<std::size_t> &indices) const {
+  std::istringstream input(read_contents(file_name));
+  std::string tmp_str;
+
+  while (input >> tmp_str) {
+    indices.push_back(std::stoul(tmp_str));
+  }
+}
+
+//------------------------------------------------------------------------------
+// Reads the pairs of duplicate and class head in 'file_name' and builds the
+// class of every index in 'free', head first, and its size.
+//------------------------------------------------------------------------------
+void ElementProblemData::read_class_file(const std::string &file_name,
+                                         const std::vector<std::size_t> &free,
+                                         std::vector<std::vector<std::size_t>> &classes,
+                                         std::vector<std::size_t> &weights) const {
+  std::vector<std::size_t> indices;
+  read_index_file(file_name, indices);
+
+  std::unordered_map<std::size_t, std::size_t> position;
+  classes.clear();
+  for (std::size_t k = 0; k < free.size(); ++k) {
+    position[free[k]] = k;
+    classes.push_back(std::vector<std::size_t>(1, free[k]));
+  }
+
+  for (std::size_t k = 0; k + 1 < indices.size(); k += 2) {
+    auto head = position.find(indices[k+1]);
+    if (head == position.end()) {
+      fprintf(stderr, "ERROR - %s has a class head that is not free\n", file_name.c_str());
+      exit(1);
+    }
+    classes[head->second].push_back(indices[k]);
+  }
+
+  weights.clear();
+  for (auto &members : classes) {
+    weights.push_back(members.size());
+  }
+}
+
+//------------------------------------------------------------------------------
+// Reads the pairs of row (column) indices in 'file_name' and stores them as
+// positions in 'free'.
+//------------------------------------------------------------------------------
+void ElementProblemData::read_dominance_file(const std::string &file_name,
+                                             const std::vector<std::size_t> &free,
+                                             std::vector<std::pair<std::size_t, std::size_t>> &dominance) const {
+  std::vector<std::size_t> indices;
+  read_index_file(file_name, indices);
+
+  std::vector<std::pair<std::size_t, std::size_t>> pairs;
+  for (std::size_t k = 0; k + 1 < indices.size(); k += 2) {
+    pairs.push_back(std::make_pair(indices[k], indices[k+1]));
+  }
+  set_dominance(file_name, pairs, free, dominance);
+}
+
+//------------------------------------------------------------------------------
+// Stores the pairs of row (column) indices in 'pairs', which come from
+// 'source', as positions in 'free'.
+//------------------------------------------------------------------------------
+void ElementProblemData::set_dominance(const std::string &source,
+                                       const std::vector<std::pair<std::size_t, std::size_t>> &pairs,
+                                       const std::vector<std::size_t> &free,
+                                       std::vector<std::pair<std::size_t, std::size_t>> &dominance) const {
+  std::unordered_map<std::size_t, std::size_t> position;
+  for (std::size_t k = 0; k < free.size(); ++k) {
+    position[free[k]] = k;
+  }
+
+  for (auto &pair : pairs) {
+    auto dominated = position.find(pair.first);
+    auto dominating = position.find(pair.second);
+    if (dominated == position.end() || dominating == position.end()) {
+      fprintf(stderr, "ERROR - %s pairs an index that is not free\n", source.c_str());
+      exit(1);
+    }
+    dominance.push_back(std::make_pair(dominated->second, dominating->second));
+  }
+}
+
+const std::vector<std::size_t>& ElementProblemData::get_forced_one_rows() const {
+  return forced_one_rows;
+}
+
+const std::vector<std::size_t>& ElementProblemData::get_forced_one_cols() const {
+  return forced_one_cols;
+}
+
+const std::vector<std::size_t>& ElementProblemData::get_free_rows() const {
+  return free_rows;
+}
+
+const std::vector<std::size_t>& ElementProblemData::get_free_cols() const {
+  return free_cols;
+}
+
+const std::vector<std::vector<std::size_t>>& ElementProblemData::get_row_classes() const {
+  return row_classes;
+}
+
+const std::vector<std::vector<std::size_t>>& ElementProblemData::get_col_classes() const {
+  return col_classes;
+}
+
+const std::vector<std::size_t>& ElementProblemData::get_row_weights() const {
+  return row_weights;
+}
+
+const std::vector<std::size_t>& ElementProblemData::get_col_weights() const {
+  return col_weights;
+}
+
+const Pairs& ElementProblemData::get_row_pairs() const {
+  return row_pairs;
+}
+
+const Pairs& ElementProblemData::get_col_pairs() const {
+  return col_pairs;
+}
+
+const std::vector<std::pair<std::size_t, std::size_t>>& ElementProblemData::get_row_dominance() const {
+  return row_dominance;
+}
+
+const std::vector<std::pair<std::size_t, std::size_t>>& ElementProblemData::get_col_dominance() const {
+  return col_dominance;
+}
+
+const std::string& ElementProblemData::get_scratch_dir() const {
+  return scratch_file;
+}
@@ -0,0 +1,91 @@
+#ifndef ELEMENT_PROBLEM_DATA_H
+#define ELEMENT_PROBLEM_DATA_H
+
+#include <cstdio>
+#include <map>
+#include <vector>
+#include <string>
+#include <utility>
+#include "BinContainer.h"
+#include "Pairs.h"
+
+class ElementProblemData
+{
+private:
+  const std::string scratch_file;
+
+  // Contents of the index files already read by another rank, by file name
+  std::map<std::string, std::string> index_files;
+
+  std::vector<std::size_t> forced_one_rows;
+  std::vector<std::size_t> forced_one_cols;
+
+  std::vector<std::size_t> free_rows;
+  std::vector<std::size_t> free_cols;
+
+  // Rows (columns) with the same pattern as each free row (column), which come
+  // first, and the size of every class
+  std::vector<std::vector<std::size_t>> row_classes;
+  std::vector<std::vector<std::size_t>> col_classes;
+  std::vector<std::size_t> row_weights;
+  std::vector<std::size_t> col_weights;
+
+  Pairs row_pairs;
+  Pairs col_pairs;
+
+  // Dominance pairs from the presolve, as positions in the free rows and columns
+  std::vector<std::pair<std::size_t, std::size_t>> row_dominance;
+  std::vector<std::pair<std::size_t, std::size_t>> col_dominance;
+
+  FILE* open_file_for_read(const std::string &file_name) const;
+  std::string read_contents(const std::string &file_name) const;
+  void read_index_file(const std::string &file_name, std::vector<std::size_t> &indices) const;
+  void read_class_file(const std::string &file_name,
+                       const std::vector<std::size_t> &free,
+                       std::vector<std::vector<std::size_t>> &classes,
+                       std::vector<std::size_t> &weights) const;
+  void read_dominance_file(const std::string &file_name,
+                           const std::vector<std::size_t> &free,
+                           std::vector<std::pair<std::size_t, std::size_t>> &dominance) const;
+  void set_dominance(const std::string &source,
+                     const std::vector<std::pair<std::size_t, std::size_t>> &pairs,
+                     const std::vector<std::size_t> &free,
+                     std::vector<std::pair<std::size_t, std::size_t>> &dominance) const;
+
+public:
+  ElementProblemData(const BinContainer &data,
+                     const std::string &_scratch_dir,
+                     const std::map<std::string, std::string> &_index_files = {});
+  ElementProblemData(const std::vector<std::size_t> &_forced_one_rows,
+                     const std::vector<std::size_t> &_forced_one_cols,
+                     const std::vector<std::size_t> &_free_rows,
+                     const std::vector<std::size_t> &_free_cols,
+                     const std::vector<std::vector<std::size_t>> &_row_classes,
+                     const std::vector<std::vector<std::size_t>> &_col_classes,
+                     const std::vector<std::pair<std::size_t, std::size_t>> &_row_dominance,
+                     const std::vector<std::pair<std::size_t, std::size_t>> &_col_dominance,
+                     Pairs &_row_pairs,
+                     Pairs &_col_pairs);
+  ~ElementProblemData();
+
+  const std::vector<std::size_t>& get_forced_one_rows() const;
+  const std::vector<std::size_t>& get_forced_one_cols() const;
+  const std::vector<std::size_t>& get_free_rows() const;
+  const std::vector<std::size_t>& get_free_cols() const;
+  const std::vector<std::vector<std::size_t>>& get_row_classes() const;
+  const std::vector<std::vector<std::size_t>>& get_col_classes() const;
+  const std::vector<std::size_t>& get_row_weights() const;
+  const std::vector<std::size_t>& get_col_weights() const;
+  const Pairs& get_row_pairs() const;
+  const Pairs& get_col_pairs() const;
+  const std::vector<std::pair<std::size_t, std::size_t>>& get_row_dominance() const;
+  const std::vector<std::pair<std::size_t, std::size_t>>& get_col_dominance() const;
+  const std::string& get_scratch_dir() const;
+
+  static std::vector<std::string> get_index_files(const std::string &scratch_dir);
+  static std::vector<unsigned int> get_max_thresholds(const BinContainer &data,
+                                                      const bool is_row,
+                                                      const std::vector<std::size_t> &free);
+};
+
+#endif
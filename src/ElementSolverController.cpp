@@ -1,49 +1,52 @@
 #include "ElementSolverController.h"
 #include <assert.h>
 #include <algorithm>
+#include <cstdio>
 #include "Parallel.h"
 #include "Utils.h"
 #include "NoMissSummary.h"
+#include "PhaseTimer.h"
 #include "CleanSolution.h"
+#include "RowSumScreener.h"
 
 //------------------------------------------------------------------------------
-// Constructor.
+// Constructor. If a checkpoint of an interrupted sweep of the same matrix is
+// found in the scratch directory, the sweep resumes from it.
 //------------------------------------------------------------------------------
 ElementSolverController::ElementSolverController(const BinContainer &_data,
                                                  const std::string &_scratch_dir,
-                                                 const std::string &incumbent_file) : data(&_data),
+                                                 const std::string &incumbent_file,
+                                                 const std::vector<int> &_node_ids,
+                                                 const std::size_t _MAX_CPLEX_THREADS,
+                                                 const double HEURISTIC_TIME_LIMIT,
+                                                 const double _CHECKPOINT_INTERVAL) : data(&_data),
                                                                                       num_rows(data->get_num_data_rows()),
                                                                                       num_cols(data->get_num_data_cols()),
                                                                                       scratch_dir(_scratch_dir),
                                                                                       world_size(Parallel::get_world_size()),
-                                                                                      best_num_elements(0) {
-  for (std::size_t i = world_size - 1; i > 0; --i) {
-    available_workers.push(i);
-  }
-
-  read_forced_one_rows();
-  read_forced_one_cols();
-  read_free_rows();
-  read_free_cols();
-
-  std::string file_name = scratch_dir + "rowPairs.csv";
-  row_pairs.set_size(free_rows.size()-1);
-  row_pairs.read(file_name);
-  
-  col_pairs.set_size(free_cols.size()-1);
-  file_name = scratch_dir + "colPairs.csv";
-  col_pairs.read(file_name);
-
-  CleanSolution sol(num_rows, num_cols);
-  if (!incumbent_file.empty()) {
-    sol.read_from_file(incumbent_file);
+                                                                                      MAX_CPLEX_THREADS(_MAX_CPLEX_THREADS > 0 ? _MAX_CPLEX_THREADS : 1),
+                                                                                      node_ids(_node_ids),
+                                                                                      lent_workers(world_size),
+                                                                                      task_log(1, world_size - 1),
+                                                                                      worker_task(world_size),
+                                                                                      worker_start(world_size, 0.0),
+                                                                                      worker_threads(world_size, 1),
+                                                                                      incumbent(_data,
+                                                                                                ElementIncumbent::read(_data, incumbent_file, _scratch_dir),
+                                                                                                HEURISTIC_TIME_LIMIT,
+                                                                                                "Element.sol"),
+                                                                                      CHECKPOINT_INTERVAL(_CHECKPOINT_INTERVAL),
+                                                                                      checkpoint_file(scratch_dir + "Element.ckpt") {
+  assert(node_ids.size() == world_size);
+  for (std::size_t i = 1; i < world_size; ++i) {
+    available_workers.insert(i);
+    Parallel::enqueue(i);
   }
 
-  best_rows_to_keep = sol.get_rows_to_keep();
-  best_cols_to_keep = sol.get_cols_to_keep();
-  best_num_elements = sol.get_num_rows_kept() * sol.get_num_cols_kept();
-
-  noMissSummary::write_solution_to_file("Element.sol", best_rows_to_keep, best_cols_to_keep);
+  scheduler.reset(new RowSumScheduler(RowSumScreener::calc_max_cols_possible(*data),
+                                      incumbent.get_num_elements(),
+                                      incumbent.get_num_rows_to_keep()));
+  resume_from_checkpoint();
 }
 
 //------------------------------------------------------------------------------
@@ -52,131 +55,165 @@ ElementSolverController::ElementSolverController(const BinContainer &_data,
 ElementSolverController::~ElementSolverController() {}
 
 
+//------------------------------------------------------------------------------
+// Dispatches the open row_sum with the highest bound to an available worker
+// until no remaining bound can beat the incumbent. Unscreened row_sums are sent
+// as screening tasks, which return a tighter bound, and screened row_sums are
+// sent as solve tasks.
+//------------------------------------------------------------------------------
 void ElementSolverController::work() {
-// Order rows by missing number of elements
-  std::vector<std::size_t> num_missing(num_rows);
-  for (std::size_t i = 0; i < num_rows; ++i) {
-    num_missing[i] = data->get_num_invalid_in_row(i);
+  RowSumScheduler::Task task;
+  task_log.start();
+  checkpoint_timer.restart();
+
+  while (true) {
+    adopt_shared_incumbent();
+    if (!available_workers.empty() && scheduler->next_task(task)) {
+      send_problem(task);
+    } else if (workers_still_working()) {
+      receive_completion();
+    } else {
+      break;
+    }
+
+    if (CHECKPOINT_INTERVAL > 0 && checkpoint_timer.elapsed_wall_time() >= CHECKPOINT_INTERVAL) {
+      write_checkpoint();
+      checkpoint_timer.restart();
+    }
   }
-  std::sort(num_missing.begin(), num_missing.end());
 
-  // Calculate maximum number of kept columns associated with keeping i rows
-  // by subtracting the number of invalid elements of the i-th ordered row from
-  // the number of columns
-  std::vector<std::size_t> max_cols_possible(num_rows);
-  for (std::size_t i = 0; i < num_rows; ++i) {
-    max_cols_possible[i] = num_cols - num_missing[i];
+  // The sweep is complete, so a later run must start over
+  remove(checkpoint_file.c_str());
+}
+
+//------------------------------------------------------------------------------
+// Exchanges the incumbent with the store of a portfolio run; see
+// ElementIncumbent::set_store().
+//------------------------------------------------------------------------------
+void ElementSolverController::set_incumbent_store(IncumbentStore &_store) {
+  incumbent.set_store(_store);
+}
+
+//------------------------------------------------------------------------------
+// Adopts the best solution of the store if it beats the incumbent. min_cols is
+// only used when a task is dispatched, so checking before every dispatch
+// raises it as soon as it can matter.
+//------------------------------------------------------------------------------
+void ElementSolverController::adopt_shared_incumbent() {
+  if (incumbent.adopt_shared()) {
+    scheduler->update_incumbent(incumbent.get_num_elements());
   }
+}
 
-  std::size_t best_num_rows = get_num_rows_to_keep();
+//------------------------------------------------------------------------------
+// Writes the incumbent and the state of every row_sum to the checkpoint file:
+// a line with the number of rows and columns and the content hash of the
+// matrix, a line with the incumbent's number of elements, rows and columns, the
+// indices of its rows and columns, one per line, then the state written by
+// RowSumScheduler::write(). The file is written under a temporary name and
+// renamed, so an interrupted write leaves the previous checkpoint intact.
+//------------------------------------------------------------------------------
+void ElementSolverController::write_checkpoint() const {
+  PhaseTimer phase_timer("checkpoint");
+  const std::string tmp_file = checkpoint_file + ".tmp";
+  FILE *output;
+  if ((output = fopen(tmp_file.c_str(), "w")) == nullptr) {
+    fprintf(stderr, "ERROR - Could not open file (%s)\n", tmp_file.c_str());
+    exit(1);
+  }
 
-  std::vector<std::pair<std::size_t, std::size_t>> sorted_row_sums;
+  fprintf(output, "%lu,%lu,%lu\n", num_rows, num_cols, data->get_content_hash());
+  const std::vector<int> &rows_to_keep = incumbent.get_rows_to_keep(), &cols_to_keep = incumbent.get_cols_to_keep();
+  fprintf(output, "%lu,%lu,%lu\n", incumbent.get_num_elements(), get_num_rows_to_keep(), get_num_cols_to_keep());
   for (std::size_t i = 0; i < num_rows; ++i) {
-    if (i+1 > best_num_rows) {
-      sorted_row_sums.push_back(std::make_pair(i+1, i + 1 - best_num_rows));
-    } else {
-      sorted_row_sums.push_back(std::make_pair(i+1, best_num_rows - (i+1)));
+    if (rows_to_keep[i]) {
+      fprintf(output, "%lu\n", i);
+    }
+  }
+  for (std::size_t j = 0; j < num_cols; ++j) {
+    if (cols_to_keep[j]) {
+      fprintf(output, "%lu\n", j);
     }
   }
-  std::sort(sorted_row_sums.begin(), sorted_row_sums.end(), utils::SortPairBySecondItemIncreasing());
+  scheduler->write(output);
+  fclose(output);
 
-  // Check every row_sum value
-  for (auto rsp : sorted_row_sums) {
-    std::size_t row_sum = rsp.first;
+  if (rename(tmp_file.c_str(), checkpoint_file.c_str()) != 0) {
+    fprintf(stderr, "ERROR - Could not rename %s to %s\n", tmp_file.c_str(), checkpoint_file.c_str());
+    exit(1);
+  }
+}
 
-    // Calculate minimum number of columns in solution to improve score
-    std::size_t min_cols = (best_num_elements / row_sum) + 1;
+//------------------------------------------------------------------------------
+// Restores the incumbent, if it is better than the current one, and the state
+// of every row_sum from the checkpoint file. A checkpoint of a matrix with a
+// different size or content is ignored, and so is one whose incumbent keeps a
+// missing element of this matrix, since its row_sums were closed against other
+// data.
+//------------------------------------------------------------------------------
+void ElementSolverController::resume_from_checkpoint() {
+  FILE *input;
+  if ((input = fopen(checkpoint_file.c_str(), "r")) == nullptr) {
+    return;
+  }
 
-    fprintf(stderr, "Checking row_sum=%lu - min_cols=%lu\n", row_sum, min_cols);
+  std::size_t ckpt_rows, ckpt_cols;
+  std::uint64_t ckpt_hash;
+  if (fscanf(input, "%lu,%lu,%lu", &ckpt_rows, &ckpt_cols, &ckpt_hash) != 3) {
+    fprintf(stderr, "ERROR - Could not read the matrix size in %s\n", checkpoint_file.c_str());
+    exit(1);
+  }
+  if (ckpt_rows != num_rows || ckpt_cols != num_cols || ckpt_hash != data->get_content_hash()) {
+    fprintf(stderr, "Ignoring %s, which was written for another matrix\n", checkpoint_file.c_str());
+    fclose(input);
+    return;
+  }
 
-    // Check if 'min_cols' is greater than 'max_cols_possilbe'
-    if (min_cols > max_cols_possible[row_sum-1]) {
-      continue;
-    }
+  std::size_t ckpt_elements, ckpt_num_rows_kept, ckpt_num_cols_kept;
+  if (fscanf(input, "%lu,%lu,%lu", &ckpt_elements, &ckpt_num_rows_kept, &ckpt_num_cols_kept) != 3) {
+    fprintf(stderr, "ERROR - Could not read the incumbent in %s\n", checkpoint_file.c_str());
+    exit(1);
+  }
 
-    valid_col.clear();
-    valid_col.resize(free_cols.size(), 1);
-
-    const std::size_t min_free_cols = min_cols - forced_one_cols.size();
-    std::size_t free_col_sum_bound = free_cols.size();
-    bool set_new_col_to_zero = true;
-
-    while(set_new_col_to_zero) {
-      set_new_col_to_zero = false;
-
-      // Loop through all free columns
-      for (std::size_t j = 0; j < free_cols.size(); ++j) {
-        if (!valid_col[j]) continue; // If current column is alread on valid, continue to next column
-
-        // Check if the column contains enough valid elements compare to the rowSum
-        if (data->get_num_valid_in_col(free_cols[j]) < row_sum) {
-          valid_col[j] = 0;
-          --free_col_sum_bound;
-          continue;
-        }
-
-        // Get the number of pairs, from valid columns, that are >= the threshold
-        std::size_t count = col_pairs.getNumPairsGteThresh(j, row_sum, valid_col);
-
-        // Check if the number of valid columns is below the cutoff
-        // We subtract 1 to account for the current column contributing to the cutoff
-        if (count < min_free_cols - 1) {
-          set_new_col_to_zero = true;
-          valid_col[j] = 0;
-          --free_col_sum_bound;
-        }
-      }
-      
-      // If the number of remaining free columns is below the cuttoff, break from the loop
-      if (free_col_sum_bound < min_free_cols - 1) {
-        break;
-      }
+  std::vector<int> ckpt_rows_to_keep(num_rows, 0), ckpt_cols_to_keep(num_cols, 0);
+  std::size_t idx;
+  for (std::size_t k = 0; k < ckpt_num_rows_kept + ckpt_num_cols_kept; ++k) {
+    const std::size_t size = k < ckpt_num_rows_kept ? num_rows : num_cols;
+    if (fscanf(input, "%lu", &idx) != 1 || idx >= size) {
+      fprintf(stderr, "ERROR - Could not read the incumbent in %s\n", checkpoint_file.c_str());
+      exit(1);
     }
-
-    valid_row.clear();
-    valid_row.resize(free_rows.size(), 1);
-
-    const std::size_t min_free_rows = row_sum - forced_one_rows.size();
-    bool set_new_row_to_zero = true;
-    std::size_t free_row_sum_bound = free_rows.size();
-    while(set_new_row_to_zero) {
-      set_new_row_to_zero = false;
-      
-      for (std::size_t i = 0; i < free_rows.size(); ++i) {
-        if (!valid_row[i]) continue;
-
-        // Check if the row contains enough valid elements compare to the minCols
-        if (data->get_num_valid_in_row(free_rows[i]) < min_cols) {
-          valid_row[i] = 0;
-          --free_row_sum_bound;
-          continue;
-        }
-
-        std::size_t count = row_pairs.getNumPairsGteThresh(i, min_cols, valid_row);
-        if (count < min_free_rows - 1) {
-          set_new_row_to_zero = true;
-          valid_row[i] = 0;
-          --free_row_sum_bound;
-        }
-      }
-
-      if (free_row_sum_bound < min_free_rows - 1) {
-        break;
-      }
+    if (k < ckpt_num_rows_kept) {
+      ckpt_rows_to_keep[idx] = 1;
+    } else {
+      ckpt_cols_to_keep[idx] = 1;
     }
+  }
 
-    if (free_row_sum_bound < min_free_rows) {
-      continue;
-    }
+  // The number of elements in the file is not trusted
+  ckpt_elements = std::count(ckpt_rows_to_keep.begin(), ckpt_rows_to_keep.end(), 1) *
+                  std::count(ckpt_cols_to_keep.begin(), ckpt_cols_to_keep.end(), 1);
+  if (data->get_num_valid_data_kept(ckpt_rows_to_keep, ckpt_cols_to_keep) != ckpt_elements) {
+    fprintf(stderr, "Ignoring %s, whose incumbent keeps missing data\n", checkpoint_file.c_str());
+    fclose(input);
+    return;
+  }
 
-    send_problem(row_sum, min_cols);
+  if (incumbent.update(ckpt_rows_to_keep, ckpt_cols_to_keep, ckpt_elements)) {
+    scheduler->update_incumbent(ckpt_elements);
   }
+
+  scheduler->read(input, checkpoint_file);
+  fclose(input);
+
+  fprintf(stderr, "Resuming from %s: %lu row_sum values open, incumbent %lu\n",
+          checkpoint_file.c_str(), scheduler->get_num_open(), incumbent.get_num_elements());
 }
 
 void ElementSolverController::signal_workers_to_end() {
   char signal = 0;
   for (std::size_t i = 1; i < world_size; ++i) {
-    MPI_Send(&signal, 1, MPI_CHAR, i, Parallel::CONVERGE_TAG, MPI_COMM_WORLD);
+    Parallel::send(&signal, 1, MPI_CHAR, i, Parallel::CONVERGE_TAG);
   }
 }
 
@@ -189,162 +226,138 @@ bool ElementSolverController::workers_still_working() {
 }
 
 std::vector<int> ElementSolverController::get_rows_to_keep() const {
-  return best_rows_to_keep;
+  return incumbent.get_rows_to_keep();
 }
 
 std::vector<int> ElementSolverController::get_cols_to_keep() const {
-  return best_cols_to_keep;
+  return incumbent.get_cols_to_keep();
 }
 
 std::size_t ElementSolverController::get_num_rows_to_keep() const {
-  std::size_t count = 0;
-  for (auto r : best_rows_to_keep) {
-    count += r;
-  }
-  return count;
+  return incumbent.get_num_rows_to_keep();
 }
 
 std::size_t ElementSolverController::get_num_cols_to_keep() const {
-  std::size_t count = 0;
-  for (auto c : best_cols_to_keep) {
-    count += c;
-  }
-  return count;
+  return incumbent.get_num_cols_to_keep();
 }
 
-FILE* ElementSolverController::open_file_for_read(const std::string &file_name) const {
-  FILE* input;
-  if ((input = fopen(file_name.c_str(), "r")) == nullptr) {
-    fprintf(stderr, "ERROR - Could not open file %s\n", file_name.c_str());
-    exit(1);
-  }
-  return input;
+std::size_t ElementSolverController::get_num_screened() const {
+  return scheduler->get_num_screened();
 }
 
-void ElementSolverController::read_forced_one_rows() {
-  std::string file_name = scratch_dir + "forcedOneRows.txt";
-  FILE* input = open_file_for_read(file_name);
-  char tmp_str[50];
-
-  while (true) {
-    fscanf(input, "%s", tmp_str);
-
-    if (feof(input)) {
-      break;
-    }
-
-    forced_one_rows.push_back(std::stoul(tmp_str));
-  }
-
-  fclose(input);
+std::size_t ElementSolverController::get_num_pruned() const {
+  return scheduler->get_num_pruned();
 }
 
-void ElementSolverController::read_forced_one_cols() {
-  std::string file_name = scratch_dir + "forcedOneCols.txt";
-  FILE* input = open_file_for_read(file_name);
-  char tmp_str[50];
-
-  while (true) {
-    fscanf(input, "%s", tmp_str);
+std::size_t ElementSolverController::get_num_solved() const {
+  return scheduler->get_num_solved();
+}
 
-    if (feof(input)) {
-      break;
-    }
+// Writes a record of every task completed from now on to 'file_name'
+void ElementSolverController::open_task_log(const std::string &file_name) {
+  task_log.open(file_name);
+}
 
-    forced_one_cols.push_back(std::stoul(tmp_str));
-  }
+void ElementSolverController::print_utilization() const {
+  task_log.print_utilization();
+}
 
-  fclose(input);
+void ElementSolverController::write_utilization(const std::string &file_name) const {
+  task_log.write_utilization(file_name);
 }
 
-void ElementSolverController::read_free_rows() {
-  std::string file_name = scratch_dir + "freeRows.txt";
-  FILE* input = open_file_for_read(file_name);
-  char tmp_str[50];
+//------------------------------------------------------------------------------
+// Returns the available worker on the node with the most available workers, so
+// that co-located idle workers remain free to be lent to it.
+//------------------------------------------------------------------------------
+int ElementSolverController::select_worker() const {
+  assert(!available_workers.empty());
 
-  while (true) {
-    fscanf(input, "%s", tmp_str);
+  std::vector<std::size_t> num_available(world_size, 0);
+  int worker = *available_workers.begin();
 
-    if (feof(input)) {
-      break;
+  for (auto w : available_workers) {
+    if (++num_available[node_ids[w]] > num_available[node_ids[worker]]) {
+      worker = w;
     }
-
-    free_rows.push_back(std::stoul(tmp_str));
   }
-
-  fclose(input);
+  return worker;
 }
 
-void ElementSolverController::read_free_cols() {
-  std::string file_name = scratch_dir + "freeCols.txt";
-  FILE* input = open_file_for_read(file_name);
-  char tmp_str[50];
+//------------------------------------------------------------------------------
+// When fewer row_sums remain open than there are available workers, the
+// surplus workers on the same node as 'worker' are made unavailable until
+// 'worker' completes, and their cores are given to its CPLEX threads. Returns
+// the number of threads 'worker' may use.
+//------------------------------------------------------------------------------
+std::size_t ElementSolverController::lend_idle_workers(const int worker) {
+  assert(lent_workers[worker].empty());
 
-  while (true) {
-    fscanf(input, "%s", tmp_str);
+  const std::size_t num_open = scheduler->get_num_open();
+  if (available_workers.size() <= num_open) {
+    return 1;
+  }
+  std::size_t num_surplus = available_workers.size() - num_open;
 
-    if (feof(input)) {
+  for (auto it = available_workers.begin(); it != available_workers.end() && num_surplus > 0;) {
+    if (lent_workers[worker].size() + 1 >= MAX_CPLEX_THREADS) {
       break;
     }
-
-    free_cols.push_back(std::stoul(tmp_str));
+    if (node_ids[*it] == node_ids[worker]) {
+      lent_workers[worker].push_back(*it);
+      Parallel::dequeue(*it);
+      it = available_workers.erase(it);
+      --num_surplus;
+    } else {
+      ++it;
+    }
   }
 
-  fclose(input);
+  return lent_workers[worker].size() + 1;
 }
 
-void ElementSolverController::send_problem(const std::size_t row_sum,
-                                           const std::size_t min_cols) {
+void ElementSolverController::send_problem(const RowSumScheduler::Task &task) {
   if (available_workers.empty()) { // wait for a free worker
     receive_completion();
   }
+
+  PhaseTimer dispatch_timer("dispatch");
   
   assert(!available_workers.empty()); // Cannot send problem with no available workers
 
-  const int worker = available_workers.top();
-  // fprintf(stderr, "Sending rowsum=%lu to worker %d\n", row_sum, worker);
+  const int worker = select_worker();
 
-  // Send the row_sum for the problem
-  MPI_Send(&row_sum, 1, CUSTOM_SIZE_T, worker, Parallel::SPARSE_TAG, MPI_COMM_WORLD);
+  // Make the worker unavailable
+  available_workers.erase(worker);
+  unavailable_workers.insert(worker);
+  Parallel::dequeue(worker);
 
-  // Send the minimum number of columns for the problem
-  MPI_Send(&min_cols, 1, CUSTOM_SIZE_T, worker, Parallel::SPARSE_TAG, MPI_COMM_WORLD);
+  // Screening does not use CPLEX, so only solve tasks borrow idle workers
+  std::size_t num_threads = 1;
+  if (task.type == RowSumScheduler::SOLVE_TASK) {
+    num_threads = lend_idle_workers(worker);
+  }
 
-  // Loop through each free row & send row-pairs if it is valid
-  for (std::size_t i = 0; i < free_rows.size()-1; ++i) {
-    MPI_Send(&valid_row[i], 1, MPI_INT, worker, Parallel::SPARSE_TAG, MPI_COMM_WORLD);
+  fprintf(stderr, "%s row_sum=%lu - min_cols=%lu - threads=%lu\n",
+          task.type == RowSumScheduler::SCREEN_TASK ? "Screening" : "Solving",
+          task.row_sum, task.min_cols, num_threads);
 
-    if (valid_row[i] == 1) {
-      auto rp = row_pairs.getPairsLtThresh(i, min_cols, valid_row);
-      std::size_t num_pairs = rp.size();
+  // Send the row_sum for the problem
+  Parallel::send(&task.row_sum, 1, CUSTOM_SIZE_T, worker, Parallel::SPARSE_TAG);
 
-      MPI_Send(&num_pairs, 1, CUSTOM_SIZE_T, worker, Parallel::SPARSE_TAG, MPI_COMM_WORLD);
-      if (num_pairs > 0) {
-        MPI_Send(&rp[0], rp.size(), CUSTOM_SIZE_T, worker, Parallel::SPARSE_TAG, MPI_COMM_WORLD);
-      }
-    }
-  }
-  MPI_Send(&valid_row[free_rows.size()-1], 1, MPI_INT, worker, Parallel::SPARSE_TAG, MPI_COMM_WORLD);
+  // Send the minimum number of columns for the problem
+  Parallel::send(&task.min_cols, 1, CUSTOM_SIZE_T, worker, Parallel::SPARSE_TAG);
 
-  // Loop through each free column & send col-pairs if it is valid
-  for (std::size_t j = 0; j < free_cols.size()-1; ++j) {
-    MPI_Send(&valid_col[j], 1, MPI_INT, worker, Parallel::SPARSE_TAG, MPI_COMM_WORLD);
+  // Send whether the row_sum should only be screened or also solved
+  const int type = task.type;
+  Parallel::send(&type, 1, MPI_INT, worker, Parallel::SPARSE_TAG);
 
-    if (valid_col[j] == 1) {
-      auto cp = col_pairs.getPairsLtThresh(j, row_sum, valid_col);
-      std::size_t num_pairs = cp.size();
+  // Send the number of CPLEX threads the worker may use
+  Parallel::send(&num_threads, 1, CUSTOM_SIZE_T, worker, Parallel::SPARSE_TAG);
 
-      MPI_Send(&num_pairs, 1, CUSTOM_SIZE_T, worker, Parallel::SPARSE_TAG, MPI_COMM_WORLD);
-      if (num_pairs > 0) {
-        MPI_Send(&cp[0], num_pairs, CUSTOM_SIZE_T, worker, Parallel::SPARSE_TAG, MPI_COMM_WORLD);
-      }
-    }
-  }
-  MPI_Send(&valid_col[free_cols.size()-1], 1, MPI_INT, worker, Parallel::SPARSE_TAG, MPI_COMM_WORLD);
-
-  // Make the worker unavailable
-  available_workers.pop();
-  unavailable_workers.insert(worker);
+  worker_task[worker] = task;
+  worker_start[worker] = task_log.elapsed();
+  worker_threads[worker] = num_threads;
 }
 
 void ElementSolverController::receive_completion() {
@@ -353,34 +366,81 @@ void ElementSolverController::receive_completion() {
   MPI_Status status;
 
   // Receive the solution
-  MPI_Probe(MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &status);
+  PhaseTimer wait_timer("wait");
+  Parallel::wait_for_message(MPI_ANY_SOURCE, status);
+  wait_timer.stop();
+
+  PhaseTimer dispatch_timer("dispatch");
 
-  // Receive row/col indicator
+  // Receive row_sum
   std::size_t row_sum;
-  MPI_Recv(&row_sum, 1, CUSTOM_SIZE_T, status.MPI_SOURCE, Parallel::SPARSE_TAG, MPI_COMM_WORLD, &status);
-  
+  Parallel::recv(&row_sum, 1, CUSTOM_SIZE_T, status.MPI_SOURCE, Parallel::SPARSE_TAG, &status);
+
+  // Receive whether the row_sum was pruned, screened or solved
+  int outcome;
+  Parallel::recv(&outcome, 1, MPI_INT, status.MPI_SOURCE, Parallel::SPARSE_TAG, &status);
+
+  // Receive the number of columns that survived the screening
+  std::size_t num_cols_bound;
+  Parallel::recv(&num_cols_bound, 1, CUSTOM_SIZE_T, status.MPI_SOURCE, Parallel::SPARSE_TAG, &status);
+
   // Receive obj_value
   std::size_t obj_value;
-  MPI_Recv(&obj_value, 1, CUSTOM_SIZE_T, status.MPI_SOURCE, Parallel::SPARSE_TAG, MPI_COMM_WORLD, &status);
+  Parallel::recv(&obj_value, 1, CUSTOM_SIZE_T, status.MPI_SOURCE, Parallel::SPARSE_TAG, &status);
+
+  // Receive the screening, model build and solve times, and the surviving free
+  // rows and columns, cuts and nodes
+  double times[3];
+  Parallel::recv(times, 3, MPI_DOUBLE, status.MPI_SOURCE, Parallel::SPARSE_TAG, &status);
+  std::size_t counts[4];
+  Parallel::recv(counts, 4, CUSTOM_SIZE_T, status.MPI_SOURCE, Parallel::SPARSE_TAG, &status);
 
   std::size_t num_elements = row_sum * obj_value;
   std::vector<int> tmp_rows(num_rows), tmp_cols(num_cols);
 
   if (obj_value > 0) {
-    if (num_elements > best_num_elements) {
-      MPI_Recv(&best_rows_to_keep[0], num_rows, MPI_INT, status.MPI_SOURCE, Parallel::SPARSE_TAG, MPI_COMM_WORLD, &status);
-      MPI_Recv(&best_cols_to_keep[0], num_cols, MPI_INT, status.MPI_SOURCE, Parallel::SPARSE_TAG, MPI_COMM_WORLD, &status);
-      best_num_elements = num_elements;
-      noMissSummary::write_solution_to_file("Element.sol", best_rows_to_keep, best_cols_to_keep);
-
+    Parallel::recv(&tmp_rows[0], num_rows, MPI_INT, status.MPI_SOURCE, Parallel::SPARSE_TAG, &status);
+    Parallel::recv(&tmp_cols[0], num_cols, MPI_INT, status.MPI_SOURCE, Parallel::SPARSE_TAG, &status);
+    if (incumbent.update(tmp_rows, tmp_cols, num_elements)) {
       fprintf(stderr, "*** New incumbent: %lu ***\n", num_elements);
-    } else {
-      MPI_Recv(&tmp_rows[0], num_rows, MPI_INT, status.MPI_SOURCE, Parallel::SPARSE_TAG, MPI_COMM_WORLD, &status);
-      MPI_Recv(&tmp_cols[0], num_cols, MPI_INT, status.MPI_SOURCE, Parallel::SPARSE_TAG, MPI_COMM_WORLD, &status);
+      scheduler->update_incumbent(num_elements);
     }
   }
   
-  // Make the workers available again
-  available_workers.push(status.MPI_SOURCE);
+  scheduler->report(row_sum, static_cast<RowSumScheduler::Outcome>(outcome), num_cols_bound);
+
+  const int worker = status.MPI_SOURCE;
+  ElementTaskLog::Record record;
+  record.task = worker_task[worker];
+  record.outcome = static_cast<RowSumScheduler::Outcome>(outcome);
+  record.worker = worker;
+  record.num_threads = worker_threads[worker];
+  record.start_time = worker_start[worker];
+  record.turnaround = task_log.elapsed() - worker_start[worker];
+  record.stats.screen_time = times[0];
+  record.stats.build_time = times[1];
+  record.stats.solve_time = times[2];
+  record.stats.num_valid_rows = counts[0];
+  record.stats.num_valid_cols = counts[1];
+  record.stats.num_cuts = counts[2];
+  record.stats.num_nodes = counts[3];
+  record.obj_value = obj_value;
+  record.num_cols_bound = num_cols_bound;
+  record.bytes_sent = 3 * sizeof(std::size_t) + sizeof(int);
+  record.bytes_received = 3 * sizeof(std::size_t) + sizeof(int) + sizeof(times) + sizeof(counts) +
+                          (obj_value > 0 ? (num_rows + num_cols) * sizeof(int) : 0);
+  task_log.record(record);
+  for (auto w : lent_workers[worker]) {
+    task_log.record_lent(w, record.turnaround);
+  }
+
+  // Make the workers available again, including any lent to this worker
+  available_workers.insert(status.MPI_SOURCE);
   unavailable_workers.erase(status.MPI_SOURCE);
+  Parallel::enqueue(status.MPI_SOURCE);
+  for (auto w : lent_workers[status.MPI_SOURCE]) {
+    available_workers.insert(w);
+    Parallel::enqueue(w);
+  }
+  lent_workers[status.MPI_SOURCE].clear();
 }
\ No newline at end of file
@@ -1,13 +1,17 @@
 #ifndef ELEMENT_SOLVER_CONTROLLER_H
 #define ELEMENT_SOLVER_CONTROLLER_H
 
-#include <stack>
 #include <set>
 #include <vector>
 #include <string>
+#include <memory>
 
 #include "BinContainer.h"
-#include "Pairs.h"
+#include "ElementIncumbent.h"
+#include "ElementTaskLog.h"
+#include "IncumbentStore.h"
+#include "RowSumScheduler.h"
+#include "Timer.h"
 
 class ElementSolverController
 {
@@ -18,41 +22,45 @@ private:
   const std::string scratch_dir;
 
   const std::size_t world_size;
+  const std::size_t MAX_CPLEX_THREADS;
+  const std::vector<int> node_ids;
 
-  std::stack<int> available_workers;
+  std::set<int> available_workers;
   std::set<int> unavailable_workers;
+  std::vector<std::vector<int>> lent_workers;
 
-  std::vector<std::size_t> forced_one_rows;
-  std::vector<std::size_t> forced_one_cols;
+  // Task, start time and number of threads of the task every worker is running
+  ElementTaskLog task_log;
+  std::vector<RowSumScheduler::Task> worker_task;
+  std::vector<double> worker_start;
+  std::vector<std::size_t> worker_threads;
 
-  std::vector<std::size_t> free_rows;
-  std::vector<std::size_t> free_cols;
+  ElementIncumbent incumbent;
+  std::unique_ptr<RowSumScheduler> scheduler;
 
-  Pairs row_pairs;
-  Pairs col_pairs;
+  // The sweep is written to 'checkpoint_file' every CHECKPOINT_INTERVAL seconds
+  const double CHECKPOINT_INTERVAL;
+  const std::string checkpoint_file;
+  Timer checkpoint_timer;
 
-  std::vector<int> valid_row;
-  std::vector<int> valid_col;
+  void adopt_shared_incumbent();
+  void resume_from_checkpoint();
+  void write_checkpoint() const;
 
-  std::size_t best_num_elements;
-  std::vector<int> best_rows_to_keep;
-  std::vector<int> best_cols_to_keep;
-
-  FILE* open_file_for_read(const std::string &file_name) const;
-  void read_forced_one_rows();
-  void read_forced_one_cols();
-  void read_free_rows();
-  void read_free_cols();
-
-  void send_problem(const std::size_t row_sum,
-                    const std::size_t min_cols);
+  int select_worker() const;
+  std::size_t lend_idle_workers(const int worker);
+  void send_problem(const RowSumScheduler::Task &task);
 
   void receive_completion();  
 
 public:
   ElementSolverController(const BinContainer &_data,
                           const std::string &_scratch_dir,
-                          const std::string &incumbent_file);
+                          const std::string &incumbent_file,
+                          const std::vector<int> &_node_ids,
+                          const std::size_t _MAX_CPLEX_THREADS,
+                          const double HEURISTIC_TIME_LIMIT,
+                          const double _CHECKPOINT_INTERVAL = 0.0);
   ~ElementSolverController();
 
   void work();
@@ -64,6 +72,14 @@ public:
   std::vector<int> get_cols_to_keep() const;
   std::size_t get_num_rows_to_keep() const;
   std::size_t get_num_cols_to_keep() const;
+  std::size_t get_num_screened() const;
+  std::size_t get_num_pruned() const;
+  std::size_t get_num_solved() const;
+
+  void set_incumbent_store(IncumbentStore &_store);
+  void open_task_log(const std::string &file_name);
+  void print_utilization() const;
+  void write_utilization(const std::string &file_name) const;
 };
 
 #endif
\ No newline at end of file
@@ -1,11 +1,13 @@
 #ifndef ELEMENT_SOLVER_WORKER_H
 #define ELEMENT_SOLVER_WORKER_H
 
+#include <map>
 #include <vector>
 #include <string>
 #include "BinContainer.h"
-#include "Pairs.h"
-#include "ElementIpSolver.h"
+#include "ElementProblemData.h"
+#include "ElementTaskRunner.h"
+#include "RowSumScheduler.h"
 
 class ElementSolverWorker
 {
@@ -13,47 +15,26 @@ private:
   const BinContainer *data;
   const std::size_t num_rows;
   const std::size_t num_cols;
-  const std::string scratch_file;
   const std::size_t world_rank;
-  const std::size_t LARGE_MATRIX;
   bool end_;
 
-  std::size_t row_sum;
-  std::size_t min_cols;
-  std::vector<int> valid_row;
-  std::vector<int> valid_col;
+  RowSumScheduler::Task task;
+  std::size_t num_threads;
 
-  std::size_t obj_value;
-  std::vector<int> rows_to_keep;
-  std::vector<int> cols_to_keep;
-
-  std::vector<std::size_t> forced_one_rows;
-  std::vector<std::size_t> forced_one_cols;
-
-  std::vector<std::size_t> free_rows;
-  std::vector<std::size_t> free_cols;
-
-  std::vector<std::pair<std::size_t, std::vector<std::size_t>>> row_pairs;
-  std::vector<std::pair<std::size_t, std::vector<std::size_t>>> col_pairs;
-
-  FILE* open_file_for_read(const std::string &file_name) const;
-  void read_forced_one_rows();
-  void read_forced_one_cols();
-  void read_free_rows();
-  void read_free_cols();
+  ElementProblemData problem;
+  ElementTaskRunner runner;
 
   void receive_problem();
   void send_back_solution();
 
-  void clear_pairs();
-
 public:
   ElementSolverWorker(const BinContainer &_data,
                       const std::string &_scratch_dir,
-                      const std::size_t _LARGE_MATRIX);
+                      const std::map<std::string, std::string> &_index_files,
+                      const Formulation::Type _formulation);
   ~ElementSolverWorker();
 
   void work();
   bool end() const;
 };
-#endif
\ No newline at end of file
+#endif
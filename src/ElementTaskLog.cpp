@@ -0,0 +1,136 @@
+#include "ElementTaskLog.h"
+#include <cstdlib>
+
+//------------------------------------------------------------------------------
+// Constructor. Workers are numbered from 'first_worker'. Nothing is written
+// until open() is called.
+//------------------------------------------------------------------------------
+ElementTaskLog::ElementTaskLog(const int _first_worker, const std::size_t num_workers) : first_worker(_first_worker),
+                                                                                         output(nullptr),
+                                                                                         timer(true),
+                                                                                         num_tasks(num_workers, 0),
+                                                                                         busy_time(num_workers, 0.0),
+                                                                                         lent_time(num_workers, 0.0)
+{}
+
+//------------------------------------------------------------------------------
+// Destructor.
+//------------------------------------------------------------------------------
+ElementTaskLog::~ElementTaskLog() {
+  if (output != nullptr) {
+    fclose(output);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Starts writing a record per task to 'file_name', after a header line.
+//------------------------------------------------------------------------------
+void ElementTaskLog::open(const std::string &file_name) {
+  if ((output = fopen(file_name.c_str(), "w")) == nullptr) {
+    fprintf(stderr, "ERROR - Could not open file (%s)\n", file_name.c_str());
+    exit(1);
+  }
+  fprintf(output, "row_sum,min_cols,type,outcome,worker,threads,start,turnaround,screen_time,build_time,solve_time,"
+                  "valid_rows,valid_cols,cuts,nodes,obj_value,num_cols_bound,bytes_sent,bytes_received\n");
+}
+
+//------------------------------------------------------------------------------
+// Restarts the clock that task start times and the idle time are measured by.
+// Called when the sweep starts, after the incumbent heuristic.
+//------------------------------------------------------------------------------
+void ElementTaskLog::start() {
+  timer.restart();
+}
+
+double ElementTaskLog::elapsed() const {
+  return timer.elapsed_wall_time();
+}
+
+//------------------------------------------------------------------------------
+// Adds the task to the time of its worker and writes its record. Records are
+// flushed as they are written, so the log of an interrupted run is complete.
+//------------------------------------------------------------------------------
+void ElementTaskLog::record(const Record &record) {
+  ++num_tasks[record.worker - first_worker];
+  busy_time[record.worker - first_worker] += record.turnaround;
+
+  if (output == nullptr) {
+    return;
+  }
+
+  static const char *type_names[] = {"screen", "solve"};
+  static const char *outcome_names[] = {"pruned", "screened", "solved"};
+  fprintf(output, "%lu,%lu,%s,%s,%d,%lu,%lf,%lf,%lf,%lf,%lf,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu\n",
+          record.task.row_sum,
+          record.task.min_cols,
+          type_names[record.task.type],
+          outcome_names[record.outcome],
+          record.worker,
+          record.num_threads,
+          record.start_time,
+          record.turnaround,
+          record.stats.screen_time,
+          record.stats.build_time,
+          record.stats.solve_time,
+          record.stats.num_valid_rows,
+          record.stats.num_valid_cols,
+          record.stats.num_cuts,
+          record.stats.num_nodes,
+          record.obj_value,
+          record.num_cols_bound,
+          record.bytes_sent,
+          record.bytes_received);
+  fflush(output);
+}
+
+//------------------------------------------------------------------------------
+// Adds 'seconds' the worker spent lending its threads to another worker.
+//------------------------------------------------------------------------------
+void ElementTaskLog::record_lent(const int worker, const double seconds) {
+  lent_time[worker - first_worker] += seconds;
+}
+
+//------------------------------------------------------------------------------
+// Prints the share of the sweep the workers spent running or lent to tasks.
+//------------------------------------------------------------------------------
+void ElementTaskLog::print_utilization() const {
+  const double total = elapsed() * num_tasks.size();
+  double busy = 0.0, lent = 0.0;
+  for (std::size_t w = 0; w < num_tasks.size(); ++w) {
+    busy += busy_time[w];
+    lent += lent_time[w];
+  }
+
+  if (total > 0.0) {
+    fprintf(stderr, "Workers ran tasks %.1lf%% and lent threads %.1lf%% of the %lf second sweep\n",
+            100.0 * busy / total, 100.0 * lent / total, elapsed());
+  }
+}
+
+//------------------------------------------------------------------------------
+// Writes a line per worker to 'file_name': worker,tasks,busy,lent,idle,
+// utilization, where idle is the rest of the sweep and utilization the share
+// of the sweep the worker was busy or lent.
+//------------------------------------------------------------------------------
+void ElementTaskLog::write_utilization(const std::string &file_name) const {
+  FILE *summary;
+  if ((summary = fopen(file_name.c_str(), "w")) == nullptr) {
+    fprintf(stderr, "ERROR - Could not open file (%s)\n", file_name.c_str());
+    exit(1);
+  }
+
+  const double total = elapsed();
+  fprintf(summary, "worker,tasks,busy,lent,idle,utilization\n");
+  for (std::size_t w = 0; w < num_tasks.size(); ++w) {
+    const double used = busy_time[w] + lent_time[w];
+    fprintf(summary, "%d,%lu,%lf,%lf,%lf,%lf\n",
+            first_worker + static_cast<int>(w),
+            num_tasks[w],
+            busy_time[w],
+            lent_time[w],
+            total > used ? total - used : 0.0,
+            total > 0.0 ? used / total : 0.0);
+  }
+
+  fclose(summary);
+}
@@ -0,0 +1,56 @@
+#ifndef ELEMENT_TASK_LOG_H
+#define ELEMENT_TASK_LOG_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "ElementTaskRunner.h"
+#include "RowSumScheduler.h"
+#include "Timer.h"
+
+// Log of the row_sum sweep of elementIp, with one CSV record per screening or
+// solve task, and the time every worker spent running tasks, lending its
+// threads to another worker's CPLEX, or idle. Workers are numbered as MPI ranks
+// by elementIp and as threads by elementIpThreaded.
+class ElementTaskLog
+{
+public:
+  struct Record {
+    RowSumScheduler::Task task;
+    RowSumScheduler::Outcome outcome;
+    int worker;
+    std::size_t num_threads;
+    double start_time;
+    double turnaround;
+    ElementTaskRunner::Stats stats;
+    std::size_t obj_value;
+    std::size_t num_cols_bound;
+    std::size_t bytes_sent;
+    std::size_t bytes_received;
+  };
+
+private:
+  const int first_worker;
+  FILE *output;
+  Timer timer;
+
+  std::vector<std::size_t> num_tasks;
+  std::vector<double> busy_time;
+  std::vector<double> lent_time;
+
+public:
+  ElementTaskLog(const int _first_worker, const std::size_t num_workers);
+  ~ElementTaskLog();
+
+  void open(const std::string &file_name);
+  void start();
+  double elapsed() const;
+
+  void record(const Record &record);
+  void record_lent(const int worker, const double seconds);
+
+  void print_utilization() const;
+  void write_utilization(const std::string &file_name) const;
+};
+
+#endif
@@ -0,0 +1,189 @@
+#include "ElementTaskRunner.h"
+#include "ElementIpSolver.h"
+#include "PhaseTimer.h"
+
+//------------------------------------------------------------------------------
+// Constructor. An AUTO formulation is resolved once from the free rows and
+// columns, since they are the same for every row_sum.
+//------------------------------------------------------------------------------
+ElementTaskRunner::ElementTaskRunner(const BinContainer &_data,
+                                     const ElementProblemData &_problem,
+                                     const Formulation::Type _formulation) : data(&_data),
+                                                                             problem(&_problem),
+                                                                             formulation(_formulation != Formulation::AUTO ? _formulation :
+                                                                                         Formulation::select(Formulation::count_na(_data,
+                                                                                                                                   _problem.get_free_rows(),
+                                                                                                                                   _problem.get_free_cols()))),
+                                                                             screener(_data,
+                                                                                      _problem.get_forced_one_rows(),
+                                                                                      _problem.get_forced_one_cols(),
+                                                                                      _problem.get_free_rows(),
+                                                                                      _problem.get_free_cols(),
+                                                                                      _problem.get_row_weights(),
+                                                                                      _problem.get_col_weights(),
+                                                                                      _problem.get_row_pairs(),
+                                                                                      _problem.get_col_pairs()),
+                                                                             row_sum(0),
+                                                                             min_cols(0),
+                                                                             outcome(RowSumScheduler::PRUNED),
+                                                                             num_cols_bound(0),
+                                                                             obj_value(0),
+                                                                             rows_to_keep(data->get_num_data_rows(), 0),
+                                                                             cols_to_keep(data->get_num_data_cols(), 0),
+                                                                             stats() {}
+
+//------------------------------------------------------------------------------
+// Destructor.
+//------------------------------------------------------------------------------
+ElementTaskRunner::~ElementTaskRunner() {}
+
+//------------------------------------------------------------------------------
+// Screens the row_sum of 'task' and, for solve tasks that survive the
+// screening, solves the Element IP with 'num_threads' CPLEX threads. The
+// screening is repeated for solve tasks since 'min_cols' may have increased
+// since the row_sum was screened.
+//------------------------------------------------------------------------------
+void ElementTaskRunner::run(const RowSumScheduler::Task &task, const std::size_t num_threads) {
+  row_sum = task.row_sum;
+  min_cols = task.min_cols;
+  obj_value = 0;
+  num_cols_bound = 0;
+  stats = Stats();
+
+  PhaseTimer screen_timer("screening");
+  const bool survived = screener.screen(row_sum, min_cols);
+  stats.screen_time = screen_timer.stop();
+  stats.num_valid_rows = screener.get_num_valid_rows();
+  stats.num_valid_cols = screener.get_num_valid_cols();
+  if (!survived) {
+    outcome = RowSumScheduler::PRUNED;
+    return;
+  }
+
+  num_cols_bound = screener.get_num_valid_cols() + problem->get_forced_one_cols().size();
+  if (task.type == RowSumScheduler::SOLVE_TASK) {
+    outcome = RowSumScheduler::SOLVED;
+    solve(num_threads);
+  } else {
+    outcome = RowSumScheduler::SCREENED;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Builds and solves the Element IP over the rows and columns that survived the
+// screening. 'obj_value' is left at zero if no solution with at least
+// 'min_cols' columns is found.
+//------------------------------------------------------------------------------
+void ElementTaskRunner::solve(const std::size_t num_threads) {
+  const std::vector<int> &valid_row = screener.get_valid_rows();
+  const std::vector<int> &valid_col = screener.get_valid_cols();
+  const std::vector<std::size_t> &free_rows = problem->get_free_rows();
+  const std::vector<std::size_t> &free_cols = problem->get_free_cols();
+  const Pairs &row_pairs = problem->get_row_pairs();
+  const Pairs &col_pairs = problem->get_col_pairs();
+
+  PhaseTimer build_timer("model_build");
+  ElementIpSolver ip_solver(*data,
+                            row_sum,
+                            min_cols,
+                            problem->get_forced_one_rows(),
+                            problem->get_forced_one_cols(),
+                            free_rows,
+                            free_cols,
+                            problem->get_row_classes(),
+                            problem->get_col_classes(),
+                            formulation);
+  ip_solver.set_num_threads(num_threads);
+  
+  // Add row constraints based on row_pairs
+  for (std::size_t i = 0; i + 1 < free_rows.size(); ++i) {
+    if (valid_row[i] == 0) {
+      ip_solver.set_row_to_zero(i);
+    } else {
+      auto rp = row_pairs.getPairsLtThresh(i, min_cols, valid_row);
+      if (!rp.empty()) {
+        ip_solver.add_row_pairs_cut(i, rp);
+        ++stats.num_cuts;
+      }
+    }
+  }
+  if (!free_rows.empty() && valid_row[free_rows.size()-1] == 0) {
+    ip_solver.set_row_to_zero(free_rows.size()-1);
+  }
+
+  // Add columns constraints based on col_pairs
+  for (std::size_t j = 0; j + 1 < free_cols.size(); ++j) {
+    if (valid_col[j] == 0) {
+      ip_solver.set_col_to_zero(j);
+    } else {
+      auto cp = col_pairs.getPairsLtThresh(j, row_sum, valid_col);
+      if (!cp.empty()) {
+        ip_solver.add_col_pairs_cut(j, cp);
+        ++stats.num_cuts;
+      }
+    }
+  }
+  if (!free_cols.empty() && valid_col[free_cols.size()-1] == 0) {
+    ip_solver.set_col_to_zero(free_cols.size()-1);
+  }
+
+  // Add the presolve dominance constraints. A row dominated by a screened out
+  // row cannot be kept either
+  for (auto &d : problem->get_row_dominance()) {
+    if (valid_row[d.first] == 0) continue;
+    if (valid_row[d.second] == 0) {
+      ip_solver.set_row_to_zero(d.first);
+    } else {
+      ip_solver.add_row_dominance_cut(d.first, d.second);
+      ++stats.num_cuts;
+    }
+  }
+  for (auto &d : problem->get_col_dominance()) {
+    if (valid_col[d.first] == 0) continue;
+    if (valid_col[d.second] == 0) {
+      ip_solver.set_col_to_zero(d.first);
+    } else {
+      ip_solver.add_col_dominance_cut(d.first, d.second);
+      ++stats.num_cuts;
+    }
+  }
+
+  stats.build_time = build_timer.stop();
+
+  Timer solve_timer(true);
+  ip_solver.solve();
+  stats.solve_time = solve_timer.elapsed_wall_time();
+  stats.num_nodes = ip_solver.get_num_nodes();
+  obj_value = ip_solver.get_obj_value();
+
+  if (obj_value >= min_cols) {
+    rows_to_keep = ip_solver.get_rows_to_keep();
+    cols_to_keep = ip_solver.get_cols_to_keep();
+  } else {
+    obj_value = 0;
+  }
+}
+
+RowSumScheduler::Outcome ElementTaskRunner::get_outcome() const {
+  return outcome;
+}
+
+std::size_t ElementTaskRunner::get_num_cols_bound() const {
+  return num_cols_bound;
+}
+
+std::size_t ElementTaskRunner::get_obj_value() const {
+  return obj_value;
+}
+
+const std::vector<int>& ElementTaskRunner::get_rows_to_keep() const {
+  return rows_to_keep;
+}
+
+const std::vector<int>& ElementTaskRunner::get_cols_to_keep() const {
+  return cols_to_keep;
+}
+
+const ElementTaskRunner::Stats& ElementTaskRunner::get_stats() const {
+  return stats;
+}
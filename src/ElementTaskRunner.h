@@ -0,0 +1,60 @@
+#ifndef ELEMENT_TASK_RUNNER_H
+#define ELEMENT_TASK_RUNNER_H
+
+#include <vector>
+#include "BinContainer.h"
+#include "ElementProblemData.h"
+#include "Formulation.h"
+#include "RowSumScreener.h"
+#include "RowSumScheduler.h"
+
+class ElementTaskRunner
+{
+public:
+  // Measurements of the last task, for the task log. The build and solve times,
+  // cuts and nodes are zero unless the task was solved.
+  struct Stats {
+    double screen_time;
+    double build_time;
+    double solve_time;
+    std::size_t num_valid_rows;
+    std::size_t num_valid_cols;
+    std::size_t num_cuts;
+    std::size_t num_nodes;
+  };
+
+private:
+  const BinContainer *data;
+  const ElementProblemData *problem;
+  const Formulation::Type formulation;
+
+  RowSumScreener screener;
+
+  std::size_t row_sum;
+  std::size_t min_cols;
+  RowSumScheduler::Outcome outcome;
+  std::size_t num_cols_bound;
+  std::size_t obj_value;
+  std::vector<int> rows_to_keep;
+  std::vector<int> cols_to_keep;
+  Stats stats;
+
+  void solve(const std::size_t num_threads);
+
+public:
+  ElementTaskRunner(const BinContainer &_data,
+                    const ElementProblemData &_problem,
+                    const Formulation::Type _formulation);
+  ~ElementTaskRunner();
+
+  void run(const RowSumScheduler::Task &task, const std::size_t num_threads);
+
+  RowSumScheduler::Outcome get_outcome() const;
+  std::size_t get_num_cols_bound() const;
+  std::size_t get_obj_value() const;
+  const std::vector<int>& get_rows_to_keep() const;
+  const std::vector<int>& get_cols_to_keep() const;
+  const Stats& get_stats() const;
+};
+
+#endif
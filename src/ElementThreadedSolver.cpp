@@ -0,0 +1,234 @@
+#include "ElementThreadedSolver.h"
+#include <assert.h>
+#include <algorithm>
+#include "NoMissSummary.h"
+#include "CleanSolution.h"
+#include "RowSumScreener.h"
+
+//------------------------------------------------------------------------------
+// Constructor. 'num_threads' includes the calling thread, which solves
+// problems alongside the threads of the pool.
+//------------------------------------------------------------------------------
+ElementThreadedSolver::ElementThreadedSolver(const BinContainer &_data,
+                                             const ElementProblemData &_problem,
+                                             const std::string &incumbent_file,
+                                             const std::size_t _num_threads,
+                                             const std::size_t _MAX_CPLEX_THREADS,
+                                             const Formulation::Type _formulation,
+                                             const double HEURISTIC_TIME_LIMIT) : ElementThreadedSolver(_data,
+                                                                                                         _problem,
+                                                                                                         ElementIncumbent::read(_data, incumbent_file, _problem.get_scratch_dir()),
+                                                                                                         _num_threads,
+                                                                                                         _MAX_CPLEX_THREADS,
+                                                                                                         _formulation,
+                                                                                                         HEURISTIC_TIME_LIMIT)
+{}
+
+//------------------------------------------------------------------------------
+// Constructor for a caller that already holds the incumbent, such as the
+// in-memory pipeline of nomiss. The incumbent is kept up to date in
+// '_sol_file'.
+//------------------------------------------------------------------------------
+ElementThreadedSolver::ElementThreadedSolver(const BinContainer &_data,
+                                             const ElementProblemData &_problem,
+                                             const CleanSolution &_incumbent,
+                                             const std::size_t _num_threads,
+                                             const std::size_t _MAX_CPLEX_THREADS,
+                                             const Formulation::Type _formulation,
+                                             const double HEURISTIC_TIME_LIMIT,
+                                             const std::string &_sol_file) : data(&_data),
+                                                                             problem(&_problem),
+                                                                             num_rows(data->get_num_data_rows()),
+                                                                             num_cols(data->get_num_data_cols()),
+                                                                             num_threads(_num_threads > 0 ? _num_threads : 1),
+                                                                             MAX_CPLEX_THREADS(_MAX_CPLEX_THREADS > 0 ? _MAX_CPLEX_THREADS : 1),
+                                                                             formulation(_formulation),
+                                                                             incumbent(_data, _incumbent, HEURISTIC_TIME_LIMIT, _sol_file),
+                                                                             pool(num_threads - 1),
+                                                                             num_active(0),
+                                                                             num_lent(0),
+                                                                             num_started(0),
+                                                                             task_log(0, num_threads) {
+  scheduler.reset(new RowSumScheduler(RowSumScreener::calc_max_cols_possible(*data),
+                                      incumbent.get_num_elements(),
+                                      incumbent.get_num_rows_to_keep()));
+}
+
+//------------------------------------------------------------------------------
+// Destructor.
+//------------------------------------------------------------------------------
+ElementThreadedSolver::~ElementThreadedSolver() {}
+
+//------------------------------------------------------------------------------
+// Exchanges the incumbent with the store of a portfolio run; see
+// ElementIncumbent::set_store().
+//------------------------------------------------------------------------------
+void ElementThreadedSolver::set_incumbent_store(IncumbentStore &_store) {
+  std::lock_guard<std::mutex> lock(mtx);
+  incumbent.set_store(_store);
+}
+
+//------------------------------------------------------------------------------
+// Adopts the best solution of the store if it beats the incumbent, so that the
+// next tasks are dispatched with the higher min_cols it allows. Called with
+// the lock held.
+//------------------------------------------------------------------------------
+void ElementThreadedSolver::adopt_shared_incumbent() {
+  if (incumbent.adopt_shared()) {
+    scheduler->update_incumbent(incumbent.get_num_elements());
+  }
+}
+
+//------------------------------------------------------------------------------
+// Runs the row_sum sweep on every thread of the pool and on the calling thread
+// until no remaining row_sum can beat the incumbent.
+//------------------------------------------------------------------------------
+void ElementThreadedSolver::work() {
+  task_log.start();
+  for (std::size_t i = 0; i < pool.size(); ++i) {
+    pool.submit([this] { run_tasks(); });
+  }
+  run_tasks();
+  pool.wait();
+}
+
+//------------------------------------------------------------------------------
+// Mirrors ElementSolverController::lend_idle_workers. When fewer row_sums
+// remain open than there are idle threads, the surplus idle threads are held
+// back and their cores given to the CPLEX threads of this solve. Must be called
+// with 'mtx' held.
+//------------------------------------------------------------------------------
+std::size_t ElementThreadedSolver::lend_idle_threads(const RowSumScheduler::Task &task) {
+  if (task.type != RowSumScheduler::SOLVE_TASK) {
+    return 0;
+  }
+
+  const std::size_t num_idle = num_threads - num_active - num_lent;
+  const std::size_t num_open = scheduler->get_num_open();
+  if (num_idle <= num_open) {
+    return 0;
+  }
+
+  const std::size_t num_to_lend = std::min(num_idle - num_open, MAX_CPLEX_THREADS - 1);
+  num_lent += num_to_lend;
+  return num_to_lend;
+}
+
+//------------------------------------------------------------------------------
+// Reports the outcome of 'task' to the scheduler and updates the incumbent.
+// Must be called with 'mtx' held.
+//------------------------------------------------------------------------------
+void ElementThreadedSolver::record_result(const RowSumScheduler::Task &task, const ElementTaskRunner &runner) {
+  const std::size_t num_elements = task.row_sum * runner.get_obj_value();
+
+  if (runner.get_obj_value() > 0 && incumbent.update(runner.get_rows_to_keep(), runner.get_cols_to_keep(), num_elements)) {
+    fprintf(stderr, "*** New incumbent: %lu ***\n", num_elements);
+    scheduler->update_incumbent(num_elements);
+  }
+
+  scheduler->report(task.row_sum, runner.get_outcome(), runner.get_num_cols_bound());
+}
+
+//------------------------------------------------------------------------------
+// Adds the record of 'task', run by 'thread_id', to the task log. Nothing is
+// sent between threads, so no bytes are recorded. Must be called with 'mtx'
+// held.
+//------------------------------------------------------------------------------
+void ElementThreadedSolver::log_task(const RowSumScheduler::Task &task,
+                                     const ElementTaskRunner &runner,
+                                     const int thread_id,
+                                     const std::size_t threads,
+                                     const double start_time) {
+  ElementTaskLog::Record record;
+  record.task = task;
+  record.outcome = runner.get_outcome();
+  record.worker = thread_id;
+  record.num_threads = threads;
+  record.start_time = start_time;
+  record.turnaround = task_log.elapsed() - start_time;
+  record.stats = runner.get_stats();
+  record.obj_value = runner.get_obj_value();
+  record.num_cols_bound = runner.get_num_cols_bound();
+  record.bytes_sent = 0;
+  record.bytes_received = 0;
+  task_log.record(record);
+}
+
+//------------------------------------------------------------------------------
+// Loop executed by every thread. A thread takes the next task only while the
+// active threads, and the threads lent to them, leave a core free.
+//------------------------------------------------------------------------------
+void ElementThreadedSolver::run_tasks() {
+  ElementTaskRunner runner(*data, *problem, formulation);
+  RowSumScheduler::Task task;
+
+  std::unique_lock<std::mutex> lock(mtx);
+  const int thread_id = num_started++;
+  while (true) {
+    adopt_shared_incumbent();
+    if (num_active + num_lent < num_threads && scheduler->next_task(task)) {
+      ++num_active;
+      const std::size_t num_to_lend = lend_idle_threads(task);
+
+      fprintf(stderr, "%s row_sum=%lu - min_cols=%lu - threads=%lu\n",
+              task.type == RowSumScheduler::SCREEN_TASK ? "Screening" : "Solving",
+              task.row_sum, task.min_cols, num_to_lend + 1);
+
+      const double start_time = task_log.elapsed();
+      lock.unlock();
+      runner.run(task, num_to_lend + 1);
+      lock.lock();
+
+      --num_active;
+      num_lent -= num_to_lend;
+      record_result(task, runner);
+      log_task(task, runner, thread_id, num_to_lend + 1, start_time);
+      task_done.notify_all();
+    } else if (num_active > 0) {
+      task_done.wait(lock);
+    } else {
+      break;
+    }
+  }
+}
+
+std::vector<int> ElementThreadedSolver::get_rows_to_keep() const {
+  return incumbent.get_rows_to_keep();
+}
+
+std::vector<int> ElementThreadedSolver::get_cols_to_keep() const {
+  return incumbent.get_cols_to_keep();
+}
+
+std::size_t ElementThreadedSolver::get_num_rows_to_keep() const {
+  return incumbent.get_num_rows_to_keep();
+}
+
+std::size_t ElementThreadedSolver::get_num_cols_to_keep() const {
+  return incumbent.get_num_cols_to_keep();
+}
+
+std::size_t ElementThreadedSolver::get_num_screened() const {
+  return scheduler->get_num_screened();
+}
+
+std::size_t ElementThreadedSolver::get_num_pruned() const {
+  return scheduler->get_num_pruned();
+}
+
+std::size_t ElementThreadedSolver::get_num_solved() const {
+  return scheduler->get_num_solved();
+}
+
+// Writes a record of every task completed from now on to 'file_name'
+void ElementThreadedSolver::open_task_log(const std::string &file_name) {
+  task_log.open(file_name);
+}
+
+void ElementThreadedSolver::print_utilization() const {
+  task_log.print_utilization();
+}
+
+void ElementThreadedSolver::write_utilization(const std::string &file_name) const {
+  task_log.write_utilization(file_name);
+}
@@ -0,0 +1,89 @@
+#ifndef ELEMENT_THREADED_SOLVER_H
+#define ELEMENT_THREADED_SOLVER_H
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <string>
+
+#include "BinContainer.h"
+#include "CleanSolution.h"
+#include "ElementIncumbent.h"
+#include "ElementProblemData.h"
+#include "ElementTaskLog.h"
+#include "ElementTaskRunner.h"
+#include "Formulation.h"
+#include "IncumbentStore.h"
+#include "RowSumScheduler.h"
+#include "ThreadPool.h"
+
+class ElementThreadedSolver
+{
+private:
+  const BinContainer *data;
+  const ElementProblemData *problem;
+  const std::size_t num_rows;
+  const std::size_t num_cols;
+  const std::size_t num_threads;
+  const std::size_t MAX_CPLEX_THREADS;
+  const Formulation::Type formulation;
+  ElementIncumbent incumbent;
+
+  ThreadPool pool;
+  std::mutex mtx;
+  std::condition_variable task_done;
+  std::size_t num_active;
+  std::size_t num_lent;
+  std::size_t num_started;
+
+  // Threads are numbered in the order they start, the calling thread last
+  ElementTaskLog task_log;
+
+  std::unique_ptr<RowSumScheduler> scheduler;
+
+  void adopt_shared_incumbent();
+  std::size_t lend_idle_threads(const RowSumScheduler::Task &task);
+  void record_result(const RowSumScheduler::Task &task, const ElementTaskRunner &runner);
+  void log_task(const RowSumScheduler::Task &task,
+                const ElementTaskRunner &runner,
+                const int thread_id,
+                const std::size_t threads,
+                const double start_time);
+  void run_tasks();
+
+public:
+  ElementThreadedSolver(const BinContainer &_data,
+                        const ElementProblemData &_problem,
+                        const std::string &incumbent_file,
+                        const std::size_t _num_threads,
+                        const std::size_t _MAX_CPLEX_THREADS,
+                        const Formulation::Type _formulation,
+                        const double HEURISTIC_TIME_LIMIT);
+  ElementThreadedSolver(const BinContainer &_data,
+                        const ElementProblemData &_problem,
+                        const CleanSolution &_incumbent,
+                        const std::size_t _num_threads,
+                        const std::size_t _MAX_CPLEX_THREADS,
+                        const Formulation::Type _formulation,
+                        const double HEURISTIC_TIME_LIMIT,
+                        const std::string &_sol_file = "Element.sol");
+  ~ElementThreadedSolver();
+
+  void work();
+
+  std::vector<int> get_rows_to_keep() const;
+  std::vector<int> get_cols_to_keep() const;
+  std::size_t get_num_rows_to_keep() const;
+  std::size_t get_num_cols_to_keep() const;
+  std::size_t get_num_screened() const;
+  std::size_t get_num_pruned() const;
+  std::size_t get_num_solved() const;
+
+  void set_incumbent_store(IncumbentStore &_store);
+  void open_task_log(const std::string &file_name);
+  void print_utilization() const;
+  void write_utilization(const std::string &file_name) const;
+};
+
+#endif
@@ -0,0 +1,90 @@
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <algorithm>
+#include "BinContainer.h"
+#include "Timer.h"
+#include "PhaseTimer.h"
+#include "ConfigParser.h"
+#include "NoMissSummary.h"
+#include "Formulation.h"
+#include "ElementProblemData.h"
+#include "ElementThreadedSolver.h"
+#include "IncumbentStore.h"
+
+int main(int argc, char *argv[]) {
+  if (!(argc == 6) && !(argc == 7)) {
+    fprintf(stderr, "Usage: %s <data_file> <na_symbol> <scratch_dir> <num_header_rows> <num_header_cols> (opt)<incument_file>", argv[0]);
+    exit(1);
+  }
+
+  std::string data_file(argv[1]);
+  std::string na_symbol(argv[2]);
+  std::string scratch_dir(argv[3]);
+  std::size_t num_header_rows = std::stoul(argv[4]);
+  std::size_t num_header_cols = std::stoul(argv[5]);
+  std::string incumbent_file = "";
+
+  if (argc == 7) {
+    incumbent_file = argv[6];
+  }
+
+  BinContainer data(data_file, na_symbol, num_header_rows, num_header_cols);
+  ConfigParser parser("config.cfg");
+  const bool PRINT_SUMMARY = parser.getBool("PRINT_SUMMARY");
+  const bool WRITE_STATS = parser.getBool("WRITE_STATS");
+  const Formulation::Type FORMULATION = Formulation::parse(parser.getString("FORMULATION"));
+  const std::size_t MAX_CPLEX_THREADS = parser.getSizeT("MAX_CPLEX_THREADS");
+  const double HEURISTIC_TIME_LIMIT = parser.getDouble("HEURISTIC_TIME_LIMIT");
+  const bool PORTFOLIO = parser.getBool("PORTFOLIO");
+  std::size_t NUM_THREADS = parser.getSizeT("NUM_THREADS");
+
+  if (NUM_THREADS == 0) {
+    NUM_THREADS = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  Timer timer;
+  // Construct & solve Element problem
+  std::size_t num_rows_to_keep = 0, num_cols_to_keep = 0, num_val_elements = 0;
+  double run_time = 0.0;
+  std::vector<int> rows_to_keep(data.get_num_data_rows(), 0), cols_to_keep(data.get_num_data_cols(), 0);
+
+  timer.restart();
+  ElementProblemData problem(data, scratch_dir);
+  ElementThreadedSolver solver(data, problem, incumbent_file, NUM_THREADS, MAX_CPLEX_THREADS, FORMULATION, HEURISTIC_TIME_LIMIT);
+  if (WRITE_STATS) {
+    solver.open_task_log("ElementIp_tasks.csv");
+  }
+
+  // Adopt the solutions of the cleaning programs running alongside
+  IncumbentStore store(data);
+  if (PORTFOLIO) {
+    store.watch(IncumbentStore::get_program_files());
+    solver.set_incumbent_store(store);
+  }
+  solver.work();
+  fprintf(stderr, "Screened %lu row_sum values, pruned %lu and solved %lu\n", solver.get_num_screened(), solver.get_num_pruned(), solver.get_num_solved());
+  solver.print_utilization();
+
+  rows_to_keep = solver.get_rows_to_keep();
+  cols_to_keep = solver.get_cols_to_keep();
+  num_rows_to_keep = solver.get_num_rows_to_keep();
+  num_cols_to_keep = solver.get_num_cols_to_keep();
+  // CPU time is summed over all threads, so the wall time is reported instead
+  run_time = timer.elapsed_wall_time();
+  num_val_elements = data.get_num_valid_data_kept(rows_to_keep, cols_to_keep);
+
+  if (PRINT_SUMMARY) {
+    noMissSummary::summarize_results(data, na_symbol, "ElementIp", run_time, num_rows_to_keep, num_cols_to_keep, rows_to_keep, cols_to_keep);
+  }
+
+  // Wrtie statistics to file
+  if (WRITE_STATS) {
+    noMissSummary::write_stats_to_file("ElementIp_summary.csv", data_file, timer.elapsed_cpu_time(), run_time, num_val_elements, num_rows_to_keep, num_cols_to_keep);
+    PhaseTimer::write_to_file("ElementIp_phases.csv", data_file);
+    solver.write_utilization("ElementIp_workers.csv");
+  }
+
+  return 0;
+}
@@ -5,9 +5,13 @@
 #include "Timer.h"
 #include "ConfigParser.h"
 #include "NoMissSummary.h"
+#include "Formulation.h"
 #include "ElementSolverController.h"
 #include "ElementSolverWorker.h"
 #include "Parallel.h"
+#include "IncumbentStore.h"
+#include "ElementProblemData.h"
+#include "PhaseTimer.h"
 
 int main(int argc, char *argv[]) {
   //*
@@ -43,7 +47,15 @@ int main(int argc, char *argv[]) {
     ConfigParser parser("config.cfg");
     const bool PRINT_SUMMARY = parser.getBool("PRINT_SUMMARY");
     const bool WRITE_STATS = parser.getBool("WRITE_STATS");
-    const std::size_t LARGE_MATRIX = parser.getSizeT("LARGE_MATRIX");
+    const Formulation::Type FORMULATION = Formulation::parse(parser.getString("FORMULATION"));
+    const std::size_t MAX_CPLEX_THREADS = parser.getSizeT("MAX_CPLEX_THREADS");
+    const double HEURISTIC_TIME_LIMIT = parser.getDouble("HEURISTIC_TIME_LIMIT");
+    const double CHECKPOINT_INTERVAL = parser.getDouble("CHECKPOINT_INTERVAL");
+    const bool PORTFOLIO = parser.getBool("PORTFOLIO");
+    const std::vector<int> node_ids = Parallel::get_node_ids();
+
+    // The index files of calcPairs are read once, by rank 0, for all workers
+    const std::map<std::string, std::string> index_files = Parallel::broadcast_files(ElementProblemData::get_index_files(scratch_dir));
 
     switch (world_rank) {
       case 0: {
@@ -54,7 +66,17 @@ int main(int argc, char *argv[]) {
         std::vector<int> rows_to_keep(data.get_num_data_rows(), 0), cols_to_keep(data.get_num_data_cols(), 0);
   
         timer.restart();
-        ElementSolverController controller(data, scratch_dir, incumbent_file);
+        ElementSolverController controller(data, scratch_dir, incumbent_file, node_ids, MAX_CPLEX_THREADS, HEURISTIC_TIME_LIMIT, CHECKPOINT_INTERVAL);
+        if (WRITE_STATS) {
+          controller.open_task_log("ElementIp_tasks.csv");
+        }
+
+        // Adopt the solutions of the cleaning programs running alongside
+        IncumbentStore store(data);
+        if (PORTFOLIO) {
+          store.watch(IncumbentStore::get_program_files());
+          controller.set_incumbent_store(store);
+        }
         controller.work();
 
         while (controller.workers_still_working()) {
@@ -62,12 +84,14 @@ int main(int argc, char *argv[]) {
         }
 
         controller.signal_workers_to_end();
+        fprintf(stderr, "Screened %lu row_sum values, pruned %lu and solved %lu\n", controller.get_num_screened(), controller.get_num_pruned(), controller.get_num_solved());
+        controller.print_utilization();
 
         rows_to_keep = controller.get_rows_to_keep();
         cols_to_keep = controller.get_cols_to_keep();
         num_rows_to_keep = controller.get_num_rows_to_keep();
         num_cols_to_keep = controller.get_num_cols_to_keep();
-        run_time = timer.elapsed_cpu_time();
+        run_time = timer.elapsed_wall_time();
         num_val_elements = data.get_num_valid_data_kept(rows_to_keep, cols_to_keep);
 
         if (PRINT_SUMMARY) {
@@ -76,20 +100,27 @@ int main(int argc, char *argv[]) {
 
         // Wrtie statistics to file
         if (WRITE_STATS) {
-          noMissSummary::write_stats_to_file("ElementIp_summary.csv", data_file, run_time, num_val_elements, num_rows_to_keep, num_cols_to_keep);
+          noMissSummary::write_stats_to_file("ElementIp_summary.csv", data_file, timer.elapsed_cpu_time(), run_time, num_val_elements, num_rows_to_keep, num_cols_to_keep);
+          controller.write_utilization("ElementIp_workers.csv");
         }
 
         break;
       }
 
       default: {
-        ElementSolverWorker worker(data, scratch_dir, LARGE_MATRIX);
+        ElementSolverWorker worker(data, scratch_dir, index_files, FORMULATION);
         while (!worker.end()) {
           worker.work();
         }
         break;
       }
     }
+
+    // Every rank appends the phases it timed
+    if (WRITE_STATS) {
+      PhaseTimer::write_to_file("ElementIp_phases.csv", data_file, world_rank);
+    }
+    Parallel::report(WRITE_STATS ? "ElementIp_mpi.csv" : "", data_file);
   } catch (std::exception &e) {
     fprintf(stderr, "  *** Fatal error reported by rank_%d: %s *** \n", world_rank, e.what());    
     MPI_Abort(MPI_COMM_WORLD, 1);
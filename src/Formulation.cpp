@@ -0,0 +1,129 @@
+#include "Formulation.h"
+#include <cstdio>
+#include <cstdlib>
+
+//------------------------------------------------------------------------------
+// Counts the missing elements of the submatrix made of 'rows' and 'cols', and
+// the number of those rows and columns that contain at least one.
+//------------------------------------------------------------------------------
+Formulation::Counts Formulation::count_na(const BinContainer &data,
+                                          const std::vector<std::size_t> &rows,
+                                          const std::vector<std::size_t> &cols)
+{
+  Counts counts = {0, 0, 0};
+  std::vector<bool> col_has_na(cols.size(), false);
+
+  std::vector<long> local_col(data.get_num_data_cols(), -1);
+  for (std::size_t local_j = 0; local_j < cols.size(); ++local_j) {
+    local_col[cols[local_j]] = local_j;
+  }
+
+  for (auto i : rows) {
+    std::size_t num_na_in_row = 0;
+    data.for_each_na_in_row(i, [&](const std::size_t j) {
+      if (local_col[j] >= 0) {
+        ++num_na_in_row;
+        col_has_na[local_col[j]] = true;
+      }
+    });
+    counts.num_na += num_na_in_row;
+    counts.num_rows_with_na += (num_na_in_row > 0);
+  }
+
+  for (auto has_na : col_has_na) {
+    counts.num_cols_with_na += has_na;
+  }
+
+  return counts;
+}
+
+
+//------------------------------------------------------------------------------
+// Counts the missing elements of the full data matrix using the row and column
+// counts already stored by the BinContainer.
+//------------------------------------------------------------------------------
+Formulation::Counts Formulation::count_na(const BinContainer &data)
+{
+  Counts counts = {0, 0, 0};
+
+  for (std::size_t i = 0; i < data.get_num_data_rows(); ++i) {
+    const std::size_t num_na_in_row = data.get_num_invalid_in_row(i);
+    counts.num_na += num_na_in_row;
+    counts.num_rows_with_na += (num_na_in_row > 0);
+  }
+  for (std::size_t j = 0; j < data.get_num_data_cols(); ++j) {
+    counts.num_cols_with_na += (data.get_num_invalid_in_col(j) > 0);
+  }
+
+  return counts;
+}
+
+
+//------------------------------------------------------------------------------
+// Returns the number of missing-data constraints 'type' adds to the model.
+//------------------------------------------------------------------------------
+std::size_t Formulation::get_num_constraints(const Type type, const Counts &counts)
+{
+  switch (type) {
+    case ROW_AGGREGATED:
+      return counts.num_rows_with_na;
+    case COL_AGGREGATED:
+      return counts.num_cols_with_na;
+    default:
+      return counts.num_na;
+  }
+}
+
+
+//------------------------------------------------------------------------------
+// Picks the formulation for the measured missing counts. Aggregating along the
+// dimension with fewer constrained rows/cols gives the smallest model, but its
+// LP relaxation is weaker, so it is only used when each aggregated constraint
+// replaces enough per-element constraints.
+//------------------------------------------------------------------------------
+Formulation::Type Formulation::select(const Counts &counts)
+{
+  if (counts.num_na == 0) {
+    return PER_ELEMENT;
+  }
+
+  const Type aggregated = (counts.num_rows_with_na <= counts.num_cols_with_na) ? ROW_AGGREGATED : COL_AGGREGATED;
+  const double na_per_constraint = static_cast<double>(counts.num_na) / get_num_constraints(aggregated, counts);
+
+  return (na_per_constraint >= MIN_NA_PER_AGGREGATED_CONSTRAINT) ? aggregated : PER_ELEMENT;
+}
+
+
+//------------------------------------------------------------------------------
+// Converts the value of a FORMULATION config flag.
+//------------------------------------------------------------------------------
+Formulation::Type Formulation::parse(const std::string &name)
+{
+  if (name == "auto") {
+    return AUTO;
+  } else if (name == "element") {
+    return PER_ELEMENT;
+  } else if (name == "row") {
+    return ROW_AGGREGATED;
+  } else if (name == "col") {
+    return COL_AGGREGATED;
+  }
+
+  fprintf(stderr, "ERROR - Unknown formulation '%s'. Expected auto, element, row or col\n", name.c_str());
+  exit(1);
+}
+
+
+std::string Formulation::to_string(const Type type)
+{
+  switch (type) {
+    case PER_ELEMENT:
+      return "element";
+    case ROW_AGGREGATED:
+      return "row";
+    case COL_AGGREGATED:
+      return "col";
+    default:
+      return "auto";
+  }
+}
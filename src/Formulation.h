@@ -0,0 +1,37 @@
+#ifndef FORMULATION_H
+#define FORMULATION_H
+
+#include <string>
+#include <vector>
+#include "BinContainer.h"
+
+namespace Formulation {
+  // How the missing-data constraints of a row/col model are written
+  //   PER_ELEMENT    - r_i + c_j <= 1 for every missing element (i,j)
+  //   ROW_AGGREGATED - k_i*r_i + sum(c_j) <= k_i for every row i with k_i missing elements
+  //   COL_AGGREGATED - k_j*c_j + sum(r_i) <= k_j for every col j with k_j missing elements
+  enum Type { AUTO = 0, PER_ELEMENT = 1, ROW_AGGREGATED = 2, COL_AGGREGATED = 3 };
+
+  // An aggregated constraint replaces, on average, at least this many
+  // per-element constraints before its weaker LP relaxation is accepted
+  const double MIN_NA_PER_AGGREGATED_CONSTRAINT = 4.0;
+
+  struct Counts {
+    std::size_t num_na;
+    std::size_t num_rows_with_na;
+    std::size_t num_cols_with_na;
+  };
+
+  Counts count_na(const BinContainer &data,
+                  const std::vector<std::size_t> &rows,
+                  const std::vector<std::size_t> &cols);
+  Counts count_na(const BinContainer &data);
+
+  std::size_t get_num_constraints(const Type type, const Counts &counts);
+  Type select(const Counts &counts);
+
+  Type parse(const std::string &name);
+  std::string to_string(const Type type);
+}
+
+#endif
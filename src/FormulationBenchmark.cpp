@@ -0,0 +1,100 @@
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "BinContainer.h"
+#include "Timer.h"
+#include "ConfigParser.h"
+#include "Formulation.h"
+#include "ElementProblemData.h"
+#include "ElementIpSolver.h"
+#include "RowColLpSolver.h"
+#include "Presolve.h"
+
+//------------------------------------------------------------------------------
+// Builds and solves the rowColLp model and the elementIp model for 'row_sum'
+// with each formulation, and prints the model-build, LP relaxation and solve
+// wall times as CSV. The elementIp models do not include the pairs cuts or
+// a cutoff, so that only the missing-data constraints differ.
+//------------------------------------------------------------------------------
+int main(int argc, char *argv[]) {
+  if (argc != 7) {
+    fprintf(stderr, "Usage: %s <data_file> <na_symbol> <scratch_dir> <num_header_rows> <num_header_cols> <row_sum>\n", argv[0]);
+    exit(1);
+  }
+
+  std::string data_file(argv[1]);
+  std::string na_symbol(argv[2]);
+  std::string scratch_dir(argv[3]);
+  std::size_t num_header_rows = std::stoul(argv[4]);
+  std::size_t num_header_cols = std::stoul(argv[5]);
+  std::size_t row_sum = std::stoul(argv[6]);
+
+  BinContainer data(data_file, na_symbol, num_header_rows, num_header_cols);
+  ConfigParser parser("config.cfg");
+  const std::size_t MAX_CPLEX_THREADS = parser.getSizeT("MAX_CPLEX_THREADS");
+
+  ElementProblemData problem(data, scratch_dir);
+  if (row_sum < problem.get_forced_one_rows().size() || row_sum > data.get_num_data_rows()) {
+    fprintf(stderr, "ERROR - row_sum must be between %lu and %lu\n", problem.get_forced_one_rows().size(), data.get_num_data_rows());
+    exit(1);
+  }
+
+  const Formulation::Counts all_counts = Formulation::count_na(data);
+  const Formulation::Counts free_counts = Formulation::count_na(data, problem.get_free_rows(), problem.get_free_cols());
+  const Formulation::Type types[] = {Formulation::PER_ELEMENT, Formulation::ROW_AGGREGATED, Formulation::COL_AGGREGATED};
+  const Presolve presolve(data);
+  Timer timer;
+
+  printf("# rowColLp: %lu missing, auto selects %s\n", all_counts.num_na, Formulation::to_string(Formulation::select(all_counts)).c_str());
+  printf("# elementIp: %lu missing in free rows/cols, auto selects %s\n", free_counts.num_na, Formulation::to_string(Formulation::select(free_counts)).c_str());
+  printf("model,formulation,constraints,build_time,lp_time,solve_time,objective\n");
+
+  for (auto type : types) {
+    timer.restart();
+    RowColLpSolver rc_solver(data, presolve, type);
+    rc_solver.set_num_threads(MAX_CPLEX_THREADS);
+    timer.stop();
+    const double build_time = timer.elapsed_wall_time();
+
+    timer.restart();
+    rc_solver.solve();
+    timer.stop();
+    const double lp_time = timer.elapsed_wall_time();
+
+    printf("rowColLp,%s,%lu,%f,%f,%f,%f\n", Formulation::to_string(type).c_str(), Formulation::get_num_constraints(type, all_counts),
+           build_time, lp_time, lp_time, rc_solver.get_obj_value());
+  }
+
+  for (auto type : types) {
+    timer.restart();
+    ElementIpSolver ip_solver(data,
+                              row_sum,
+                              0,
+                              problem.get_forced_one_rows(),
+                              problem.get_forced_one_cols(),
+                              problem.get_free_rows(),
+                              problem.get_free_cols(),
+                              problem.get_row_classes(),
+                              problem.get_col_classes(),
+                              type);
+    ip_solver.set_num_threads(MAX_CPLEX_THREADS);
+    timer.stop();
+    const double build_time = timer.elapsed_wall_time();
+
+    timer.restart();
+    ip_solver.solve_relaxation();
+    timer.stop();
+    const double lp_time = timer.elapsed_wall_time();
+
+    timer.restart();
+    ip_solver.solve();
+    timer.stop();
+    const double solve_time = timer.elapsed_wall_time();
+
+    printf("elementIp,%s,%lu,%f,%f,%f,%lu\n", Formulation::to_string(type).c_str(), Formulation::get_num_constraints(type, free_counts),
+           build_time, lp_time, solve_time, ip_solver.get_num_elements());
+  }
+
+  return 0;
+}
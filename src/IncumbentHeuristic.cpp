@@ -0,0 +1,236 @@
+#include "IncumbentHeuristic.h"
+#include <algorithm>
+#include <numeric>
+#include "AddRowGreedy.h"
+#include "Utils.h"
+
+//------------------------------------------------------------------------------
+// Constructor. 'time_limit' is the number of seconds the local search may run.
+//------------------------------------------------------------------------------
+IncumbentHeuristic::IncumbentHeuristic(const BinContainer &_data,
+                                       const double _time_limit) : data(&_data),
+                                                                   num_rows(data->get_num_data_rows()),
+                                                                   num_cols(data->get_num_data_cols()),
+                                                                   time_limit(_time_limit),
+                                                                   row_kept(num_rows, false),
+                                                                   num_rows_kept(0),
+                                                                   num_na_in_col(num_cols, 0),
+                                                                   complete_cols(data->get_num_row_words(), 0),
+                                                                   single_na_cols(data->get_num_row_words(), 0),
+                                                                   best_num_elements(0),
+                                                                   best_rows_to_keep(num_rows, 0),
+                                                                   best_cols_to_keep(num_cols, 0) {}
+
+//------------------------------------------------------------------------------
+// Destructor.
+//------------------------------------------------------------------------------
+IncumbentHeuristic::~IncumbentHeuristic() {}
+
+//------------------------------------------------------------------------------
+// Adds columns by increasing missingness while keeping a bitmask of the rows
+// that are still complete, and returns the rows of the best prefix.
+//------------------------------------------------------------------------------
+std::vector<bool> IncumbentHeuristic::greedy_col_add() const {
+  std::vector<std::size_t> order(num_cols);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [this](const std::size_t lhs, const std::size_t rhs) {
+    return data->get_num_invalid_in_col(lhs) < data->get_num_invalid_in_col(rhs);
+  });
+
+  std::vector<std::uint64_t> surviving_rows(data->get_num_col_words(), ~std::uint64_t(0));
+  std::vector<std::uint64_t> best_rows(surviving_rows.size(), 0);
+  std::size_t best = 0;
+
+  for (std::size_t k = 0; k < order.size(); ++k) {
+    const std::size_t num_surviving = utils::and_count_bits(surviving_rows, data->get_col_bits(order[k]));
+    if (num_surviving == 0) {
+      break;
+    }
+    if ((k + 1) * num_surviving > best) {
+      best = (k + 1) * num_surviving;
+      best_rows = surviving_rows;
+    }
+  }
+
+  std::vector<bool> rows(num_rows, false);
+  for (std::size_t i = 0; i < num_rows; ++i) {
+    rows[i] = (best_rows[i / BinContainer::BITS_PER_WORD] >> (i % BinContainer::BITS_PER_WORD)) & 1;
+  }
+  return rows;
+}
+
+//------------------------------------------------------------------------------
+// Makes 'rows' the current solution.
+//------------------------------------------------------------------------------
+void IncumbentHeuristic::set_rows(const std::vector<bool> &rows) {
+  row_kept.assign(num_rows, false);
+  num_na_in_col.assign(num_cols, 0);
+  num_rows_kept = 0;
+
+  for (std::size_t i = 0; i < num_rows; ++i) {
+    if (rows[i]) {
+      row_kept[i] = true;
+      ++num_rows_kept;
+      for (std::size_t j = 0; j < num_cols; ++j) {
+        num_na_in_col[j] += data->is_data_na(i, j);
+      }
+    }
+  }
+  update_col_masks();
+}
+
+void IncumbentHeuristic::add_row(const std::size_t row) {
+  row_kept[row] = true;
+  ++num_rows_kept;
+  for (std::size_t j = 0; j < num_cols; ++j) {
+    num_na_in_col[j] += data->is_data_na(row, j);
+  }
+  update_col_masks();
+}
+
+void IncumbentHeuristic::remove_row(const std::size_t row) {
+  row_kept[row] = false;
+  --num_rows_kept;
+  for (std::size_t j = 0; j < num_cols; ++j) {
+    num_na_in_col[j] -= data->is_data_na(row, j);
+  }
+  update_col_masks();
+}
+
+//------------------------------------------------------------------------------
+// Rebuilds the bitmasks of the columns missed by no kept row (kept columns)
+// and by exactly one kept row (columns gained by removing that row).
+//------------------------------------------------------------------------------
+void IncumbentHeuristic::update_col_masks() {
+  std::fill(complete_cols.begin(), complete_cols.end(), 0);
+  std::fill(single_na_cols.begin(), single_na_cols.end(), 0);
+
+  for (std::size_t j = 0; j < num_cols; ++j) {
+    const std::uint64_t bit = std::uint64_t(1) << (j % BinContainer::BITS_PER_WORD);
+    if (num_na_in_col[j] == 0) {
+      complete_cols[j / BinContainer::BITS_PER_WORD] |= bit;
+    } else if (num_na_in_col[j] == 1) {
+      single_na_cols[j / BinContainer::BITS_PER_WORD] |= bit;
+    }
+  }
+}
+
+std::size_t IncumbentHeuristic::get_num_elements() const {
+  return num_rows_kept * utils::count_bits(complete_cols);
+}
+
+//------------------------------------------------------------------------------
+// Stores in 'mask' the columns that would be kept if 'row' were removed.
+//------------------------------------------------------------------------------
+void IncumbentHeuristic::cols_after_removing(const std::size_t row, std::vector<std::uint64_t> &mask) const {
+  const std::vector<std::uint64_t> &row_bits = data->get_row_bits(row);
+  for (std::size_t w = 0; w < mask.size(); ++w) {
+    mask[w] = complete_cols[w] | (single_na_cols[w] & ~row_bits[w]);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Applies the first improving move found among adding a row, removing a row,
+// and swapping a kept row for a removed one. Every move is scored with an AND
+// and popcount over the column words. Returns false if no move improves the
+// solution or the time limit is reached.
+//------------------------------------------------------------------------------
+bool IncumbentHeuristic::improve(const Timer &timer) {
+  const std::size_t current = get_num_elements();
+  std::vector<std::uint64_t> mask(complete_cols.size());
+
+  for (std::size_t k = 0; k < num_rows; ++k) {
+    if (row_kept[k]) continue;
+    mask = complete_cols;
+    if ((num_rows_kept + 1) * utils::and_count_bits(mask, data->get_row_bits(k)) > current) {
+      add_row(k);
+      return true;
+    }
+  }
+
+  if (num_rows_kept <= 1) {
+    return false;
+  }
+
+  std::vector<std::uint64_t> removed_mask(complete_cols.size());
+  for (std::size_t i = 0; i < num_rows; ++i) {
+    if (!row_kept[i]) continue;
+    if (timer.elapsed_wall_time() > time_limit) {
+      return false;
+    }
+
+    cols_after_removing(i, removed_mask);
+    if ((num_rows_kept - 1) * utils::count_bits(removed_mask) > current) {
+      remove_row(i);
+      return true;
+    }
+
+    for (std::size_t k = 0; k < num_rows; ++k) {
+      if (row_kept[k]) continue;
+      mask = removed_mask;
+      if (num_rows_kept * utils::and_count_bits(mask, data->get_row_bits(k)) > current) {
+        remove_row(i);
+        add_row(k);
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+//------------------------------------------------------------------------------
+// Runs the local search from 'rows' and records the result if it is the best.
+//------------------------------------------------------------------------------
+void IncumbentHeuristic::local_search(const std::vector<bool> &rows, const Timer &timer) {
+  set_rows(rows);
+  while (timer.elapsed_wall_time() < time_limit && improve(timer)) {}
+
+  const std::size_t num_elements = get_num_elements();
+  if (num_elements > best_num_elements) {
+    best_num_elements = num_elements;
+    for (std::size_t i = 0; i < num_rows; ++i) {
+      best_rows_to_keep[i] = row_kept[i];
+    }
+    for (std::size_t j = 0; j < num_cols; ++j) {
+      best_cols_to_keep[j] = (num_na_in_col[j] == 0) && (num_rows_kept > 0);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Runs the local search from the given incumbent, from the row-add greedy and
+// from the column-add greedy.
+//------------------------------------------------------------------------------
+void IncumbentHeuristic::run(const std::vector<int> &rows_to_keep, const std::vector<int> &cols_to_keep) {
+  Timer timer(true);
+
+  // Columns are implied by the rows, so only the rows of the incumbent are used
+  std::size_t num_rows_given = 0;
+  std::vector<bool> rows(num_rows, false);
+  for (std::size_t i = 0; i < num_rows; ++i) {
+    rows[i] = rows_to_keep[i];
+    num_rows_given += rows_to_keep[i];
+  }
+  if (num_rows_given > 0 && std::count(cols_to_keep.begin(), cols_to_keep.end(), 1) > 0) {
+    local_search(rows, timer);
+  }
+
+  AddRowGreedy greedy(*data);
+  greedy.solve();
+  local_search(greedy.get_rows_to_keep(), timer);
+
+  local_search(greedy_col_add(), timer);
+}
+
+std::size_t IncumbentHeuristic::get_best_num_elements() const {
+  return best_num_elements;
+}
+
+std::vector<int> IncumbentHeuristic::get_rows_to_keep() const {
+  return best_rows_to_keep;
+}
+
+std::vector<int> IncumbentHeuristic::get_cols_to_keep() const {
+  return best_cols_to_keep;
+}
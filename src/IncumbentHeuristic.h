@@ -0,0 +1,51 @@
+#ifndef INCUMBENT_HEURISTIC_H
+#define INCUMBENT_HEURISTIC_H
+
+#include <cstdint>
+#include <vector>
+#include "BinContainer.h"
+#include "Timer.h"
+
+class IncumbentHeuristic
+{
+private:
+  const BinContainer *data;
+  const std::size_t num_rows;
+  const std::size_t num_cols;
+  const double time_limit;
+
+  // Current solution: the kept rows, and for every column the number of kept
+  // rows missing it. Columns with no missing kept rows are kept.
+  std::vector<bool> row_kept;
+  std::size_t num_rows_kept;
+  std::vector<std::size_t> num_na_in_col;
+  std::vector<std::uint64_t> complete_cols;
+  std::vector<std::uint64_t> single_na_cols;
+
+  std::size_t best_num_elements;
+  std::vector<int> best_rows_to_keep;
+  std::vector<int> best_cols_to_keep;
+
+  std::vector<bool> greedy_col_add() const;
+
+  void set_rows(const std::vector<bool> &rows);
+  void add_row(const std::size_t row);
+  void remove_row(const std::size_t row);
+  void update_col_masks();
+  std::size_t get_num_elements() const;
+  void cols_after_removing(const std::size_t row, std::vector<std::uint64_t> &mask) const;
+  bool improve(const Timer &timer);
+  void local_search(const std::vector<bool> &rows, const Timer &timer);
+
+public:
+  IncumbentHeuristic(const BinContainer &_data, const double _time_limit);
+  ~IncumbentHeuristic();
+
+  void run(const std::vector<int> &rows_to_keep, const std::vector<int> &cols_to_keep);
+
+  std::size_t get_best_num_elements() const;
+  std::vector<int> get_rows_to_keep() const;
+  std::vector<int> get_cols_to_keep() const;
+};
+
+#endif
@@ -0,0 +1,172 @@
+#include "IncumbentStore.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <set>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+//------------------------------------------------------------------------------
+// Constructor. The store starts empty.
+//------------------------------------------------------------------------------
+IncumbentStore::IncumbentStore(const BinContainer &_data) : data(&_data),
+                                                            version(0),
+                                                            best_num_elements(0),
+                                                            best_rows_to_keep(data->get_num_data_rows(), 0),
+                                                            best_cols_to_keep(data->get_num_data_cols(), 0),
+                                                            inotify_fd(-1)
+{}
+
+//------------------------------------------------------------------------------
+// Destructor.
+//------------------------------------------------------------------------------
+IncumbentStore::~IncumbentStore() {
+  if (inotify_fd >= 0) {
+    close(inotify_fd);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Keeps the solution if it has no missing data and more elements than the
+// best so far. Returns whether it was kept.
+//------------------------------------------------------------------------------
+bool IncumbentStore::offer(const std::vector<int> &rows_to_keep,
+                           const std::vector<int> &cols_to_keep,
+                           const std::string &source) {
+  std::lock_guard<std::mutex> lock(mtx);
+  return offer_locked(rows_to_keep, cols_to_keep, source);
+}
+
+bool IncumbentStore::offer(const std::vector<bool> &rows_to_keep,
+                           const std::vector<bool> &cols_to_keep,
+                           const std::string &source) {
+  return offer(std::vector<int>(rows_to_keep.begin(), rows_to_keep.end()),
+               std::vector<int>(cols_to_keep.begin(), cols_to_keep.end()),
+               source);
+}
+
+bool IncumbentStore::offer_locked(const std::vector<int> &rows_to_keep,
+                                  const std::vector<int> &cols_to_keep,
+                                  const std::string &source) {
+  const std::size_t num_rows_kept = std::count(rows_to_keep.begin(), rows_to_keep.end(), 1);
+  const std::size_t num_cols_kept = std::count(cols_to_keep.begin(), cols_to_keep.end(), 1);
+  const std::size_t num_elements = num_rows_kept * num_cols_kept;
+  if (num_elements <= best_num_elements || data->get_num_valid_data_kept(rows_to_keep, cols_to_keep) != num_elements) {
+    return false;
+  }
+
+  best_rows_to_keep = rows_to_keep;
+  best_cols_to_keep = cols_to_keep;
+  best_num_elements = num_elements;
+  ++version;
+  fprintf(stderr, "Shared incumbent: %lu from %s\n", best_num_elements, source.c_str());
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Starts watching the .sol files 'file_names' in the working directory, which
+// may not exist yet, and offers the ones that already do.
+//------------------------------------------------------------------------------
+void IncumbentStore::watch(const std::vector<std::string> &file_names) {
+  if (inotify_fd < 0) {
+    if ((inotify_fd = inotify_init1(IN_NONBLOCK)) < 0 ||
+        inotify_add_watch(inotify_fd, ".", IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+      fprintf(stderr, "ERROR - Could not watch the working directory for solution files\n");
+      exit(1);
+    }
+  }
+
+  std::vector<int> rows_to_keep, cols_to_keep;
+  for (auto &file_name : file_names) {
+    watched_files.push_back(file_name);
+    if (read_file(file_name, rows_to_keep, cols_to_keep)) {
+      offer(rows_to_keep, cols_to_keep, file_name);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Offers every watched file that was written since the last call. Never
+// blocks.
+//------------------------------------------------------------------------------
+void IncumbentStore::poll() {
+  if (inotify_fd < 0) {
+    return;
+  }
+
+  std::set<std::string> changed;
+  char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+  ssize_t len;
+  while ((len = read(inotify_fd, buffer, sizeof(buffer))) > 0) {
+    for (char *p = buffer; p < buffer + len; ) {
+      const struct inotify_event *event = reinterpret_cast<const struct inotify_event *>(p);
+      if (event->len > 0 && std::find(watched_files.begin(), watched_files.end(), event->name) != watched_files.end()) {
+        changed.insert(event->name);
+      }
+      p += sizeof(struct inotify_event) + event->len;
+    }
+  }
+
+  std::vector<int> rows_to_keep, cols_to_keep;
+  for (auto &file_name : changed) {
+    if (read_file(file_name, rows_to_keep, cols_to_keep)) {
+      offer(rows_to_keep, cols_to_keep, file_name);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Reads a solution written by noMissSummary::write_solution_to_file. Returns
+// false, rather than exiting, if the file is missing or was written for a
+// matrix of another size, since a watched file may belong to another run.
+//------------------------------------------------------------------------------
+bool IncumbentStore::read_file(const std::string &file_name,
+                               std::vector<int> &rows_to_keep,
+                               std::vector<int> &cols_to_keep) const {
+  FILE *input;
+  if ((input = fopen(file_name.c_str(), "r")) == nullptr) {
+    return false;
+  }
+
+  const std::size_t num_rows = data->get_num_data_rows();
+  const std::size_t num_cols = data->get_num_data_cols();
+  rows_to_keep.assign(num_rows, 0);
+  cols_to_keep.assign(num_cols, 0);
+
+  std::size_t idx = 0;
+  int value;
+  while (fscanf(input, "%d", &value) == 1) {
+    if (idx < num_rows) {
+      rows_to_keep[idx] = value;
+    } else if (idx < num_rows + num_cols) {
+      cols_to_keep[idx - num_rows] = value;
+    }
+    ++idx;
+  }
+  fclose(input);
+
+  return idx == num_rows + num_cols;
+}
+
+std::size_t IncumbentStore::get_version() const {
+  std::lock_guard<std::mutex> lock(mtx);
+  return version;
+}
+
+//------------------------------------------------------------------------------
+// Copies the best solution and returns its number of elements.
+//------------------------------------------------------------------------------
+std::size_t IncumbentStore::get_best(std::vector<int> &rows_to_keep, std::vector<int> &cols_to_keep) const {
+  std::lock_guard<std::mutex> lock(mtx);
+  rows_to_keep = best_rows_to_keep;
+  cols_to_keep = best_cols_to_keep;
+  return best_num_elements;
+}
+
+//------------------------------------------------------------------------------
+// Returns the .sol files the other cleaning programs write in the working
+// directory.
+//------------------------------------------------------------------------------
+std::vector<std::string> IncumbentStore::get_program_files() {
+  return {"AddRowGreedy.sol", "RowCol.sol", "Polished.sol", "Decompose.sol"};
+}
@@ -0,0 +1,57 @@
+#ifndef INCUMBENT_STORE_H
+#define INCUMBENT_STORE_H
+
+#include <mutex>
+#include <string>
+#include <vector>
+#include "BinContainer.h"
+
+// Best solution published by the cleaning algorithms of a portfolio run. Any
+// thread may offer a solution, and the store keeps it if it has no missing
+// data and more elements than the best so far. Solutions written by separate
+// programs are picked up by watching their .sol files with inotify: every
+// watched file closed after writing since the last poll() is read and offered.
+// The version counts the solutions kept, so a solver only needs to fetch the
+// best solution when the version has changed.
+class IncumbentStore
+{
+private:
+  const BinContainer *data;
+  mutable std::mutex mtx;
+
+  std::size_t version;
+  std::size_t best_num_elements;
+  std::vector<int> best_rows_to_keep;
+  std::vector<int> best_cols_to_keep;
+
+  int inotify_fd;
+  std::vector<std::string> watched_files;
+
+  bool offer_locked(const std::vector<int> &rows_to_keep,
+                    const std::vector<int> &cols_to_keep,
+                    const std::string &source);
+  bool read_file(const std::string &file_name,
+                 std::vector<int> &rows_to_keep,
+                 std::vector<int> &cols_to_keep) const;
+
+public:
+  IncumbentStore(const BinContainer &_data);
+  ~IncumbentStore();
+
+  bool offer(const std::vector<int> &rows_to_keep,
+             const std::vector<int> &cols_to_keep,
+             const std::string &source);
+  bool offer(const std::vector<bool> &rows_to_keep,
+             const std::vector<bool> &cols_to_keep,
+             const std::string &source);
+
+  void watch(const std::vector<std::string> &file_names);
+  void poll();
+
+  std::size_t get_version() const;
+  std::size_t get_best(std::vector<int> &rows_to_keep, std::vector<int> &cols_to_keep) const;
+
+  static std::vector<std::string> get_program_files();
+};
+
+#endif
@@ -0,0 +1,219 @@
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include "ConfigParser.h"
+#include "PhaseTimer.h"
+#include "ThreadPool.h"
+#include "Timer.h"
+#include "NoMissPipeline.h"
+
+namespace {
+  struct BatchJob {
+    std::string data_file;
+    std::string na_symbol;
+    std::size_t num_header_rows;
+    std::size_t num_header_cols;
+    std::size_t num_bytes;
+    std::unique_ptr<NoMissPipeline> pipeline;
+
+    // Seconds since the batch started
+    double parse_start;
+    double parse_end;
+    double solve_end;
+    double write_end;
+    std::size_t num_elements;
+
+    // "ok" once the matrix is cleaned, or the task that failed
+    std::string status;
+  };
+
+  //----------------------------------------------------------------------------
+  // Reads the manifest, with one matrix per line: data_file na_symbol
+  // num_header_rows num_header_cols. Blank lines and lines starting with #
+  // are skipped.
+  //----------------------------------------------------------------------------
+  std::vector<BatchJob> read_manifest(const std::string &file_name) {
+    std::ifstream input(file_name.c_str());
+    if (!input) {
+      fprintf(stderr, "ERROR - Could not open file (%s)\n", file_name.c_str());
+      exit(1);
+    }
+
+    std::vector<BatchJob> jobs;
+    std::string line;
+    std::size_t line_num = 0;
+    while (std::getline(input, line)) {
+      ++line_num;
+      std::istringstream iss(line);
+      BatchJob job;
+      if (!(iss >> job.data_file) || job.data_file[0] == '#') {
+        continue;
+      }
+      if (!(iss >> job.na_symbol >> job.num_header_rows >> job.num_header_cols)) {
+        fprintf(stderr, "ERROR - Line %lu of %s must hold <data_file> <na_symbol> <num_header_rows> <num_header_cols>\n",
+                line_num, file_name.c_str());
+        exit(1);
+      }
+
+      std::ifstream data(job.data_file.c_str(), std::ios::binary | std::ios::ate);
+      if (!data) {
+        fprintf(stderr, "ERROR - Could not open file (%s)\n", job.data_file.c_str());
+        exit(1);
+      }
+      job.num_bytes = data.tellg();
+      job.parse_start = job.parse_end = job.solve_end = job.write_end = 0.0;
+      job.num_elements = 0;
+      job.status = "pending";
+      jobs.push_back(std::move(job));
+    }
+    return jobs;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Cleans every matrix in a manifest in a single process. The parse, solve and
+// write task of each matrix run on one pool of BATCH_JOBS threads, so up to
+// BATCH_JOBS matrices are cleaned at once. The NUM_THREADS threads are
+// partitioned between them rather than shared: the solve task of a matrix
+// runs its stages on threads of its own, at most NUM_THREADS / BATCH_JOBS of
+// them, and waits for them. Tasks of larger matrices, by file size, are
+// started first so the longest pipelines do not start last. A matrix whose task fails
+// is reported and dropped, and the rest of the manifest is still cleaned; the
+// batch then exits with status 1.
+//------------------------------------------------------------------------------
+int main(int argc, char *argv[]) {
+  if (argc < 2 || argc > 3) {
+    fprintf(stderr, "Usage: %s <manifest> (opt)<stages>\n", argv[0]);
+    exit(1);
+  }
+
+  const std::string manifest(argv[1]);
+  const std::vector<bool> run_stage = NoMissPipeline::parse_stages(argc == 3 ? argv[2] : "greedy,rowcol,element,write");
+
+  ConfigParser parser("config.cfg");
+  const bool WRITE_STATS = parser.getBool("WRITE_STATS");
+  std::size_t NUM_THREADS = parser.getSizeT("NUM_THREADS");
+  std::size_t BATCH_JOBS = parser.getSizeT("BATCH_JOBS");
+
+  if (NUM_THREADS == 0) {
+    NUM_THREADS = std::max(1u, std::thread::hardware_concurrency());
+  }
+  // Every matrix cleaned at once needs at least one of the NUM_THREADS threads
+  if (BATCH_JOBS == 0 || BATCH_JOBS > NUM_THREADS) {
+    BATCH_JOBS = NUM_THREADS;
+  }
+
+  std::vector<BatchJob> jobs = read_manifest(manifest);
+  const std::size_t threads_per_job = NUM_THREADS / BATCH_JOBS;
+  fprintf(stderr, "Cleaning %lu matrices, %lu at a time with %lu threads each\n", jobs.size(), BATCH_JOBS, threads_per_job);
+
+  Timer timer(true);
+  std::mutex mtx;
+  {
+    ThreadPool pool(BATCH_JOBS);
+
+    // A failed task frees its matrix and queues nothing more for it
+    auto fail = [&](BatchJob &job, const std::string &task, const std::exception &e) {
+      std::lock_guard<std::mutex> lock(mtx);
+      fprintf(stderr, "ERROR - %s failed for %s: %s\n", task.c_str(), job.data_file.c_str(), e.what());
+      job.status = task;
+      job.pipeline.reset();
+    };
+
+    // Every task of a matrix queues the next one with the same priority, so a
+    // larger matrix moves ahead of the smaller ones still queued
+    auto write_task = [&](BatchJob &job) {
+      try {
+        if (run_stage[NoMissPipeline::WRITE]) {
+          job.pipeline->write();
+        }
+      } catch (std::exception &e) {
+        fail(job, "write", e);
+        return;
+      }
+      std::lock_guard<std::mutex> lock(mtx);
+      job.write_end = timer.elapsed_wall_time();
+      job.num_elements = job.pipeline->get_num_elements();
+      job.status = "ok";
+      job.pipeline.reset();
+    };
+    auto solve_task = [&](BatchJob &job) {
+      try {
+        job.pipeline->solve(run_stage);
+      } catch (std::exception &e) {
+        fail(job, "solve", e);
+        return;
+      }
+      {
+        std::lock_guard<std::mutex> lock(mtx);
+        job.solve_end = timer.elapsed_wall_time();
+      }
+      BatchJob *next = &job;
+      pool.submit([&write_task, next] { write_task(*next); }, job.num_bytes);
+    };
+    auto parse_task = [&](BatchJob &job) {
+      {
+        std::lock_guard<std::mutex> lock(mtx);
+        job.parse_start = timer.elapsed_wall_time();
+      }
+      try {
+        job.pipeline.reset(new NoMissPipeline(parser, job.data_file, job.na_symbol, job.num_header_rows, job.num_header_cols,
+                                              threads_per_job, job.data_file.substr(0, job.data_file.find_last_of(".")) + "_"));
+        job.pipeline->parse();
+      } catch (std::exception &e) {
+        fail(job, "parse", e);
+        return;
+      }
+      {
+        std::lock_guard<std::mutex> lock(mtx);
+        job.parse_end = timer.elapsed_wall_time();
+      }
+      BatchJob *next = &job;
+      pool.submit([&solve_task, next] { solve_task(*next); }, job.num_bytes);
+    };
+
+    for (auto &job : jobs) {
+      BatchJob *next = &job;
+      pool.submit([&parse_task, next] { parse_task(*next); }, job.num_bytes);
+    }
+    pool.wait();
+  }
+  timer.stop();
+
+  const std::size_t num_cleaned = std::count_if(jobs.begin(), jobs.end(), [](const BatchJob &job) { return job.status == "ok"; });
+  fprintf(stderr, "Cleaned %lu of %lu matrices in %lf seconds\n", num_cleaned, jobs.size(), timer.elapsed_wall_time());
+
+  // Wrtie statistics to file
+  if (WRITE_STATS) {
+    FILE *summary;
+    if ((summary = fopen("NoMissBatch_summary.csv", "a+")) == nullptr) {
+      fprintf(stderr, "ERROR - Could not open file (NoMissBatch_summary.csv)\n");
+      exit(1);
+    }
+    for (auto &job : jobs) {
+      fprintf(summary, "%s,%s,%lu,%lf,%lf,%lf,%lf,%lu,%s\n",
+              manifest.c_str(),
+              job.data_file.c_str(),
+              job.num_bytes,
+              job.parse_start,
+              job.parse_end,
+              job.solve_end,
+              job.write_end,
+              job.num_elements,
+              job.status.c_str());
+    }
+    fclose(summary);
+
+    PhaseTimer::write_to_file("NoMissBatch_phases.csv", manifest);
+  }
+
+  return (num_cleaned == jobs.size()) ? 0 : 1;
+}
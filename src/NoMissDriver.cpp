@@ -0,0 +1,55 @@
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <string>
+#include <thread>
+#include <algorithm>
+#include "ConfigParser.h"
+#include "PhaseTimer.h"
+#include "NoMissPipeline.h"
+
+//------------------------------------------------------------------------------
+// Runs the cleaning pipeline of one matrix in a single process; see
+// NoMissPipeline. The stages are greedy (addRowGreedy), rowcol (rowColLp),
+// element (calcPairs and elementIpThreaded, starting from the best solution
+// so far) and write (writeCleanedMatrix, for the best solution), always in
+// that order.
+//------------------------------------------------------------------------------
+int main(int argc, char *argv[]) {
+  if (argc < 5 || argc > 6) {
+    fprintf(stderr, "Usage: %s <data_file> <na_symbol> <num_header_rows> <num_header_cols> (opt)<stages>\n", argv[0]);
+    exit(1);
+  }
+
+  const std::string data_file(argv[1]);
+  const std::string na_symbol(argv[2]);
+  const std::size_t num_header_rows = std::stoul(argv[3]);
+  const std::size_t num_header_cols = std::stoul(argv[4]);
+  const std::vector<bool> run_stage = NoMissPipeline::parse_stages(argc == 6 ? argv[5] : "greedy,rowcol,element,write");
+
+  ConfigParser parser("config.cfg");
+  const bool WRITE_STATS = parser.getBool("WRITE_STATS");
+  std::size_t NUM_THREADS = parser.getSizeT("NUM_THREADS");
+
+  if (NUM_THREADS == 0) {
+    NUM_THREADS = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  NoMissPipeline pipeline(parser, data_file, na_symbol, num_header_rows, num_header_cols, NUM_THREADS);
+  try {
+    pipeline.parse();
+    pipeline.solve(run_stage);
+    if (run_stage[NoMissPipeline::WRITE]) {
+      pipeline.write();
+    }
+  } catch (std::exception &e) {
+    fprintf(stderr, "ERROR - %s\n", e.what());
+    exit(1);
+  }
+
+  if (WRITE_STATS) {
+    PhaseTimer::write_to_file("NoMiss_phases.csv", data_file);
+  }
+
+  return 0;
+}
@@ -0,0 +1,284 @@
+#include "NoMissPipeline.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include "Timer.h"
+#include "NoMissSummary.h"
+#include "AddRowGreedy.h"
+#include "RowColLpSolver.h"
+#include "CalcPairsCore.h"
+#include "CleanSolution.h"
+#include "Pairs.h"
+#include "ElementProblemData.h"
+#include "ElementThreadedSolver.h"
+
+namespace {
+  const char *STAGE_NAMES[] = {"greedy", "rowcol", "element", "write"};
+
+  // Keeps the summaries of pipelines running at once from interleaving
+  std::mutex print_mtx;
+}
+
+//------------------------------------------------------------------------------
+// Constructor. Reads the settings from 'parser'; the matrix is not read until
+// parse() is called. The stages share 'num_threads' threads; see solve().
+//------------------------------------------------------------------------------
+NoMissPipeline::NoMissPipeline(const ConfigParser &parser,
+                               const std::string &_data_file,
+                               const std::string &_na_symbol,
+                               const std::size_t _num_header_rows,
+                               const std::size_t _num_header_cols,
+                               const std::size_t _num_threads,
+                               const std::string &_prefix) : data_file(_data_file),
+                                                             na_symbol(_na_symbol),
+                                                             num_header_rows(_num_header_rows),
+                                                             num_header_cols(_num_header_cols),
+                                                             num_threads(_num_threads > 0 ? _num_threads : 1),
+                                                             prefix(_prefix),
+                                                             PRINT_SUMMARY(parser.getBool("PRINT_SUMMARY")),
+                                                             WRITE_STATS(parser.getBool("WRITE_STATS")),
+                                                             FORMULATION(Formulation::parse(parser.getString("FORMULATION"))),
+                                                             ROWCOL_FORMULATION(Formulation::parse(parser.getString("ROWCOL_FORMULATION"))),
+                                                             MAX_CPLEX_THREADS(parser.getSizeT("MAX_CPLEX_THREADS")),
+                                                             GREEDY_STARTS(parser.getSizeT("GREEDY_STARTS")),
+                                                             HEURISTIC_TIME_LIMIT(parser.getDouble("HEURISTIC_TIME_LIMIT")),
+                                                             PRESOLVE(parser.getBool("PRESOLVE")),
+                                                             PAIRS_PER_CHUNK(parser.getSizeT("PAIRS_PER_CHUNK")),
+                                                             PORTFOLIO(parser.getBool("PORTFOLIO")),
+                                                             best_num_elements(0),
+                                                             store(nullptr)
+{}
+
+//------------------------------------------------------------------------------
+// Destructor.
+//------------------------------------------------------------------------------
+NoMissPipeline::~NoMissPipeline() {}
+
+//------------------------------------------------------------------------------
+// Returns which of the stages are named in the comma separated list 'list'.
+//------------------------------------------------------------------------------
+std::vector<bool> NoMissPipeline::parse_stages(const std::string &list) {
+  std::vector<bool> run(NUM_STAGES, false);
+  std::istringstream iss(list);
+  std::string name;
+  while (std::getline(iss, name, ',')) {
+    const char **stage = std::find(STAGE_NAMES, STAGE_NAMES + NUM_STAGES, name);
+    if (stage == STAGE_NAMES + NUM_STAGES) {
+      fprintf(stderr, "ERROR - Unknown stage %s (expected greedy, rowcol, element or write)\n", name.c_str());
+      exit(1);
+    }
+    run[stage - STAGE_NAMES] = true;
+  }
+  return run;
+}
+
+//------------------------------------------------------------------------------
+// Reads the matrix and runs the presolve if PRESOLVE is set. The best solution
+// starts as the presolve incumbent, which is empty without the presolve.
+// Throws std::runtime_error if the matrix cannot be read.
+//------------------------------------------------------------------------------
+void NoMissPipeline::parse() {
+  data.reset(new BinContainer(data_file, na_symbol, num_header_rows, num_header_cols));
+
+  presolve.reset(new Presolve(*data));
+  if (PRESOLVE) {
+    presolve->run();
+  }
+
+  best_rows.assign(data->get_num_data_rows(), false);
+  best_cols.assign(data->get_num_data_cols(), false);
+  presolve->restore_incumbent(best_rows, best_cols);
+  best_num_elements = data->get_num_valid_data_kept(best_rows, best_cols);
+}
+
+//------------------------------------------------------------------------------
+// Runs the solving stages set in 'run_stage', in order. parse() must have been
+// called. With PORTFOLIO set, the greedy and rowcol stages run on threads of
+// their own while the element stage runs, and every solution they find that
+// beats the element incumbent is adopted by the sweep before its next task.
+// The stages share the num_threads threads of the pipeline: run one after
+// another, each gets all of them (rowcol at most MAX_CPLEX_THREADS), and in a
+// portfolio the greedy and rowcol stages get one each and the sweep the rest.
+// A pipeline with too few threads to leave one for the sweep runs its stages
+// one after another, as without PORTFOLIO.
+//------------------------------------------------------------------------------
+void NoMissPipeline::solve(const std::vector<bool> &run_stage) {
+  const std::size_t num_side_stages = run_stage[GREEDY] + run_stage[ROWCOL];
+  if (PORTFOLIO && run_stage[ELEMENT] && num_threads > num_side_stages) {
+    const std::size_t element_threads = num_threads - num_side_stages;
+
+    IncumbentStore portfolio_store(*data);
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      portfolio_store.offer(best_rows, best_cols, "presolve");
+      store = &portfolio_store;
+    }
+
+    std::vector<std::thread> threads;
+    if (run_stage[GREEDY]) {
+      threads.emplace_back(&NoMissPipeline::run_greedy, this, 1);
+    }
+    if (run_stage[ROWCOL]) {
+      threads.emplace_back(&NoMissPipeline::run_rowcol, this, 1);
+    }
+    run_element(element_threads);
+    for (auto &t : threads) {
+      t.join();
+    }
+
+    std::lock_guard<std::mutex> lock(mtx);
+    store = nullptr;
+    return;
+  }
+
+  if (run_stage[GREEDY]) {
+    run_greedy(num_threads);
+  }
+  if (run_stage[ROWCOL]) {
+    run_rowcol(std::min(num_threads, MAX_CPLEX_THREADS));
+  }
+  if (run_stage[ELEMENT]) {
+    run_element(num_threads);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Writes the best solution as <data_file>_cleaned.tsv and adds it to Best.csv,
+// as writeCleanedMatrix does, then frees the matrix. Throws
+// std::runtime_error, and writes nothing, if no solution keeps a valid
+// element.
+//------------------------------------------------------------------------------
+void NoMissPipeline::write() {
+  if (best_num_elements == 0) {
+    throw std::runtime_error("No valid solutions found for " + data_file);
+  }
+
+  fprintf(stderr, "Writing cleaned matrix for %s\n", data_file.c_str());
+  fprintf(stderr, "Matrix contains %lu valid elements\n", best_num_elements);
+  const std::string cleaned_file = data_file.substr(0, data_file.find_last_of(".")) + "_cleaned.tsv";
+  data->write_orig(cleaned_file, best_rows, best_cols);
+  noMissSummary::write_stats_to_file("Best.csv", data_file, 0, 0, best_num_elements,
+                                     std::count(best_rows.begin(), best_rows.end(), true),
+                                     std::count(best_cols.begin(), best_cols.end(), true));
+
+  presolve.reset();
+  data.reset();
+}
+
+std::size_t NoMissPipeline::get_num_elements() const {
+  return best_num_elements;
+}
+
+//------------------------------------------------------------------------------
+// Prints and writes the results of stage 'name', as its program would, and
+// keeps its solution if it is the best so far.
+//------------------------------------------------------------------------------
+void NoMissPipeline::record(const std::string &name,
+                            const double cpu_time,
+                            const double run_time,
+                            const std::vector<bool> &rows_to_keep,
+                            const std::vector<bool> &cols_to_keep) {
+  const std::size_t num_rows_to_keep = std::count(rows_to_keep.begin(), rows_to_keep.end(), true);
+  const std::size_t num_cols_to_keep = std::count(cols_to_keep.begin(), cols_to_keep.end(), true);
+  const std::size_t num_val_elements = data->get_num_valid_data_kept(rows_to_keep, cols_to_keep);
+
+  if (PRINT_SUMMARY) {
+    std::lock_guard<std::mutex> lock(print_mtx);
+    noMissSummary::summarize_results(*data, na_symbol, name, run_time, num_rows_to_keep, num_cols_to_keep, rows_to_keep, cols_to_keep);
+  }
+  if (WRITE_STATS) {
+    noMissSummary::write_stats_to_file(name + "_summary.csv", data_file, cpu_time, run_time, num_val_elements, num_rows_to_keep, num_cols_to_keep);
+  }
+
+  std::lock_guard<std::mutex> lock(mtx);
+  if (num_val_elements > best_num_elements) {
+    best_rows = rows_to_keep;
+    best_cols = cols_to_keep;
+    best_num_elements = num_val_elements;
+  }
+  if (store != nullptr) {
+    store->offer(rows_to_keep, cols_to_keep, name);
+  }
+}
+
+void NoMissPipeline::run_greedy(const std::size_t threads) {
+  Timer timer(true);
+  AddRowGreedy greedy(*data);
+  greedy.solve(GREEDY_STARTS, threads);
+  timer.stop();
+  record("AddRowGreedy", timer.elapsed_cpu_time(), timer.elapsed_wall_time(), greedy.get_rows_to_keep(), greedy.get_cols_to_keep());
+}
+
+void NoMissPipeline::run_rowcol(const std::size_t threads) {
+  Timer timer(true);
+  RowColLpSolver rc_solver(*data, *presolve, ROWCOL_FORMULATION);
+  rc_solver.set_num_threads(threads);
+  rc_solver.solve();
+  timer.stop();
+
+  // The rounded solution only covers the rows and columns left by the presolve
+  std::vector<bool> rows_to_keep = rc_solver.get_rows_to_keep(), cols_to_keep = rc_solver.get_cols_to_keep();
+  presolve->restore_incumbent(rows_to_keep, cols_to_keep);
+  record("RowColLp", timer.elapsed_cpu_time(), timer.elapsed_wall_time(), rows_to_keep, cols_to_keep);
+}
+
+//------------------------------------------------------------------------------
+// Counts the pair tables in memory, as calcPairs would, and runs the row_sum
+// sweep of elementIpThreaded from the best solution so far, with 'threads'
+// threads.
+//------------------------------------------------------------------------------
+void NoMissPipeline::run_element(const std::size_t threads) {
+  Timer timer(true);
+  std::vector<std::size_t> row_weights, col_weights;
+  for (auto &members : presolve->get_row_classes()) {
+    row_weights.push_back(members.size());
+  }
+  for (auto &members : presolve->get_col_classes()) {
+    col_weights.push_back(members.size());
+  }
+
+  Pairs row_pairs, col_pairs;
+  {
+    CalcPairsCore core(*data, "", presolve->get_forced_one_rows().size(), presolve->get_forced_one_cols().size(),
+                       presolve->get_free_rows(), presolve->get_free_cols(), row_weights, col_weights, PAIRS_PER_CHUNK, false);
+    core.count(true, ElementProblemData::get_max_thresholds(*data, true, presolve->get_free_rows()), threads, row_pairs);
+    core.count(false, ElementProblemData::get_max_thresholds(*data, false, presolve->get_free_cols()), threads, col_pairs);
+  }
+
+  ElementProblemData problem(presolve->get_forced_one_rows(), presolve->get_forced_one_cols(),
+                             presolve->get_free_rows(), presolve->get_free_cols(),
+                             presolve->get_row_classes(), presolve->get_col_classes(),
+                             presolve->get_row_dominance(), presolve->get_col_dominance(),
+                             row_pairs, col_pairs);
+  std::unique_lock<std::mutex> lock(mtx);
+  const CleanSolution incumbent(best_rows, best_cols);
+  lock.unlock();
+
+  ElementThreadedSolver solver(*data, problem, incumbent, threads, MAX_CPLEX_THREADS,
+                               FORMULATION, HEURISTIC_TIME_LIMIT, prefix + "Element.sol");
+  if (WRITE_STATS) {
+    solver.open_task_log(prefix + "ElementIp_tasks.csv");
+  }
+  if (store != nullptr) {
+    solver.set_incumbent_store(*store);
+  }
+  solver.work();
+  timer.stop();
+  fprintf(stderr, "%s: screened %lu row_sum values, pruned %lu and solved %lu\n",
+          data_file.c_str(), solver.get_num_screened(), solver.get_num_pruned(), solver.get_num_solved());
+  solver.print_utilization();
+  if (WRITE_STATS) {
+    solver.write_utilization(prefix + "ElementIp_workers.csv");
+  }
+
+  const std::vector<int> rows_to_keep = solver.get_rows_to_keep(), cols_to_keep = solver.get_cols_to_keep();
+  record("ElementIp",
+         timer.elapsed_cpu_time(),
+         timer.elapsed_wall_time(),
+         std::vector<bool>(rows_to_keep.begin(), rows_to_keep.end()),
+         std::vector<bool>(cols_to_keep.begin(), cols_to_keep.end()));
+}
@@ -0,0 +1,84 @@
+#ifndef NO_MISS_PIPELINE_H
+#define NO_MISS_PIPELINE_H
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "BinContainer.h"
+#include "ConfigParser.h"
+#include "Formulation.h"
+#include "IncumbentStore.h"
+#include "Presolve.h"
+
+// Cleaning pipeline of one matrix in a single process, as run by nomiss and
+// nomissBatch. The matrix is parsed and presolved once, and the stages pass the
+// presolve result, the pair tables and the best solution found so far to each
+// other in memory. Files the pipeline writes for the matrix alone, such as the
+// element incumbent, are named with 'prefix' so that several pipelines can run
+// in the same directory at once. With PORTFOLIO set, the greedy and rowcol
+// stages run alongside the element stage and publish their solutions to it
+// through an IncumbentStore.
+class NoMissPipeline
+{
+public:
+  enum Stage {GREEDY, ROWCOL, ELEMENT, WRITE, NUM_STAGES};
+
+private:
+  const std::string data_file;
+  const std::string na_symbol;
+  const std::size_t num_header_rows;
+  const std::size_t num_header_cols;
+  const std::size_t num_threads;
+  const std::string prefix;
+
+  const bool PRINT_SUMMARY;
+  const bool WRITE_STATS;
+  const Formulation::Type FORMULATION;
+  const Formulation::Type ROWCOL_FORMULATION;
+  const std::size_t MAX_CPLEX_THREADS;
+  const std::size_t GREEDY_STARTS;
+  const double HEURISTIC_TIME_LIMIT;
+  const bool PRESOLVE;
+  const std::size_t PAIRS_PER_CHUNK;
+  const bool PORTFOLIO;
+
+  std::unique_ptr<BinContainer> data;
+  std::unique_ptr<Presolve> presolve;
+
+  // Best solution of the stages so far, shared by the stages of a portfolio
+  std::mutex mtx;
+  std::vector<bool> best_rows;
+  std::vector<bool> best_cols;
+  std::size_t best_num_elements;
+  IncumbentStore *store;
+
+  void record(const std::string &name,
+              const double cpu_time,
+              const double run_time,
+              const std::vector<bool> &rows_to_keep,
+              const std::vector<bool> &cols_to_keep);
+  void run_greedy(const std::size_t threads);
+  void run_rowcol(const std::size_t threads);
+  void run_element(const std::size_t threads);
+
+public:
+  NoMissPipeline(const ConfigParser &parser,
+                 const std::string &_data_file,
+                 const std::string &_na_symbol,
+                 const std::size_t _num_header_rows,
+                 const std::size_t _num_header_cols,
+                 const std::size_t _num_threads,
+                 const std::string &_prefix = "");
+  ~NoMissPipeline();
+
+  void parse();
+  void solve(const std::vector<bool> &run_stage);
+  void write();
+
+  std::size_t get_num_elements() const;
+
+  static std::vector<bool> parse_stages(const std::string &list);
+};
+
+#endif
@@ -1,4 +1,5 @@
 #include "NoMissSummary.h"
+#include "PhaseTimer.h"
 #include <assert.h>
 
 //------------------------------------------------------------------------------
@@ -7,13 +8,13 @@
 void noMissSummary::summarize_results(const BinContainer &data,
                                       const std::string &na_symbol,
                                       const std::string &alg_name,
-                                      const double elapsed_cpu_time,
+                                      const double wall_time,
                                       const std::size_t num_rows_kept,
                                       const std::size_t num_cols_kept,
                                       const std::vector<bool> rows_to_keep,
                                       const std::vector<bool> cols_to_keep) {
   fprintf(stderr, "Summary of %s\n", alg_name.c_str());
-  fprintf(stderr, "\tTook %lf seconds\n", elapsed_cpu_time);
+  fprintf(stderr, "\tTook %lf seconds\n", wall_time);
   fprintf(stderr, "\tNum rows after cleaning: %lu\n", num_rows_kept);
   fprintf(stderr, "\tNum cols after cleaning: %lu\n", num_cols_kept);
   fprintf(stderr, "\tNumber of valid elements after cleaning: %lu\n", data.get_num_valid_data_kept(rows_to_keep, cols_to_keep));
@@ -26,13 +27,13 @@ void noMissSummary::summarize_results(const BinContainer &data,
 void noMissSummary::summarize_results(const BinContainer &data,
                                       const std::string &na_symbol,
                                       const std::string &alg_name,
-                                      const double elapsed_cpu_time,
+                                      const double wall_time,
                                       const std::size_t num_rows_kept,
                                       const std::size_t num_cols_kept,
                                       const std::vector<int> rows_to_keep,
                                       const std::vector<int> cols_to_keep) {
   fprintf(stderr, "Summary of %s\n", alg_name.c_str());
-  fprintf(stderr, "\tTook %lf seconds\n", elapsed_cpu_time);
+  fprintf(stderr, "\tTook %lf seconds\n", wall_time);
   fprintf(stderr, "\tNum rows after cleaning: %lu\n", num_rows_kept);
   fprintf(stderr, "\tNum cols after cleaning: %lu\n", num_cols_kept);
   fprintf(stderr, "\tNumber of valid elements after cleaning: %lu\n", data.get_num_valid_data_kept(rows_to_keep, cols_to_keep));
@@ -40,11 +41,13 @@ void noMissSummary::summarize_results(const BinContainer &data,
 }
 
 //------------------------------------------------------------------------------
-// Write the statistics to a file
+// Write the statistics to a file: the data file, CPU and wall seconds, and
+// the number of valid elements, rows and columns kept
 //------------------------------------------------------------------------------
 void noMissSummary::write_stats_to_file(const std::string &file_name,
                                         const std::string &data_file,
-                                        const double time,
+                                        const double cpu_time,
+                                        const double wall_time,
                                         const std::size_t num_valid_element,
                                         const std::size_t num_rows_kept,
                                         const std::size_t num_cols_kept) {
@@ -55,7 +58,7 @@ void noMissSummary::write_stats_to_file(const std::string &file_name,
     exit(EXIT_FAILURE);
   }
 
-  fprintf(summary, "%s,%lf,%lf,%lu,%lu,%lu\n", data_file.c_str(), time, 0.0, num_valid_element, num_rows_kept, num_cols_kept);
+  fprintf(summary, "%s,%lf,%lf,%lu,%lu,%lu\n", data_file.c_str(), cpu_time, wall_time, num_valid_element, num_rows_kept, num_cols_kept);
 
   fclose(summary);
 }
@@ -66,6 +69,7 @@ void noMissSummary::write_stats_to_file(const std::string &file_name,
 void noMissSummary::write_solution_to_file(const std::string &file_name,
                                            const std::vector<bool> &rows_to_keep,
                                            const std::vector<bool> &cols_to_keep) {
+  PhaseTimer write_timer("write");
   assert(rows_to_keep.size() > 0);
   assert(cols_to_keep.size() > 0);
 
@@ -92,6 +96,7 @@ void noMissSummary::write_solution_to_file(const std::string &file_name,
 void noMissSummary::write_solution_to_file(const std::string &file_name,
                                            const std::vector<int> &rows_to_keep,
                                            const std::vector<int> &cols_to_keep) {
+  PhaseTimer write_timer("write");
   assert(rows_to_keep.size() > 0);
   assert(cols_to_keep.size() > 0);
 
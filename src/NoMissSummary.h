@@ -9,7 +9,7 @@ namespace noMissSummary {
   void summarize_results(const BinContainer &data,
                          const std::string &na_symbol,
                          const std::string &alg_name,
-                         const double elapsed_cpu_time,
+                         const double wall_time,
                          const std::size_t num_rows_kept,
                          const std::size_t num_cols_kept,
                          const std::vector<bool> rows_to_keep,
@@ -18,7 +18,7 @@ namespace noMissSummary {
   void summarize_results(const BinContainer &data,
                          const std::string &na_symbol,
                          const std::string &alg_name,
-                         const double elapsed_cpu_time,
+                         const double wall_time,
                          const std::size_t num_rows_kept,
                          const std::size_t num_cols_kept,
                          const std::vector<int> rows_to_keep,
@@ -26,7 +26,8 @@ namespace noMissSummary {
 
   void write_stats_to_file(const std::string &file_name,
                            const std::string &data_file,
-                           const double time,
+                           const double cpu_time,
+                           const double wall_time,
                            const std::size_t num_valid_element,
                            const std::size_t num_rows_kept,
                            const std::size_t num_cols_kept);
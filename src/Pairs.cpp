@@ -17,28 +17,26 @@ Pairs::~Pairs()
 }
 
 void Pairs::clearValues() {
-  for (auto v : values) {
-    v.clear();
-  }
-  values.clear();
+  partners.clear();
+  runs.clear();
 }
 
 void Pairs::set_size(const std::size_t _size) {
   size = _size;
 }
 
-void Pairs::read(const std::string &filename) {
-  assert(size > 0);
-  
+//------------------------------------------------------------------------------
+// Reads the upper-triangular pair file, where line 'idx' holds the counts of
+// (idx, idx+1), (idx, idx+2), ..., and builds the conflict list of every
+// index. See begin() for '_maxThresholds'.
+//------------------------------------------------------------------------------
+void Pairs::read(const std::string &filename, const std::vector<unsigned int> &_maxThresholds) {
   std::string tmpStr, s;
 	std::istringstream iss;
 	std::ifstream input;
 
-  clearValues();
-  std::vector<unsigned int> valuesRow;
-  for (std::size_t i = 0; i < size; ++i) {
-    values.push_back(valuesRow);
-  }
+  begin(_maxThresholds);
+  std::vector<std::size_t> count;
 
 	// Open the file
 	input.open(filename.c_str());
@@ -53,123 +51,162 @@ void Pairs::read(const std::string &filename) {
   while (std::getline(input, tmpStr)) {
     // Count number of comas
     std::size_t numPairs = std::count(tmpStr.begin(), tmpStr.end(), ',') + 1;
+    const unsigned int idx = size - numPairs;
     // Clear and update istringstream
     iss.clear();
     iss.str(tmpStr);
 
+    count.clear();
     while (std::getline(iss, s, ',')) {
-      values[size-numPairs].push_back(std::stoi(s));
+      count.push_back(std::stoi(s));
     }
+    add_line(idx, count);
   }
 
   input.close();
-}
 
-void Pairs::print() {
-  for (auto vec : values) {
-    for (auto v : vec) {
-      fprintf(stderr, "%u ", v);
-    }
-    fprintf(stderr, "\n");
-  }
+  finish();
 }
 
-std::vector<std::size_t> Pairs::getPairsGteThresh(const std::size_t idx, const unsigned int threshold) const {
-  assert(idx < values.size());
-  std::vector<std::size_t> pairs;
+//------------------------------------------------------------------------------
+// Starts building the table from its lines, which are then passed to
+// add_line() in any order. When 'maxThresholds' is given, a query about 'idx'
+// never uses a threshold above maxThresholds[idx], and both indices of a
+// queried pair are below theirs, so a pair whose count reaches the smaller of
+// the two can never be below a threshold and is not stored.
+//------------------------------------------------------------------------------
+void Pairs::begin(const std::vector<unsigned int> &_maxThresholds) {
+  assert(size > 0);
+  assert(_maxThresholds.empty() || _maxThresholds.size() == size + 1);
 
-  for (std::size_t i = 0; i < idx; ++i) {
-    if (values[i][idx-i-1] >= threshold) {
-      pairs.push_back(i);
+  clearValues();
+  conflicts.assign(size + 1, std::vector<std::pair<unsigned int, unsigned int>>());
+  maxThresholds = _maxThresholds;
+}
+
+//------------------------------------------------------------------------------
+// Adds line 'idx' of the table, the counts of (idx, idx+1), (idx, idx+2), ...
+//------------------------------------------------------------------------------
+void Pairs::add_line(const std::size_t idx, const std::vector<std::size_t> &count) {
+  assert(idx + count.size() == size);
+
+  unsigned int partner = idx + 1;
+  for (auto c : count) {
+    if (maxThresholds.empty() || c < std::min(maxThresholds[idx], maxThresholds[partner])) {
+      conflicts[idx].push_back(std::make_pair(c, partner));
+      conflicts[partner].push_back(std::make_pair(c, idx));
     }
+    ++partner;
   }
+}
 
-  for (std::size_t j = 0; j < values[idx].size(); ++j) {
-    if (values[idx][j] >= threshold) {
-      pairs.push_back(idx + 1 + j);
+//------------------------------------------------------------------------------
+// Sorts the conflict list of every index once all lines have been added.
+//------------------------------------------------------------------------------
+void Pairs::finish() {
+  partners.resize(size + 1);
+  runs.resize(size + 1);
+  for (std::size_t idx = 0; idx <= size; ++idx) {
+    std::sort(conflicts[idx].begin(), conflicts[idx].end());
+    partners[idx].reserve(conflicts[idx].size());
+    for (auto &c : conflicts[idx]) {
+      if (runs[idx].empty() || runs[idx].back().first != c.first) {
+        runs[idx].push_back(std::make_pair(c.first, partners[idx].size()));
+      }
+      partners[idx].push_back(c.second);
     }
+    std::vector<std::pair<unsigned int, unsigned int>>().swap(conflicts[idx]);
   }
-  return pairs;
+  conflicts.clear();
+  maxThresholds.clear();
 }
 
-std::vector<std::size_t> Pairs::getPairsLtThresh(const std::size_t idx, const unsigned int threshold) const {
-  assert(idx < values.size());
-  std::vector<std::size_t> pairs;
+void Pairs::swap(Pairs &other) {
+  std::swap(size, other.size);
+  partners.swap(other.partners);
+  runs.swap(other.runs);
+}
 
-  for (std::size_t i = 0; i < idx; ++i) {
-    if (values[i][idx-i-1] < threshold) {
-      pairs.push_back(i);
+void Pairs::print() {
+  for (std::size_t idx = 0; idx < partners.size(); ++idx) {
+    for (std::size_t r = 0; r < runs[idx].size(); ++r) {
+      const std::size_t end = (r + 1 < runs[idx].size() ? runs[idx][r + 1].second : partners[idx].size());
+      fprintf(stderr, "%u:", runs[idx][r].first);
+      for (std::size_t k = runs[idx][r].second; k < end; ++k) {
+        fprintf(stderr, " %u", partners[idx][k]);
+      }
+      fprintf(stderr, "; ");
     }
+    fprintf(stderr, "\n");
   }
+}
 
-  for (std::size_t j = 0; j < values[idx].size(); ++j) {
-    if (values[idx][j] < threshold) {
-      pairs.push_back(idx + 1 + j);
-    }
+// Number of stored (count, partner) entries over all indices
+std::size_t Pairs::getNumStored() const {
+  std::size_t num_stored = 0;
+  for (auto &p : partners) {
+    num_stored += p.size();
   }
-  return pairs;
+  return num_stored;
 }
 
-std::vector<std::size_t> Pairs::getPairsLtThresh(const std::size_t idx, const unsigned int threshold, const std::vector<bool> valid) const {
-  assert(idx < values.size());
-  
-  std::vector<std::size_t> pairs;
+// Number of partners of 'idx' with a count below 'threshold', which are the
+// first ones in its conflict list
+std::size_t Pairs::numBelow(const std::size_t idx, const unsigned int threshold) const {
+  assert(idx < partners.size());
+  auto run = std::lower_bound(runs[idx].begin(), runs[idx].end(), std::make_pair(threshold, 0u));
+  return (run == runs[idx].end() ? partners[idx].size() : run->second);
+}
 
-  for (std::size_t i = 0; i < idx; ++i) {
-    if (valid[i] && values[i][idx-i-1] < threshold) {
-      pairs.push_back(i);
-    }
+std::vector<std::size_t> Pairs::getPairsGteThresh(const std::size_t idx, const unsigned int threshold) const {
+  const std::size_t end = numBelow(idx, threshold);
+  std::vector<bool> below(size + 1, false);
+  for (std::size_t k = 0; k < end; ++k) {
+    below[partners[idx][k]] = true;
   }
 
-  if (idx < values.size()) {
-    for (std::size_t j = 0; j < values[idx].size(); ++j) {
-      if (valid[idx+1+j] && values[idx][j] < threshold) {
-        pairs.push_back(idx + 1 + j);
-      }
+  std::vector<std::size_t> pairs;
+  for (std::size_t i = 0; i <= size; ++i) {
+    if (i != idx && !below[i]) {
+      pairs.push_back(i);
     }
   }
   return pairs;
 }
 
-std::vector<std::size_t> Pairs::getPairsLtThresh(const std::size_t idx, const unsigned int threshold, const std::vector<int> valid) const {
-    assert(idx < values.size());
-  
-  std::vector<std::size_t> pairs;
+std::vector<std::size_t> Pairs::getPairsLtThresh(const std::size_t idx, const unsigned int threshold) const {
+  const std::size_t end = numBelow(idx, threshold);
+  std::vector<std::size_t> pairs(partners[idx].begin(), partners[idx].begin() + end);
+  std::sort(pairs.begin(), pairs.end());
+  return pairs;
+}
 
-  for (std::size_t i = 0; i < idx; ++i) {
-    if (valid[i] && values[i][idx-i-1] < threshold) {
-      pairs.push_back(i);
+std::vector<std::size_t> Pairs::getPairsLtThresh(const std::size_t idx, const unsigned int threshold, const std::vector<bool> valid) const {
+  const std::size_t end = numBelow(idx, threshold);
+  std::vector<std::size_t> pairs;
+  for (std::size_t k = 0; k < end; ++k) {
+    if (valid[partners[idx][k]]) {
+      pairs.push_back(partners[idx][k]);
     }
   }
+  std::sort(pairs.begin(), pairs.end());
+  return pairs;
+}
 
-  if (idx < values.size()) {
-    for (std::size_t j = 0; j < values[idx].size(); ++j) {
-      if (valid[idx+1+j] && values[idx][j] < threshold) {
-        pairs.push_back(idx + 1 + j);
-      }
+std::vector<std::size_t> Pairs::getPairsLtThresh(const std::size_t idx, const unsigned int threshold, const std::vector<int> valid) const {
+  const std::size_t end = numBelow(idx, threshold);
+  std::vector<std::size_t> pairs;
+  for (std::size_t k = 0; k < end; ++k) {
+    if (valid[partners[idx][k]]) {
+      pairs.push_back(partners[idx][k]);
     }
   }
+  std::sort(pairs.begin(), pairs.end());
   return pairs;
 }
 
 std::size_t Pairs::getNumPairsGteThresh(const std::size_t idx, const unsigned int threshold) const {
-  assert(idx < values.size());
-  std::size_t count = 0;
-
-  for (std::size_t i = 0; i < idx; ++i) {
-    if (values[i][idx-i-1] >= threshold) {
-      ++count;
-    }
-  }
-
-  if (idx < values.size()) {
-    for (std::size_t j = 0; j < values[idx].size(); ++j) {
-      if (values[idx][j] >= threshold) {
-        ++count;
-      }
-    }
-  }
-  return count;
+  return size - numBelow(idx, threshold);
 }
 
 std::size_t Pairs::getNumPairsGteThresh(const std::size_t idx, const unsigned int threshold, const std::vector<bool> valid) const {  
@@ -179,22 +216,11 @@ std::size_t Pairs::getNumPairsGteThresh(const std::size_t idx, const unsigned in
     return 0;
   }
 
-  std::size_t count = 0;
-
-  for (std::size_t i = 0; i < idx; ++i) {
-    if (valid[i] && values[i][idx-i-1] >= threshold) {
-      ++count;
-    }
-  }
-
-  if (idx < values.size()) {
-    for (std::size_t j = 0; j < values[idx].size(); ++j) {
-      if (valid[idx + 1 + j] && values[idx][j] >= threshold) {
-        ++count;
-      }
-    }
+  std::size_t count = std::count(valid.begin(), valid.end(), true) - 1;
+  const std::size_t end = numBelow(idx, threshold);
+  for (std::size_t k = 0; k < end; ++k) {
+    count -= valid[partners[idx][k]];
   }
-  
   return count;
 }
 
@@ -205,67 +231,49 @@ std::size_t Pairs::getNumPairsGteThresh(const std::size_t idx, const unsigned in
     return 0;
   }
 
-  std::size_t count = 0;
-
-  for (std::size_t i = 0; i < idx; ++i) {
-    if (valid[i] && values[i][idx-i-1] >= threshold) {
-      ++count;
-    }
+  std::size_t count = valid.size() - std::count(valid.begin(), valid.end(), 0) - 1;
+  const std::size_t end = numBelow(idx, threshold);
+  for (std::size_t k = 0; k < end; ++k) {
+    count -= (valid[partners[idx][k]] != 0);
   }
+  return count;
+}
 
-  if (idx < values.size()) {
-    for (std::size_t j = 0; j < values[idx].size(); ++j) {
-      if (valid[idx + 1 + j] && values[idx][j] >= threshold) {
-        ++count;
-      }
+// Same as above, but every valid pair counts 'weights' of the other index
+std::size_t Pairs::getNumPairsGteThresh(const std::size_t idx,
+                                        const unsigned int threshold,
+                                        const std::vector<int> &valid,
+                                        const std::vector<std::size_t> &weights) const {
+  assert(idx < valid.size() && valid.size() == weights.size());
+
+  std::size_t valid_weight = 0;
+  for (std::size_t i = 0; i < valid.size(); ++i) {
+    if (valid[i]) {
+      valid_weight += weights[i];
     }
   }
-  
-  return count;
+  return getNumPairsGteThresh(idx, threshold, valid, weights, valid_weight);
 }
 
+// Same as above, with the total weight of the valid indices, 'validWeight',
+// supplied by the caller. Only the partners below the threshold are visited.
+std::size_t Pairs::getNumPairsGteThresh(const std::size_t idx,
+                                        const unsigned int threshold,
+                                        const std::vector<int> &valid,
+                                        const std::vector<std::size_t> &weights,
+                                        const std::size_t validWeight) const {
+  assert(idx < valid.size() && valid.size() == weights.size());
 
-void Pairs::recalculateValues(const bool rowCol,
-                              const std::vector<std::size_t> &freeDim1,
-                              const std::vector<std::size_t> &freeDim2,
-                              const std::vector<bool> &validDim2,
-                              const std::size_t numDim2ForcedToOne,
-                              const BinContainer &data) {
-  assert(size == freeDim1.size() - 1);
-  assert(freeDim2.size() == validDim2.size());
-
-  // fprintf(stderr, "Size: %lu - New Size: %lu\n", size, freeDim1.size() - 1);
-  // fprintf(stderr, "Dim2 size: %lu - Dim2 valid size: %lu\n", freeDim2.size(), validDim2.size());
-
-
-  if (rowCol) {
-    for (std::size_t localI1 = 0; localI1 < freeDim1.size()-1; ++localI1) {
-      const std::size_t i1 = freeDim1[localI1];
-
-      // fprintf(stderr, "pairRow row size: %lu\n", values[localI1].size());
-      // fprintf(stderr, "pairs to check in row: %lu\n", freeDim1.size()-1 - localI1);
-
-      for (std::size_t localI2 = 0; localI2 < values[localI1].size(); ++localI2) {
-        const std::size_t i2 = freeDim1[localI1 + 1 + localI2];
-
-        values[localI1][localI2] = numDim2ForcedToOne;
-
-        for (std::size_t localJ = 0; localJ < freeDim2.size(); ++localJ) {
-          if (!validDim2[localJ]) continue;
-
-          std::size_t j = freeDim2[localJ];
-
-          if (!data.is_data_na(i1, j) && !data.is_data_na(i2, j)) {
-            ++values[localI1][localI2];
-          }
-        }
+  if (!valid[idx]) {
+    return 0;
+  }
 
-        // fprintf(stderr, "Count (%lu, %lu): %u\n", i1, i2, values[localI1][localI2]);
-      }
+  std::size_t count = validWeight - weights[idx];
+  const std::size_t end = numBelow(idx, threshold);
+  for (std::size_t k = 0; k < end; ++k) {
+    if (valid[partners[idx][k]]) {
+      count -= weights[partners[idx][k]];
     }
-  } else {
-    fprintf(stderr, "Not implmented for cols\n");
-    exit(1);
   }
-  
-}
\ No newline at end of file
+  return count;
+}
@@ -5,13 +5,28 @@
 #include <string>
 #include "BinContainer.h"
 
+// Pair counts read from the upper-triangular files written by calcPairs and
+// stored as conflict lists: for every index, its partners sorted by count,
+// split into runs of equal count. The queries only ask whether a count is
+// below a threshold, so they binary search the runs and read a contiguous
+// slice instead of scanning every partner.
 class Pairs
 {
 private:
   std::size_t size;
-  std::vector<std::vector<unsigned int>> values;
+
+  // partners[idx] is sorted by count, and runs[idx] holds the count and the
+  // first position in partners[idx] of every run of equal counts
+  std::vector<std::vector<unsigned int>> partners;
+  std::vector<std::vector<std::pair<unsigned int, unsigned int>>> runs;
+
+  // (count, partner) entries of every index while the table is being built,
+  // and the thresholds that decide which ones are stored
+  std::vector<std::vector<std::pair<unsigned int, unsigned int>>> conflicts;
+  std::vector<unsigned int> maxThresholds;
 
   void clearValues();
+  std::size_t numBelow(const std::size_t idx, const unsigned int threshold) const;
 
 public:
   Pairs();
@@ -19,15 +34,14 @@ public:
   ~Pairs();
 
   void set_size(const std::size_t _size);
-  void read(const std::string &filename);
+  void read(const std::string &filename, const std::vector<unsigned int> &_maxThresholds = std::vector<unsigned int>());
+  void begin(const std::vector<unsigned int> &_maxThresholds = std::vector<unsigned int>());
+  void add_line(const std::size_t idx, const std::vector<std::size_t> &count);
+  void finish();
+  void swap(Pairs &other);
   void print();
 
-  void recalculateValues(const bool rowCol,
-                         const std::vector<std::size_t> &freeDim1,
-                         const std::vector<std::size_t> &freeDim2,
-                         const std::vector<bool> &validDim2,
-                         const std::size_t numDim2ForcedToOne,
-                         const BinContainer &data);
+  std::size_t getNumStored() const;
 
   std::vector<std::size_t> getPairsGteThresh(const std::size_t idx, const unsigned int threshold) const;
   std::vector<std::size_t> getPairsLtThresh(const std::size_t idx, const unsigned int threshold) const;
@@ -37,7 +51,16 @@ public:
   std::size_t getNumPairsGteThresh(const std::size_t idx, const unsigned int threshold) const;
   std::size_t getNumPairsGteThresh(const std::size_t idx, const unsigned int threshold, const std::vector<bool> valid) const;
   std::size_t getNumPairsGteThresh(const std::size_t idx, const unsigned int threshold, const std::vector<int> valid) const;
-  
+  std::size_t getNumPairsGteThresh(const std::size_t idx,
+                                   const unsigned int threshold,
+                                   const std::vector<int> &valid,
+                                   const std::vector<std::size_t> &weights) const;
+  std::size_t getNumPairsGteThresh(const std::size_t idx,
+                                   const unsigned int threshold,
+                                   const std::vector<int> &valid,
+                                   const std::vector<std::size_t> &weights,
+                                   const std::size_t validWeight) const;
+
 };
 
-#endif
\ No newline at end of file
+#endif
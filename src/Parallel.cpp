@@ -1,4 +1,45 @@
 #include "Parallel.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+namespace {
+  // Message counters of this rank, per peer rank
+  enum Counter {
+    SENT,
+    BYTES_SENT,
+    RECEIVED,
+    BYTES_RECEIVED,
+    SEND_TIME,
+    RECV_TIME,
+    PROBE_TIME,
+    QUEUE_TIME,
+    NUM_COUNTERS
+  };
+
+  std::vector<double> counters;
+  std::vector<double> queued_since;
+
+  // Sized on first use, once MPI has been initialized
+  void init_counters() {
+    if (counters.empty()) {
+      counters.assign(Parallel::get_world_size() * NUM_COUNTERS, 0.0);
+      queued_since.assign(Parallel::get_world_size(), -1.0);
+    }
+  }
+
+  double& counter(const int peer, const Counter c) {
+    init_counters();
+    return counters[peer * NUM_COUNTERS + c];
+  }
+
+  double num_bytes(const int count, MPI_Datatype type) {
+    int size;
+    MPI_Type_size(type, &size);
+    return static_cast<double>(count) * size;
+  }
+}
 
 //------------------------------------------------------------------------------
 // Returns the world_rank
@@ -21,3 +62,245 @@ int Parallel::get_world_size()
   return world_size;
 }
 
+
+//------------------------------------------------------------------------------
+// Returns, for every rank, the lowest world_rank sharing its node. Ranks with
+// the same value are co-located and compete for the same cores. Must be called
+// by all ranks.
+//------------------------------------------------------------------------------
+std::vector<int> Parallel::get_node_ids()
+{
+  MPI_Comm node_comm;
+  MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &node_comm);
+
+  int world_rank = get_world_rank();
+  int node_id;
+  MPI_Allreduce(&world_rank, &node_id, 1, MPI_INT, MPI_MIN, node_comm);
+  MPI_Comm_free(&node_comm);
+
+  std::vector<int> node_ids(get_world_size());
+  MPI_Allgather(&node_id, 1, MPI_INT, &node_ids[0], 1, MPI_INT, MPI_COMM_WORLD);
+  return node_ids;
+}
+
+
+//------------------------------------------------------------------------------
+// Waits for a message from 'source' without busy polling, so that an idle rank
+// leaves its core to the CPLEX threads of a co-located rank.
+//------------------------------------------------------------------------------
+void Parallel::wait_for_message(const int source, MPI_Status &status)
+{
+  const double start = MPI_Wtime();
+  int flag = 0;
+  while (true) {
+    MPI_Iprobe(source, MPI_ANY_TAG, MPI_COMM_WORLD, &flag, &status);
+    if (flag) {
+      counter(status.MPI_SOURCE, PROBE_TIME) += MPI_Wtime() - start;
+      return;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(IDLE_WAIT));
+  }
+}
+
+
+//------------------------------------------------------------------------------
+// Sends 'count' elements of 'type' to 'dest' with MPI_Send.
+//------------------------------------------------------------------------------
+void Parallel::send(const void *buf, const int count, MPI_Datatype type, const int dest, const int tag)
+{
+  const double start = MPI_Wtime();
+  MPI_Send(buf, count, type, dest, tag, MPI_COMM_WORLD);
+  counter(dest, SEND_TIME) += MPI_Wtime() - start;
+  counter(dest, SENT) += 1;
+  counter(dest, BYTES_SENT) += num_bytes(count, type);
+}
+
+
+//------------------------------------------------------------------------------
+// Sends 'count' elements of 'type' to 'dest' with MPI_Ssend, which blocks until
+// 'dest' has started receiving.
+//------------------------------------------------------------------------------
+void Parallel::ssend(const void *buf, const int count, MPI_Datatype type, const int dest, const int tag)
+{
+  const double start = MPI_Wtime();
+  MPI_Ssend(buf, count, type, dest, tag, MPI_COMM_WORLD);
+  counter(dest, SEND_TIME) += MPI_Wtime() - start;
+  counter(dest, SENT) += 1;
+  counter(dest, BYTES_SENT) += num_bytes(count, type);
+}
+
+
+//------------------------------------------------------------------------------
+// Receives 'count' elements of 'type' from 'source', which may be
+// MPI_ANY_SOURCE. The message is counted against the rank that sent it.
+//------------------------------------------------------------------------------
+void Parallel::recv(void *buf, const int count, MPI_Datatype type, const int source, const int tag, MPI_Status *status)
+{
+  MPI_Status local_status;
+  if (status == MPI_STATUS_IGNORE) {
+    status = &local_status;
+  }
+
+  const double start = MPI_Wtime();
+  MPI_Recv(buf, count, type, source, tag, MPI_COMM_WORLD, status);
+  counter(status->MPI_SOURCE, RECV_TIME) += MPI_Wtime() - start;
+
+  int received;
+  MPI_Get_count(status, type, &received);
+  counter(status->MPI_SOURCE, RECEIVED) += 1;
+  counter(status->MPI_SOURCE, BYTES_RECEIVED) += num_bytes(received, type);
+}
+
+
+//------------------------------------------------------------------------------
+// Blocks until a message from 'source', which may be MPI_ANY_SOURCE, can be
+// received.
+//------------------------------------------------------------------------------
+void Parallel::probe(const int source, MPI_Status &status)
+{
+  const double start = MPI_Wtime();
+  MPI_Probe(source, MPI_ANY_TAG, MPI_COMM_WORLD, &status);
+  counter(status.MPI_SOURCE, PROBE_TIME) += MPI_Wtime() - start;
+}
+
+
+//------------------------------------------------------------------------------
+// Reads the files 'file_names' on rank 0 and broadcasts their contents, so that
+// a small file every rank needs is read from the shared file system once
+// rather than once per rank. Returns the contents of every file by its name.
+// Must be called by all ranks.
+//------------------------------------------------------------------------------
+std::map<std::string, std::string> Parallel::broadcast_files(const std::vector<std::string> &file_names)
+{
+  std::vector<std::size_t> sizes(file_names.size(), 0);
+  std::string buffer;
+  if (get_world_rank() == 0) {
+    for (std::size_t i = 0; i < file_names.size(); ++i) {
+      FILE *input;
+      if ((input = fopen(file_names[i].c_str(), "rb")) == nullptr) {
+        fprintf(stderr, "ERROR - Could not open file %s\n", file_names[i].c_str());
+        exit(1);
+      }
+      char block[4096];
+      std::size_t num_read;
+      while ((num_read = fread(block, 1, sizeof(block), input)) > 0) {
+        buffer.append(block, num_read);
+        sizes[i] += num_read;
+      }
+      fclose(input);
+    }
+    if (buffer.size() > INT_MAX) {
+      fprintf(stderr, "ERROR - Files to broadcast hold more than %d bytes\n", INT_MAX);
+      exit(1);
+    }
+  }
+
+  MPI_Bcast(sizes.data(), sizes.size(), CUSTOM_SIZE_T, 0, MPI_COMM_WORLD);
+  std::size_t total = 0;
+  for (auto size : sizes) {
+    total += size;
+  }
+  buffer.resize(total);
+  if (total > 0) {
+    MPI_Bcast(&buffer[0], total, MPI_CHAR, 0, MPI_COMM_WORLD);
+  }
+
+  std::map<std::string, std::string> files;
+  std::size_t offset = 0;
+  for (std::size_t i = 0; i < file_names.size(); ++i) {
+    files[file_names[i]] = buffer.substr(offset, sizes[i]);
+    offset += sizes[i];
+  }
+  return files;
+}
+
+
+//------------------------------------------------------------------------------
+// Marks 'worker' as waiting in the queue of available workers.
+//------------------------------------------------------------------------------
+void Parallel::enqueue(const int worker)
+{
+  init_counters();
+  queued_since[worker] = MPI_Wtime();
+}
+
+
+//------------------------------------------------------------------------------
+// Adds the time since 'worker' was queued to its queue wait.
+//------------------------------------------------------------------------------
+void Parallel::dequeue(const int worker)
+{
+  init_counters();
+  if (queued_since[worker] >= 0.0) {
+    counter(worker, QUEUE_TIME) += MPI_Wtime() - queued_since[worker];
+    queued_since[worker] = -1.0;
+  }
+}
+
+
+//------------------------------------------------------------------------------
+// Gathers the counters of every rank on rank 0, which prints the totals of the
+// controller and of the workers and, unless 'file_name' is empty, appends a
+// line per pair of ranks that exchanged messages to it: data_file,rank,peer,
+// sent,bytes_sent,received,bytes_received,send_time,recv_time,probe_time,
+// queue_time. Must be called by all ranks, just before MPI_Finalize.
+//------------------------------------------------------------------------------
+void Parallel::report(const std::string &file_name, const std::string &data_file)
+{
+  const int world_rank = get_world_rank();
+  const int world_size = get_world_size();
+  init_counters();
+
+  std::vector<double> all;
+  if (world_rank == 0) {
+    all.resize(counters.size() * world_size);
+  }
+  MPI_Gather(&counters[0], counters.size(), MPI_DOUBLE,
+             world_rank == 0 ? &all[0] : nullptr, counters.size(), MPI_DOUBLE, 0, MPI_COMM_WORLD);
+
+  if (world_rank != 0) {
+    return;
+  }
+
+  // Totals of the controller (rank 0) and of all workers
+  double totals[2][NUM_COUNTERS] = {};
+  for (int rank = 0; rank < world_size; ++rank) {
+    for (int peer = 0; peer < world_size; ++peer) {
+      for (int c = 0; c < NUM_COUNTERS; ++c) {
+        totals[rank == 0 ? 0 : 1][c] += all[(rank * world_size + peer) * NUM_COUNTERS + c];
+      }
+    }
+  }
+
+  fprintf(stderr, "MPI messages\n");
+  const char *names[2] = {"Controller", "Workers"};
+  for (int i = 0; i < 2; ++i) {
+    fprintf(stderr, "\t%s: sent %.0lf (%.0lf bytes), received %.0lf (%.0lf bytes), blocked %lf s in send, %lf s in recv, %lf s in probe\n",
+            names[i], totals[i][SENT], totals[i][BYTES_SENT], totals[i][RECEIVED], totals[i][BYTES_RECEIVED],
+            totals[i][SEND_TIME], totals[i][RECV_TIME], totals[i][PROBE_TIME]);
+  }
+  fprintf(stderr, "\tWorkers waited %lf s in the controller's queue\n\n", totals[0][QUEUE_TIME]);
+
+  if (file_name.empty()) {
+    return;
+  }
+
+  FILE *output;
+  if ((output = fopen(file_name.c_str(), "a+")) == nullptr) {
+    fprintf(stderr, "ERROR - Could not open file (%s)\n", file_name.c_str());
+    exit(1);
+  }
+
+  for (int rank = 0; rank < world_size; ++rank) {
+    for (int peer = 0; peer < world_size; ++peer) {
+      const double *c = &all[(rank * world_size + peer) * NUM_COUNTERS];
+      if (c[SENT] == 0 && c[RECEIVED] == 0 && c[PROBE_TIME] == 0 && c[QUEUE_TIME] == 0) {
+        continue;
+      }
+      fprintf(output, "%s,%d,%d,%.0lf,%.0lf,%.0lf,%.0lf,%lf,%lf,%lf,%lf\n", data_file.c_str(), rank, peer,
+              c[SENT], c[BYTES_SENT], c[RECEIVED], c[BYTES_RECEIVED], c[SEND_TIME], c[RECV_TIME], c[PROBE_TIME], c[QUEUE_TIME]);
+    }
+  }
+
+  fclose(output);
+}
@@ -2,9 +2,12 @@
 #define PARALLEL_H
 
 #include <limits.h>
+#include <map>
 //#include <mpi.h>
 #include </cluster/spack-2022/opt/spack/linux-centos7-x86_64/gcc-9.3.0/openmpi-4.1.1-udg7sdl3kjslokkcsrmuzz5kn6krohpa/include/mpi.h>
 #include <stdint.h>
+#include <string>
+#include <vector>
 
 // https://stackoverflow.com/a/40808411
 #if SIZE_MAX == UCHAR_MAX
@@ -26,9 +29,34 @@ namespace Parallel
 {
   const int SPARSE_TAG = 0;
   const int CONVERGE_TAG = 1;
+  const int CHUNK_TAG = 2;
+
+  // Chunk requested by rank 0 to tell a rank that every chunk was combined
+  const std::size_t END_OF_CHUNKS = SIZE_MAX;
+
+  // Microseconds an idle rank sleeps between polls for a message
+  const int IDLE_WAIT = 1000;
 
   int get_world_rank();
   int get_world_size();
+  std::vector<int> get_node_ids();
+  void wait_for_message(const int source, MPI_Status &status);
+
+  // Point-to-point messaging used by the controllers and workers. Every call
+  // is counted, with its bytes and the time it blocked, against the peer rank.
+  void send(const void *buf, const int count, MPI_Datatype type, const int dest, const int tag);
+  void ssend(const void *buf, const int count, MPI_Datatype type, const int dest, const int tag);
+  void recv(void *buf, const int count, MPI_Datatype type, const int source, const int tag, MPI_Status *status = MPI_STATUS_IGNORE);
+  void probe(const int source, MPI_Status &status);
+
+  // Small files read by rank 0 alone and broadcast to every rank, keyed by name
+  std::map<std::string, std::string> broadcast_files(const std::vector<std::string> &file_names);
+
+  // Time a worker spends in the controller's queue of available workers
+  void enqueue(const int worker);
+  void dequeue(const int worker);
+
+  void report(const std::string &file_name, const std::string &data_file);
 }
 
 
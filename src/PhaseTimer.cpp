@@ -0,0 +1,85 @@
+#include "PhaseTimer.h"
+#include <cstdlib>
+#include <map>
+#include <mutex>
+
+namespace {
+  struct PhaseTotals {
+    std::size_t calls;
+    double wall_time;
+    double cpu_time;
+  };
+
+  std::mutex registry_mtx;
+  std::map<std::string, PhaseTotals> registry;
+}
+
+//------------------------------------------------------------------------------
+// Constructor. Starts timing 'phase'.
+//------------------------------------------------------------------------------
+PhaseTimer::PhaseTimer(const std::string &_phase) : phase(_phase),
+                                                    timer(true),
+                                                    stopped(false)
+{}
+
+//------------------------------------------------------------------------------
+// Destructor. Records the phase if stop() was not called.
+//------------------------------------------------------------------------------
+PhaseTimer::~PhaseTimer() {
+  stop();
+}
+
+//------------------------------------------------------------------------------
+// Stops timing and adds the time since construction to the phase. Only the
+// first call records anything. Returns the wall seconds of the phase.
+//------------------------------------------------------------------------------
+double PhaseTimer::stop() {
+  if (!stopped) {
+    timer.stop();
+    stopped = true;
+    add(phase, timer.elapsed_wall_time(), timer.elapsed_cpu_time());
+  }
+  return timer.elapsed_wall_time();
+}
+
+//------------------------------------------------------------------------------
+// Adds one call taking 'wall_time' and 'cpu_time' seconds to 'phase'. Used
+// directly for phases timed in pieces.
+//------------------------------------------------------------------------------
+void PhaseTimer::add(const std::string &phase, const double wall_time, const double cpu_time) {
+  std::lock_guard<std::mutex> lock(registry_mtx);
+  PhaseTotals &totals = registry[phase];
+  ++totals.calls;
+  totals.wall_time += wall_time;
+  totals.cpu_time += cpu_time;
+}
+
+//------------------------------------------------------------------------------
+// Appends a line per phase recorded by this process to 'file_name':
+// data_file,rank,phase,calls,wall_time,cpu_time. The lines of a process are
+// written in one go, so every MPI rank can append to the same file.
+//------------------------------------------------------------------------------
+void PhaseTimer::write_to_file(const std::string &file_name, const std::string &data_file, const int rank) {
+  std::string lines;
+  {
+    std::lock_guard<std::mutex> lock(registry_mtx);
+    char buffer[64];
+    for (auto &entry : registry) {
+      snprintf(buffer, sizeof(buffer), ",%lu,%lf,%lf\n", entry.second.calls, entry.second.wall_time, entry.second.cpu_time);
+      lines += data_file + "," + std::to_string(rank) + "," + entry.first + buffer;
+    }
+  }
+
+  if (lines.empty()) {
+    return;
+  }
+
+  FILE *output;
+  if ((output = fopen(file_name.c_str(), "a+")) == nullptr) {
+    fprintf(stderr, "Could not open file (%s)", file_name.c_str());
+    exit(EXIT_FAILURE);
+  }
+
+  fputs(lines.c_str(), output);
+  fclose(output);
+}
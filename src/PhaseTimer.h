@@ -0,0 +1,30 @@
+#ifndef PHASE_TIMER_H
+#define PHASE_TIMER_H
+
+#include <cstdio>
+#include <string>
+#include "Timer.h"
+
+// Times a named phase of a run from construction until stop() or destruction
+// and adds it to a registry of the wall time, CPU time and number of calls of
+// every phase, summed over the process. The registry is shared by all threads.
+// CPU time is the process' clock(), so phases running in several threads at
+// once each count the CPU time of all of them.
+class PhaseTimer
+{
+private:
+  const std::string phase;
+  Timer timer;
+  bool stopped;
+
+public:
+  PhaseTimer(const std::string &_phase);
+  ~PhaseTimer();
+
+  double stop();
+
+  static void add(const std::string &phase, const double wall_time, const double cpu_time);
+  static void write_to_file(const std::string &file_name, const std::string &data_file, const int rank = 0);
+};
+
+#endif
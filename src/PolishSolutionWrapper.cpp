@@ -0,0 +1,77 @@
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include "BinContainer.h"
+#include "CleanSolution.h"
+#include "SolutionPolisher.h"
+#include "Timer.h"
+#include "PhaseTimer.h"
+#include "ConfigParser.h"
+#include "NoMissSummary.h"
+
+int main(int argc, char *argv[]) {
+
+// Check user input
+  if (!((argc == 4) || (argc == 6))) {
+    fprintf(stderr, "Usage: %s <data_file> <na_symbol> <sol_file> (opt)<num_header_rows> (opt)<num_header_cols>\n", argv[0]);
+    exit(1);
+  }
+  std::string data_file(argv[1]);
+  std::string na_symbol(argv[2]);
+  std::string sol_file(argv[3]);
+  std::size_t num_header_rows = 1;
+  std::size_t num_header_cols = 1;
+
+  if (argc == 6) {
+    num_header_rows = std::stoul(argv[4]);
+    num_header_cols = std::stoul(argv[5]);
+  }
+
+  ConfigParser parser("config.cfg");
+  const bool PRINT_SUMMARY = parser.getBool("PRINT_SUMMARY");
+  const bool WRITE_STATS = parser.getBool("WRITE_STATS");
+  const double POLISH_TIME_LIMIT = parser.getDouble("POLISH_TIME_LIMIT");
+  const std::size_t POLISH_MAX_MOVES = parser.getSizeT("POLISH_MAX_MOVES");
+
+  Timer timer;
+
+  // Read in data and the solution to polish
+  BinContainer data(data_file, na_symbol, num_header_rows, num_header_cols);
+  CleanSolution sol(data.get_num_data_rows(), data.get_num_data_cols());
+  sol.read_from_file(sol_file);
+
+  const std::vector<int> sol_rows = sol.get_rows_to_keep(), sol_cols = sol.get_cols_to_keep();
+  std::vector<bool> rows_to_keep(sol_rows.begin(), sol_rows.end()), cols_to_keep(sol_cols.begin(), sol_cols.end());
+
+  SolutionPolisher polisher(data, POLISH_TIME_LIMIT, POLISH_MAX_MOVES);
+  timer.start();
+  polisher.polish(rows_to_keep, cols_to_keep);
+  timer.stop();
+  fprintf(stderr, "Polished %s from %lu to %lu elements (%lu of %lu moves accepted)\n", sol_file.c_str(),
+          polisher.get_initial_num_elements(), polisher.get_best_num_elements(), polisher.get_num_accepted(), polisher.get_num_moves());
+
+  rows_to_keep = polisher.get_rows_to_keep();
+  cols_to_keep = polisher.get_cols_to_keep();
+  const std::size_t num_rows_to_keep = polisher.get_num_rows_to_keep();
+  const std::size_t num_cols_to_keep = polisher.get_num_cols_to_keep();
+  const double run_time = timer.elapsed_wall_time();
+  const std::size_t num_val_elements = data.get_num_valid_data_kept(rows_to_keep, cols_to_keep);
+
+  // Record results
+  if (PRINT_SUMMARY) {
+    noMissSummary::summarize_results(data, na_symbol, "PolishSolution", run_time, num_rows_to_keep, num_cols_to_keep, rows_to_keep, cols_to_keep);
+  }
+
+  // Wrtie statistics to file
+  if (WRITE_STATS) {
+    noMissSummary::write_stats_to_file("PolishSolution_summary.csv", data_file, timer.elapsed_cpu_time(), run_time, num_val_elements, num_rows_to_keep, num_cols_to_keep);
+  }
+
+  noMissSummary::write_solution_to_file("Polished.sol", rows_to_keep, cols_to_keep);
+
+  if (WRITE_STATS) {
+    PhaseTimer::write_to_file("PolishSolution_phases.csv", data_file);
+  }
+
+  return 0;
+}
@@ -0,0 +1,389 @@
+#include "Presolve.h"
+#include <algorithm>
+#include <unordered_map>
+#include "AddRowGreedy.h"
+#include "NoMissSummary.h"
+#include "PhaseTimer.h"
+#include "Utils.h"
+
+//------------------------------------------------------------------------------
+// Constructor. Until run() is called the rows and columns with no missing data
+// are forced to one and every other row and column is free.
+//------------------------------------------------------------------------------
+Presolve::Presolve(const BinContainer &_data) : data(&_data),
+                                                num_rows(data->get_num_data_rows()),
+                                                num_cols(data->get_num_data_cols()),
+                                                row_alive(num_rows, true),
+                                                col_alive(num_cols, true),
+                                                incumbent_num_elements(0),
+                                                incumbent_rows(num_rows, false),
+                                                incumbent_cols(num_cols, false) {
+  split_forced_free();
+}
+
+//------------------------------------------------------------------------------
+// Destructor.
+//------------------------------------------------------------------------------
+Presolve::~Presolve() {}
+
+//------------------------------------------------------------------------------
+// Returns a bitset with the bit of every alive row (column) set.
+//------------------------------------------------------------------------------
+std::vector<std::uint64_t> Presolve::alive_mask(const std::vector<bool> &alive) const {
+  std::vector<std::uint64_t> mask((alive.size() + BinContainer::BITS_PER_WORD - 1) / BinContainer::BITS_PER_WORD, 0);
+  for (std::size_t k = 0; k < alive.size(); ++k) {
+    if (alive[k]) {
+      mask[k / BinContainer::BITS_PER_WORD] |= std::uint64_t(1) << (k % BinContainer::BITS_PER_WORD);
+    }
+  }
+  return mask;
+}
+
+//------------------------------------------------------------------------------
+// Drops every row that cannot be part of a solution better than the incumbent.
+// A solution keeping row i keeps at most the v alive columns valid in i, and
+// no more rows than the largest number of alive rows valid in one of those
+// columns, so row i is dropped when that product cannot beat the incumbent.
+// Columns are dropped the same way. Returns true if anything was dropped.
+//------------------------------------------------------------------------------
+bool Presolve::drop_unpromising() {
+  const std::vector<std::uint64_t> row_mask = alive_mask(row_alive);
+  const std::vector<std::uint64_t> col_mask = alive_mask(col_alive);
+
+  std::vector<std::size_t> valid_in_row(num_rows, 0);
+  std::vector<std::size_t> valid_in_col(num_cols, 0);
+  std::vector<std::uint64_t> bits;
+  for (std::size_t i = 0; i < num_rows; ++i) {
+    if (row_alive[i]) {
+      bits = data->get_row_bits(i);
+      valid_in_row[i] = utils::and_count_bits(bits, col_mask);
+    }
+  }
+  for (std::size_t j = 0; j < num_cols; ++j) {
+    if (col_alive[j]) {
+      bits = data->get_col_bits(j);
+      valid_in_col[j] = utils::and_count_bits(bits, row_mask);
+    }
+  }
+
+  bool dropped = false;
+  for (std::size_t i = 0; i < num_rows; ++i) {
+    if (!row_alive[i]) continue;
+
+    std::size_t max_rows = 0;
+    bits = data->get_row_bits(i);
+    utils::and_count_bits(bits, col_mask);
+    utils::for_each_set_bit(bits, [&](const std::size_t j) { max_rows = std::max(max_rows, valid_in_col[j]); });
+    if (valid_in_row[i] * max_rows <= incumbent_num_elements) {
+      row_alive[i] = false;
+      dropped = true;
+    }
+  }
+  for (std::size_t j = 0; j < num_cols; ++j) {
+    if (!col_alive[j]) continue;
+
+    std::size_t max_cols = 0;
+    bits = data->get_col_bits(j);
+    utils::and_count_bits(bits, row_mask);
+    utils::for_each_set_bit(bits, [&](const std::size_t i) { max_cols = std::max(max_cols, valid_in_row[i]); });
+    if (valid_in_col[j] * max_cols <= incumbent_num_elements) {
+      col_alive[j] = false;
+      dropped = true;
+    }
+  }
+
+  return dropped;
+}
+
+//------------------------------------------------------------------------------
+// Forces to one every alive row (column) that is valid in every alive column
+// (row), and makes the other alive rows (columns) free.
+//------------------------------------------------------------------------------
+void Presolve::split_forced_free() {
+  const std::vector<std::uint64_t> row_mask = alive_mask(row_alive);
+  const std::vector<std::uint64_t> col_mask = alive_mask(col_alive);
+  const std::size_t num_alive_rows = utils::count_bits(row_mask);
+  const std::size_t num_alive_cols = utils::count_bits(col_mask);
+
+  forced_one_rows.clear();
+  forced_one_cols.clear();
+  free_rows.clear();
+  free_cols.clear();
+
+  std::vector<std::uint64_t> bits;
+  for (std::size_t i = 0; i < num_rows; ++i) {
+    if (!row_alive[i]) continue;
+    bits = data->get_row_bits(i);
+    if (utils::and_count_bits(bits, col_mask) == num_alive_cols) {
+      forced_one_rows.push_back(i);
+    } else {
+      free_rows.push_back(i);
+    }
+  }
+  for (std::size_t j = 0; j < num_cols; ++j) {
+    if (!col_alive[j]) continue;
+    bits = data->get_col_bits(j);
+    if (utils::and_count_bits(bits, row_mask) == num_alive_rows) {
+      forced_one_cols.push_back(j);
+    } else {
+      free_cols.push_back(j);
+    }
+  }
+
+  row_classes.clear();
+  col_classes.clear();
+  for (auto i : free_rows) {
+    row_classes.push_back(std::vector<std::size_t>(1, i));
+  }
+  for (auto j : free_cols) {
+    col_classes.push_back(std::vector<std::size_t>(1, j));
+  }
+}
+
+//------------------------------------------------------------------------------
+// Returns the missing pattern of every line in 'lines', restricted to the
+// alive columns (rows) in 'mask'.
+//------------------------------------------------------------------------------
+std::vector<std::vector<std::uint64_t>> Presolve::missing_patterns(const bool is_row,
+                                                                   const std::vector<std::size_t> &lines,
+                                                                   const std::vector<std::uint64_t> &mask) const {
+  std::vector<std::vector<std::uint64_t>> missing(lines.size(), std::vector<std::uint64_t>(mask.size()));
+  for (std::size_t k = 0; k < lines.size(); ++k) {
+    const std::vector<std::uint64_t> &bits = is_row ? data->get_row_bits(lines[k]) : data->get_col_bits(lines[k]);
+    for (std::size_t w = 0; w < mask.size(); ++w) {
+      missing[k][w] = ~bits[w] & mask[w];
+    }
+  }
+  return missing;
+}
+
+//------------------------------------------------------------------------------
+// Groups the free rows (columns) with the same missing pattern, restricted to
+// the alive columns (rows) in 'mask', by hashing. Lines of a class are
+// interchangeable, so 'lines' is reduced to the first line of every class and
+// 'classes' gets the lines of each class, head first.
+//------------------------------------------------------------------------------
+void Presolve::collapse_duplicates(const bool is_row,
+                                   const std::vector<std::uint64_t> &mask,
+                                   std::vector<std::size_t> &lines,
+                                   std::vector<std::vector<std::size_t>> &classes) const {
+  const std::vector<std::vector<std::uint64_t>> missing = missing_patterns(is_row, lines, mask);
+  std::unordered_map<std::uint64_t, std::vector<std::size_t>> buckets;
+  std::vector<std::size_t> heads;
+  classes.clear();
+
+  for (std::size_t k = 0; k < lines.size(); ++k) {
+    std::uint64_t hash = 0;
+    for (auto word : missing[k]) {
+      hash ^= word + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+    }
+
+    bool duplicate = false;
+    for (auto c : buckets[hash]) {
+      if (missing[heads[c]] == missing[k]) {
+        classes[c].push_back(lines[k]);
+        duplicate = true;
+        break;
+      }
+    }
+    if (!duplicate) {
+      buckets[hash].push_back(heads.size());
+      heads.push_back(k);
+      classes.push_back(std::vector<std::size_t>(1, lines[k]));
+    }
+  }
+
+  for (std::size_t c = 0; c < heads.size(); ++c) {
+    lines[c] = lines[heads[c]];
+  }
+  lines.resize(heads.size());
+}
+
+//------------------------------------------------------------------------------
+// Finds the free rows (columns) whose missing set, restricted to the alive
+// columns (rows) in 'mask', contains the missing set of another one. Keeping
+// the other one instead never loses a column, so the dominated line may only
+// be kept along with it. The lines must have distinct patterns, and each is
+// paired with the largest pattern that is a strict subset of it.
+//------------------------------------------------------------------------------
+void Presolve::find_dominance(const bool is_row,
+                              const std::vector<std::size_t> &lines,
+                              const std::vector<std::uint64_t> &mask,
+                              std::vector<std::pair<std::size_t, std::size_t>> &dominance) const {
+  dominance.clear();
+
+  const std::vector<std::vector<std::uint64_t>> missing = missing_patterns(is_row, lines, mask);
+  std::vector<std::size_t> num_missing(lines.size(), 0);
+  std::vector<std::size_t> order(lines.size());
+  for (std::size_t k = 0; k < lines.size(); ++k) {
+    num_missing[k] = utils::count_bits(missing[k]);
+    order[k] = k;
+  }
+  std::stable_sort(order.begin(), order.end(), [&num_missing](const std::size_t lhs, const std::size_t rhs) {
+    return num_missing[lhs] < num_missing[rhs];
+  });
+
+  for (std::size_t p = order.size(); p-- > 0;) {
+    const std::size_t a = order[p];
+    for (std::size_t q = p; q-- > 0;) {
+      const std::size_t b = order[q];
+      if (num_missing[b] == num_missing[a]) continue;
+
+      bool subset = true;
+      for (std::size_t w = 0; w < mask.size() && subset; ++w) {
+        subset = (missing[b][w] & ~missing[a][w]) == 0;
+      }
+      if (subset) {
+        dominance.push_back(std::make_pair(lines[a], lines[b]));
+        break;
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Finds an incumbent with the row-add greedy, drops the rows and columns that
+// cannot beat it until no more are dropped, splits the rest into forced and
+// free, collapses the free rows and columns with identical patterns and finds
+// the dominance pairs among what is left.
+//------------------------------------------------------------------------------
+void Presolve::run() {
+  PhaseTimer presolve_timer("presolve");
+  AddRowGreedy greedy(*data);
+  greedy.solve();
+  incumbent_rows = greedy.get_rows_to_keep();
+  incumbent_cols = greedy.get_cols_to_keep();
+  incumbent_num_elements = greedy.get_num_elements_to_keep();
+
+  while (drop_unpromising()) {}
+  split_forced_free();
+
+  const std::size_t num_free_rows = free_rows.size();
+  const std::size_t num_free_cols = free_cols.size();
+  collapse_duplicates(true, alive_mask(col_alive), free_rows, row_classes);
+  collapse_duplicates(false, alive_mask(row_alive), free_cols, col_classes);
+
+  find_dominance(true, free_rows, alive_mask(col_alive), row_dominance);
+  find_dominance(false, free_cols, alive_mask(row_alive), col_dominance);
+
+  fprintf(stderr, "Presolve incumbent: %lu\n", incumbent_num_elements);
+  fprintf(stderr, "Presolve kept %lu forced and %lu free of %lu rows, and %lu forced and %lu free of %lu columns\n",
+          forced_one_rows.size(), num_free_rows, num_rows, forced_one_cols.size(), num_free_cols, num_cols);
+  fprintf(stderr, "Presolve collapsed the free rows into %lu and the free columns into %lu classes\n", free_rows.size(), free_cols.size());
+  fprintf(stderr, "Presolve found %lu row and %lu column dominance pairs\n", row_dominance.size(), col_dominance.size());
+}
+
+FILE* Presolve::open_file(const std::string &file_name) const {
+  FILE* out;
+  if ((out = fopen(file_name.c_str(), "w")) == nullptr) {
+    fprintf(stderr, "ERROR - Could not open file %s\n", file_name.c_str());
+    exit(1);
+  }
+  return out;
+}
+
+void Presolve::write_index_file(const std::string &file_name, const std::vector<std::size_t> &indices) const {
+  FILE* out = open_file(file_name);
+  for (auto idx : indices) {
+    fprintf(out, "%lu\n", idx);
+  }
+  fclose(out);
+}
+
+// Writes every non-head member of a class followed by its head.
+void Presolve::write_class_file(const std::string &file_name, const std::vector<std::vector<std::size_t>> &classes) const {
+  FILE* out = open_file(file_name);
+  for (auto &members : classes) {
+    for (std::size_t k = 1; k < members.size(); ++k) {
+      fprintf(out, "%lu %lu\n", members[k], members[0]);
+    }
+  }
+  fclose(out);
+}
+
+void Presolve::write_pair_file(const std::string &file_name, const std::vector<std::pair<std::size_t, std::size_t>> &pairs) const {
+  FILE* out = open_file(file_name);
+  for (auto &p : pairs) {
+    fprintf(out, "%lu %lu\n", p.first, p.second);
+  }
+  fclose(out);
+}
+
+//------------------------------------------------------------------------------
+// Writes the forced and free rows and columns, the duplicates of the free rows
+// and columns, the dominance pairs and the incumbent to the scratch directory.
+// Rows and columns in none of the files were dropped, so a solver reading them
+// must start from the incumbent.
+//------------------------------------------------------------------------------
+void Presolve::write(const std::string &scratch_dir) const {
+  write_index_file(scratch_dir + "freeRows.txt", free_rows);
+  write_index_file(scratch_dir + "forcedOneRows.txt", forced_one_rows);
+  write_index_file(scratch_dir + "freeCols.txt", free_cols);
+  write_index_file(scratch_dir + "forcedOneCols.txt", forced_one_cols);
+  write_class_file(scratch_dir + "rowDuplicates.txt", row_classes);
+  write_class_file(scratch_dir + "colDuplicates.txt", col_classes);
+  write_pair_file(scratch_dir + "rowDominance.txt", row_dominance);
+  write_pair_file(scratch_dir + "colDominance.txt", col_dominance);
+
+  const std::string sol_file = scratch_dir + "Presolve.sol";
+  if (incumbent_num_elements > 0) {
+    noMissSummary::write_solution_to_file(sol_file, incumbent_rows, incumbent_cols);
+  } else {
+    remove(sol_file.c_str());
+  }
+}
+
+//------------------------------------------------------------------------------
+// Replaces the solution with the incumbent if the incumbent is better, since a
+// solver that only saw the remaining rows and columns can return less.
+//------------------------------------------------------------------------------
+void Presolve::restore_incumbent(std::vector<bool> &rows_to_keep, std::vector<bool> &cols_to_keep) const {
+  if (data->get_num_valid_data_kept(rows_to_keep, cols_to_keep) < incumbent_num_elements) {
+    rows_to_keep = incumbent_rows;
+    cols_to_keep = incumbent_cols;
+  }
+}
+
+bool Presolve::is_row_dropped(const std::size_t row) const {
+  return !row_alive[row];
+}
+
+bool Presolve::is_col_dropped(const std::size_t col) const {
+  return !col_alive[col];
+}
+
+const std::vector<std::size_t>& Presolve::get_forced_one_rows() const {
+  return forced_one_rows;
+}
+
+const std::vector<std::size_t>& Presolve::get_forced_one_cols() const {
+  return forced_one_cols;
+}
+
+const std::vector<std::size_t>& Presolve::get_free_rows() const {
+  return free_rows;
+}
+
+const std::vector<std::size_t>& Presolve::get_free_cols() const {
+  return free_cols;
+}
+
+const std::vector<std::vector<std::size_t>>& Presolve::get_row_classes() const {
+  return row_classes;
+}
+
+const std::vector<std::vector<std::size_t>>& Presolve::get_col_classes() const {
+  return col_classes;
+}
+
+const std::vector<std::pair<std::size_t, std::size_t>>& Presolve::get_row_dominance() const {
+  return row_dominance;
+}
+
+const std::vector<std::pair<std::size_t, std::size_t>>& Presolve::get_col_dominance() const {
+  return col_dominance;
+}
+
+std::size_t Presolve::get_incumbent_num_elements() const {
+  return incumbent_num_elements;
+}
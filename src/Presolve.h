@@ -0,0 +1,83 @@
+#ifndef PRESOLVE_H
+#define PRESOLVE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+#include "BinContainer.h"
+
+class Presolve
+{
+private:
+  const BinContainer *data;
+  const std::size_t num_rows;
+  const std::size_t num_cols;
+
+  // Rows and columns that may still be part of a solution better than the
+  // incumbent
+  std::vector<bool> row_alive;
+  std::vector<bool> col_alive;
+
+  std::vector<std::size_t> forced_one_rows;
+  std::vector<std::size_t> forced_one_cols;
+  std::vector<std::size_t> free_rows;
+  std::vector<std::size_t> free_cols;
+
+  // Rows (columns) with the same missing pattern as a free row (column), head
+  // first. Only the head of every class is in the free list.
+  std::vector<std::vector<std::size_t>> row_classes;
+  std::vector<std::vector<std::size_t>> col_classes;
+
+  // Pairs (a, b) of free rows (columns) for which some optimal solution keeps b
+  // whenever it keeps a
+  std::vector<std::pair<std::size_t, std::size_t>> row_dominance;
+  std::vector<std::pair<std::size_t, std::size_t>> col_dominance;
+
+  std::size_t incumbent_num_elements;
+  std::vector<bool> incumbent_rows;
+  std::vector<bool> incumbent_cols;
+
+  std::vector<std::uint64_t> alive_mask(const std::vector<bool> &alive) const;
+  bool drop_unpromising();
+  void split_forced_free();
+  std::vector<std::vector<std::uint64_t>> missing_patterns(const bool is_row,
+                                                           const std::vector<std::size_t> &lines,
+                                                           const std::vector<std::uint64_t> &mask) const;
+  void collapse_duplicates(const bool is_row,
+                           const std::vector<std::uint64_t> &mask,
+                           std::vector<std::size_t> &lines,
+                           std::vector<std::vector<std::size_t>> &classes) const;
+  void find_dominance(const bool is_row,
+                      const std::vector<std::size_t> &lines,
+                      const std::vector<std::uint64_t> &mask,
+                      std::vector<std::pair<std::size_t, std::size_t>> &dominance) const;
+
+  FILE* open_file(const std::string &file_name) const;
+  void write_index_file(const std::string &file_name, const std::vector<std::size_t> &indices) const;
+  void write_pair_file(const std::string &file_name, const std::vector<std::pair<std::size_t, std::size_t>> &pairs) const;
+  void write_class_file(const std::string &file_name, const std::vector<std::vector<std::size_t>> &classes) const;
+
+public:
+  Presolve(const BinContainer &_data);
+  ~Presolve();
+
+  void run();
+  void write(const std::string &scratch_dir) const;
+  void restore_incumbent(std::vector<bool> &rows_to_keep, std::vector<bool> &cols_to_keep) const;
+
+  bool is_row_dropped(const std::size_t row) const;
+  bool is_col_dropped(const std::size_t col) const;
+  const std::vector<std::size_t>& get_forced_one_rows() const;
+  const std::vector<std::size_t>& get_forced_one_cols() const;
+  const std::vector<std::size_t>& get_free_rows() const;
+  const std::vector<std::size_t>& get_free_cols() const;
+  const std::vector<std::vector<std::size_t>>& get_row_classes() const;
+  const std::vector<std::vector<std::size_t>>& get_col_classes() const;
+  const std::vector<std::pair<std::size_t, std::size_t>>& get_row_dominance() const;
+  const std::vector<std::pair<std::size_t, std::size_t>>& get_col_dominance() const;
+  std::size_t get_incumbent_num_elements() const;
+};
+
+#endif
@@ -1,13 +1,22 @@
 #include "RowColLpSolver.h"
+#include "PhaseTimer.h"
 
 //------------------------------------------------------------------------------
 // Constructor.
 //------------------------------------------------------------------------------
 RowColLpSolver::RowColLpSolver(const BinContainer &_data,
+                               const Presolve &_presolve,
+                               const Formulation::Type _formulation,
                                const double _TOL) : data(&_data),
+                                                    presolve(&_presolve),
                                                     num_rows(data->get_num_data_rows()),
                                                     num_cols(data->get_num_data_cols()),
+                                                    formulation(_formulation != Formulation::AUTO ? _formulation :
+                                                                Formulation::select(Formulation::count_na(_data,
+                                                                                                          _presolve.get_free_rows(),
+                                                                                                          _presolve.get_free_cols()))),
                                                     TOL(_TOL),
+                                                    num_threads(1),
                                                     r_var(num_rows),
                                                     c_var(num_cols),
                                                     obj_value(0.0),
@@ -20,6 +29,7 @@ RowColLpSolver::RowColLpSolver(const BinContainer &_data,
                                                     c_copy(IloNumArray(env, num_cols)),
                                                     obj(IloExpr(env))
 {
+  PhaseTimer build_timer("model_build");
   r.setNames("r");
   c.setNames("c");
   build_model();
@@ -31,36 +41,123 @@ RowColLpSolver::RowColLpSolver(const BinContainer &_data,
 RowColLpSolver::~RowColLpSolver() {}
 
 //------------------------------------------------------------------------------
-// Builds the CPLEX model based on the BinContainer object.
+// Builds the CPLEX model based on the BinContainer object. Rows and columns
+// dropped by the presolve are fixed to 0 and forced ones to 1, so only the free
+// rows and columns get missing-data constraints, and every dominated row
+// (column) is kept only with the row (column) dominating it. Rows (columns)
+// with identical patterns share the variable of their class head, whose
+// objective coefficient is the sum over the class, and the other members are
+// fixed to 0 in the model. The aggregated formulations have a weaker LP
+// relaxation than the per-element one, so they can change the rounded
+// solution.
 //------------------------------------------------------------------------------
 void RowColLpSolver::build_model() {
+  const std::vector<std::size_t> &free_rows = presolve->get_free_rows();
+  const std::vector<std::size_t> &free_cols = presolve->get_free_cols();
+
+  std::vector<IloNum> row_coef(num_rows, 0);
+  std::vector<IloNum> col_coef(num_cols, 0);
+  for (std::size_t i = 0; i < num_rows; ++i) {
+    if (presolve->is_row_dropped(i)) {
+      r[i].setBounds(0, 0);
+    } else {
+      row_coef[i] = static_cast<IloNum>(data->get_num_valid_in_row(i));
+    }
+  }
+  for (std::size_t j = 0; j < num_cols; ++j) {
+    if (presolve->is_col_dropped(j)) {
+      c[j].setBounds(0, 0);
+    } else {
+      col_coef[j] = static_cast<IloNum>(data->get_num_valid_in_col(j));
+    }
+  }
+  for (auto &members : presolve->get_row_classes()) {
+    for (std::size_t k = 1; k < members.size(); ++k) {
+      row_coef[members[0]] += row_coef[members[k]];
+      row_coef[members[k]] = 0;
+      r[members[k]].setBounds(0, 0);
+    }
+  }
+  for (auto &members : presolve->get_col_classes()) {
+    for (std::size_t k = 1; k < members.size(); ++k) {
+      col_coef[members[0]] += col_coef[members[k]];
+      col_coef[members[k]] = 0;
+      c[members[k]].setBounds(0, 0);
+    }
+  }
   for (std::size_t i = 0; i < num_rows; ++i) {
-    obj += static_cast<IloNum>(data->get_num_valid_in_row(i)) * r[i];
+    if (row_coef[i] > 0) {
+      obj += row_coef[i] * r[i];
+    }
   }
   for (std::size_t j = 0; j < num_cols; ++j) {
-    obj += static_cast<IloNum>(data->get_num_valid_in_col(j)) * c[j];
+    if (col_coef[j] > 0) {
+      obj += col_coef[j] * c[j];
+    }
+  }
+  for (auto i : presolve->get_forced_one_rows()) {
+    r[i].setBounds(1, 1);
+  }
+  for (auto j : presolve->get_forced_one_cols()) {
+    c[j].setBounds(1, 1);
   }
   model.add(IloMaximize(env, obj, "Objective"));
 
-  for (std::size_t i = 0; i < num_rows; ++i) {
+  // Missing-data constraints only visit the missing elements of free lines
+  std::vector<bool> is_free_row(num_rows, false);
+  std::vector<bool> is_free_col(num_cols, false);
+  for (auto i : free_rows) {
+    is_free_row[i] = true;
+  }
+  for (auto j : free_cols) {
+    is_free_col[j] = true;
+  }
 
-    for (std::size_t j = 0; j < num_cols; ++j) {
-      if (data->is_data_na(i,j)) {
-        model.add(r[i] + c[j] <= 1);
+  if (formulation == Formulation::ROW_AGGREGATED) {
+    for (auto i : free_rows) {
+      std::size_t num_excluded = 0;
+      IloExpr col_sum_expr(env);
+      data->for_each_na_in_row(i, [&](const std::size_t j) {
+        if (is_free_col[j]) {
+          col_sum_expr += c[j];
+          ++num_excluded;
+        }
+      });
+      if (num_excluded > 0) {
+        model.add(static_cast<IloNum>(num_excluded) * r[i] + col_sum_expr <= static_cast<IloNum>(num_excluded));
       }
+      col_sum_expr.end();
     }
-    // std::size_t num_excluded = 0;
-    // IloExpr col_sum_expr(env);
-    // for (std::size_t j = 0; j < num_cols; ++j) {
-    //   if (data->is_data_na(i,j)) {
-    //     col_sum_expr += c[j];
-    //     ++num_excluded;
-    //   }
-    // }
-    // if (num_excluded > 0) {
-    //   model.add(static_cast<IloNum>(num_excluded) * r[i] + col_sum_expr <= static_cast<IloNum>(num_excluded));
-    // }
-    // col_sum_expr.end();
+  } else if (formulation == Formulation::COL_AGGREGATED) {
+    for (auto j : free_cols) {
+      std::size_t num_excluded = 0;
+      IloExpr row_sum_expr(env);
+      data->for_each_na_in_col(j, [&](const std::size_t i) {
+        if (is_free_row[i]) {
+          row_sum_expr += r[i];
+          ++num_excluded;
+        }
+      });
+      if (num_excluded > 0) {
+        model.add(static_cast<IloNum>(num_excluded) * c[j] + row_sum_expr <= static_cast<IloNum>(num_excluded));
+      }
+      row_sum_expr.end();
+    }
+  } else {
+    for (auto i : free_rows) {
+      data->for_each_na_in_row(i, [&](const std::size_t j) {
+        if (is_free_col[j]) {
+          model.add(r[i] + c[j] <= 1);
+        }
+      });
+    }
+  }
+
+  for (auto &d : presolve->get_row_dominance()) {
+    model.add(r[d.first] <= r[d.second]);
+  }
+  for (auto &d : presolve->get_col_dominance()) {
+    model.add(c[d.first] <= c[d.second]);
   }
 }
 
@@ -86,15 +183,23 @@ void RowColLpSolver::round_extreme_values() {
   }
 }
 
+//------------------------------------------------------------------------------
+// Sets the number of threads CPLEX may use.
+//------------------------------------------------------------------------------
+void RowColLpSolver::set_num_threads(const std::size_t _num_threads) {
+  num_threads = _num_threads > 0 ? _num_threads : 1;
+}
+
 //------------------------------------------------------------------------------
 // Calls CPLEX solver and rounds decision variables if a valid solution is
 // found.
 //------------------------------------------------------------------------------
 void RowColLpSolver::solve() {
+  PhaseTimer solve_timer("cplex_solve");
   cplex.extract(model);
   
   cplex.setParam(IloCplex::Param::RandomSeed, 0);
-  cplex.setParam(IloCplex::Param::Threads, 1);
+  cplex.setParam(IloCplex::Param::Threads, static_cast<IloInt>(num_threads));
   cplex.setParam(IloCplex::Param::RootAlgorithm, IloCplex::Algorithm::Barrier);
   cplex.setOut(env.getNullStream());
 
@@ -116,6 +221,18 @@ void RowColLpSolver::solve() {
       for (std::size_t i = 0; i < c_var.size(); ++i) {
         c_var[i] = c_copy[i];
       }
+
+      // Every member of a class takes the value of its head
+      for (auto &members : presolve->get_row_classes()) {
+        for (std::size_t k = 1; k < members.size(); ++k) {
+          r_var[members[k]] = r_var[members[0]];
+        }
+      }
+      for (auto &members : presolve->get_col_classes()) {
+        for (std::size_t k = 1; k < members.size(); ++k) {
+          c_var[members[k]] = c_var[members[0]];
+        }
+      }
       
       round_extreme_values();
     }
@@ -127,6 +244,13 @@ void RowColLpSolver::solve() {
   env.end();
 }
 
+//------------------------------------------------------------------------------
+// Returns the formulation used for the missing-data constraints.
+//------------------------------------------------------------------------------
+Formulation::Type RowColLpSolver::get_formulation() const {
+  return formulation;
+}
+
 //------------------------------------------------------------------------------
 // Returns the objective value from CPLEX. If CPLEX has not been called, or did
 // not find a solution, then 0 is returned.
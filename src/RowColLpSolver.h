@@ -6,14 +6,19 @@
 #include <ilconcert/ilomodel.h>
 
 #include "BinContainer.h"
+#include "Formulation.h"
+#include "Presolve.h"
 
 class RowColLpSolver
 {
 private:
   const BinContainer *data;
+  const Presolve *presolve;
   const std::size_t num_rows;
   const std::size_t num_cols;
+  const Formulation::Type formulation;
   const double TOL;
+  std::size_t num_threads;
 
   std::vector<double> r_var;
   std::vector<double> c_var;
@@ -33,10 +38,14 @@ private:
 
 public:
   RowColLpSolver(const BinContainer &_data,
+                 const Presolve &_presolve,
+                 const Formulation::Type _formulation = Formulation::PER_ELEMENT,
                  const double _TOL = 0.00001);
   ~RowColLpSolver();
 
+  void set_num_threads(const std::size_t _num_threads);
   void solve();
+  Formulation::Type get_formulation() const;
   double get_obj_value() const;
   std::vector<bool> get_rows_to_keep() const;
   std::vector<bool> get_cols_to_keep() const;
@@ -1,11 +1,15 @@
 #include <cstdio>
 #include <cstdlib>
 #include <string>
+#include <algorithm>
 #include "BinContainer.h"
 #include "RowColLpSolver.h"
 #include "Timer.h"
+#include "PhaseTimer.h"
 #include "ConfigParser.h"
 #include "NoMissSummary.h"
+#include "Formulation.h"
+#include "Presolve.h"
 
 int main(int argc, char *argv[]) {
 
@@ -27,6 +31,9 @@ int main(int argc, char *argv[]) {
   ConfigParser parser("config.cfg");
   const bool PRINT_SUMMARY = parser.getBool("PRINT_SUMMARY");
   const bool WRITE_STATS = parser.getBool("WRITE_STATS");
+  const std::size_t MAX_CPLEX_THREADS = parser.getSizeT("MAX_CPLEX_THREADS");
+  const Formulation::Type ROWCOL_FORMULATION = Formulation::parse(parser.getString("ROWCOL_FORMULATION"));
+  const bool PRESOLVE = parser.getBool("PRESOLVE");
 
   Timer timer;
 
@@ -38,18 +45,26 @@ int main(int argc, char *argv[]) {
   double run_time = 0.0;
   std::vector<bool> rows_to_keep(data.get_num_data_rows(), false), cols_to_keep(data.get_num_data_cols(), false);
 
-  fprintf(stderr, "Calling Solver\n");
-  RowColLpSolver rc_solver(data);
   timer.start();
+  Presolve presolve(data);
+  if (PRESOLVE) {
+    presolve.run();
+  }
+
+  fprintf(stderr, "Calling Solver\n");
+  RowColLpSolver rc_solver(data, presolve, ROWCOL_FORMULATION);
+  rc_solver.set_num_threads(MAX_CPLEX_THREADS);
   rc_solver.solve();
   timer.stop();
   fprintf(stderr, "Solver finished\n");
 
+  // The rounded solution only covers the rows and columns left by the presolve
   rows_to_keep = rc_solver.get_rows_to_keep();
   cols_to_keep = rc_solver.get_cols_to_keep();
-  num_rows_to_keep = rc_solver.get_num_rows_to_keep();
-  num_cols_to_keep = rc_solver.get_num_cols_to_keep();
-  run_time = timer.elapsed_cpu_time();
+  presolve.restore_incumbent(rows_to_keep, cols_to_keep);
+  num_rows_to_keep = std::count(rows_to_keep.begin(), rows_to_keep.end(), true);
+  num_cols_to_keep = std::count(cols_to_keep.begin(), cols_to_keep.end(), true);
+  run_time = timer.elapsed_wall_time();
   num_val_elements = data.get_num_valid_data_kept(rows_to_keep, cols_to_keep);
 
   // Record results
@@ -59,10 +74,14 @@ int main(int argc, char *argv[]) {
 
   // Wrtie statistics to file
   if (WRITE_STATS) {
-    noMissSummary::write_stats_to_file("RowColLp_summary.csv", data_file, run_time, num_val_elements, num_rows_to_keep, num_cols_to_keep);
+    noMissSummary::write_stats_to_file("RowColLp_summary.csv", data_file, timer.elapsed_cpu_time(), run_time, num_val_elements, num_rows_to_keep, num_cols_to_keep);
   }
 
   noMissSummary::write_solution_to_file("RowCol.sol", rows_to_keep, cols_to_keep);
 
+  if (WRITE_STATS) {
+    PhaseTimer::write_to_file("RowColLp_phases.csv", data_file);
+  }
+
   return 0;
 }
\ No newline at end of file
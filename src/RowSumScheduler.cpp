@@ -0,0 +1,219 @@
+#include "RowSumScheduler.h"
+#include <assert.h>
+#include <cstdlib>
+#include <iterator>
+
+//------------------------------------------------------------------------------
+// Constructor. Every row_sum starts with the bound row_sum * max_cols_possible
+// and must be screened before it is solved.
+//------------------------------------------------------------------------------
+RowSumScheduler::RowSumScheduler(const std::vector<std::size_t> &max_cols_possible,
+                                 const std::size_t _best_num_elements,
+                                 const std::size_t best_num_rows) : num_rows(max_cols_possible.size()),
+                                                                    state(num_rows, UNSCREENED),
+                                                                    bound(num_rows, 0),
+                                                                    distance(num_rows, 0),
+                                                                    best_num_elements(_best_num_elements),
+                                                                    num_in_flight(0),
+                                                                    num_screened(0),
+                                                                    num_pruned(0),
+                                                                    num_solved(0) {
+  for (std::size_t row_sum = 1; row_sum <= num_rows; ++row_sum) {
+    bound[row_sum-1] = row_sum * max_cols_possible[row_sum-1];
+    distance[row_sum-1] = row_sum > best_num_rows ? row_sum - best_num_rows : best_num_rows - row_sum;
+    push(row_sum);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Destructor.
+//------------------------------------------------------------------------------
+RowSumScheduler::~RowSumScheduler() {}
+
+//------------------------------------------------------------------------------
+// Adds the row_sum to the queue if its bound can beat the incumbent. Otherwise
+// the row_sum is pruned.
+//------------------------------------------------------------------------------
+void RowSumScheduler::push(const std::size_t row_sum) {
+  if (bound[row_sum-1] > best_num_elements) {
+    Entry entry = {bound[row_sum-1], distance[row_sum-1], row_sum};
+    queue.insert(entry);
+  } else {
+    state[row_sum-1] = DONE;
+    ++num_pruned;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Removes every queued row_sum whose bound cannot beat the incumbent. The queue
+// is ordered by decreasing bound, so only the tail needs to be checked.
+//------------------------------------------------------------------------------
+void RowSumScheduler::prune_queue() {
+  while (!queue.empty()) {
+    auto last = std::prev(queue.end());
+    if (last->bound > best_num_elements) {
+      break;
+    }
+    state[last->row_sum-1] = DONE;
+    ++num_pruned;
+    queue.erase(last);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Pops the open row_sum with the highest bound. Returns false if no open
+// row_sum can beat the incumbent.
+//------------------------------------------------------------------------------
+bool RowSumScheduler::next_task(Task &task) {
+  prune_queue();
+  if (queue.empty()) {
+    return false;
+  }
+
+  const Entry entry = *queue.begin();
+  queue.erase(queue.begin());
+
+  task.row_sum = entry.row_sum;
+  task.min_cols = (best_num_elements / entry.row_sum) + 1;
+  task.type = (state[entry.row_sum-1] == UNSCREENED) ? SCREEN_TASK : SOLVE_TASK;
+
+  state[entry.row_sum-1] = (task.type == SCREEN_TASK) ? SCREENING : SOLVING;
+  ++num_in_flight;
+
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Records the outcome of a task. Screened row_sums are requeued with the bound
+// row_sum * 'num_cols_bound', where 'num_cols_bound' is the number of columns
+// that survived the screening.
+//------------------------------------------------------------------------------
+void RowSumScheduler::report(const std::size_t row_sum,
+                             const Outcome outcome,
+                             const std::size_t num_cols_bound) {
+  assert(row_sum > 0 && row_sum <= num_rows);
+  assert(state[row_sum-1] == SCREENING || state[row_sum-1] == SOLVING);
+  --num_in_flight;
+
+  switch (outcome) {
+    case PRUNED:
+      state[row_sum-1] = DONE;
+      ++num_pruned;
+      break;
+
+    case SCREENED:
+      ++num_screened;
+      if (row_sum * num_cols_bound < bound[row_sum-1]) {
+        bound[row_sum-1] = row_sum * num_cols_bound;
+      }
+      state[row_sum-1] = WAITING_TO_SOLVE;
+      push(row_sum);
+      break;
+
+    case SOLVED:
+      state[row_sum-1] = DONE;
+      ++num_solved;
+      break;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Updates the incumbent and removes every row_sum that can no longer beat it.
+//------------------------------------------------------------------------------
+void RowSumScheduler::update_incumbent(const std::size_t _best_num_elements) {
+  if (_best_num_elements > best_num_elements) {
+    best_num_elements = _best_num_elements;
+    prune_queue();
+  }
+}
+
+//------------------------------------------------------------------------------
+// Writes the state of the sweep: a line with the number of screened, pruned,
+// solved and open row_sums, then a line per open row_sum with row_sum,screened
+// (0 or 1),bound. Row_sums in flight are written as they were before they were
+// dispatched, so that they are run again on a restart.
+//------------------------------------------------------------------------------
+void RowSumScheduler::write(FILE *output) const {
+  std::size_t num_open = 0;
+  for (auto s : state) {
+    if (s != DONE) {
+      ++num_open;
+    }
+  }
+
+  fprintf(output, "%lu,%lu,%lu,%lu\n", num_screened, num_pruned, num_solved, num_open);
+  for (std::size_t row_sum = 1; row_sum <= num_rows; ++row_sum) {
+    const State s = state[row_sum-1];
+    if (s != DONE) {
+      const int screened = (s == WAITING_TO_SOLVE || s == SOLVING) ? 1 : 0;
+      fprintf(output, "%lu,%d,%lu\n", row_sum, screened, bound[row_sum-1]);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Replaces the state of the sweep with the one written by write(). Row_sums not
+// listed as open are done. The bound of an open row_sum is the lower of the
+// written one and its current one. Must be called before any task is
+// dispatched.
+//------------------------------------------------------------------------------
+void RowSumScheduler::read(FILE *input, const std::string &file_name) {
+  assert(num_in_flight == 0);
+
+  std::size_t num_open;
+  if (fscanf(input, "%lu,%lu,%lu,%lu", &num_screened, &num_pruned, &num_solved, &num_open) != 4) {
+    fprintf(stderr, "ERROR - Could not read the row_sum counts in %s\n", file_name.c_str());
+    exit(1);
+  }
+
+  std::vector<State> restored_state(num_rows, DONE);
+  std::vector<std::size_t> restored_bound(bound);
+  for (std::size_t i = 0; i < num_open; ++i) {
+    std::size_t row_sum, written_bound;
+    int screened;
+    if (fscanf(input, "%lu,%d,%lu", &row_sum, &screened, &written_bound) != 3 || row_sum == 0 || row_sum > num_rows) {
+      fprintf(stderr, "ERROR - Could not read open row_sum %lu in %s\n", i, file_name.c_str());
+      exit(1);
+    }
+    restored_state[row_sum-1] = screened ? WAITING_TO_SOLVE : UNSCREENED;
+    if (written_bound < restored_bound[row_sum-1]) {
+      restored_bound[row_sum-1] = written_bound;
+    }
+  }
+
+  state = restored_state;
+  bound = restored_bound;
+  queue.clear();
+  for (std::size_t row_sum = 1; row_sum <= num_rows; ++row_sum) {
+    if (state[row_sum-1] != DONE) {
+      push(row_sum);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Returns true once every row_sum has been pruned or solved.
+//------------------------------------------------------------------------------
+bool RowSumScheduler::is_finished() const {
+  return queue.empty() && num_in_flight == 0;
+}
+
+std::size_t RowSumScheduler::get_num_open() const {
+  return queue.size();
+}
+
+std::size_t RowSumScheduler::get_num_in_flight() const {
+  return num_in_flight;
+}
+
+std::size_t RowSumScheduler::get_num_screened() const {
+  return num_screened;
+}
+
+std::size_t RowSumScheduler::get_num_pruned() const {
+  return num_pruned;
+}
+
+std::size_t RowSumScheduler::get_num_solved() const {
+  return num_solved;
+}
@@ -0,0 +1,77 @@
+#ifndef ROW_SUM_SCHEDULER_H
+#define ROW_SUM_SCHEDULER_H
+
+#include <cstdio>
+#include <set>
+#include <string>
+#include <vector>
+
+class RowSumScheduler
+{
+public:
+  enum TaskType { SCREEN_TASK = 0, SOLVE_TASK = 1 };
+  enum Outcome { PRUNED = 0, SCREENED = 1, SOLVED = 2 };
+
+  struct Task {
+    std::size_t row_sum;
+    std::size_t min_cols;
+    TaskType type;
+  };
+
+private:
+  enum State { UNSCREENED, WAITING_TO_SOLVE, SCREENING, SOLVING, DONE };
+
+  struct Entry {
+    std::size_t bound;
+    std::size_t distance;
+    std::size_t row_sum;
+  };
+
+  // Highest bound first, ties broken by distance from the incumbent's rows
+  struct EntryOrder {
+    bool operator()(const Entry &lhs, const Entry &rhs) const {
+      if (lhs.bound != rhs.bound) return lhs.bound > rhs.bound;
+      if (lhs.distance != rhs.distance) return lhs.distance < rhs.distance;
+      return lhs.row_sum < rhs.row_sum;
+    }
+  };
+
+  const std::size_t num_rows;
+  std::vector<State> state;
+  std::vector<std::size_t> bound;
+  std::vector<std::size_t> distance;
+  std::set<Entry, EntryOrder> queue;
+
+  std::size_t best_num_elements;
+  std::size_t num_in_flight;
+  std::size_t num_screened;
+  std::size_t num_pruned;
+  std::size_t num_solved;
+
+  void push(const std::size_t row_sum);
+  void prune_queue();
+
+public:
+  RowSumScheduler(const std::vector<std::size_t> &max_cols_possible,
+                  const std::size_t _best_num_elements,
+                  const std::size_t best_num_rows);
+  ~RowSumScheduler();
+
+  bool next_task(Task &task);
+  void report(const std::size_t row_sum,
+              const Outcome outcome,
+              const std::size_t num_cols_bound);
+  void update_incumbent(const std::size_t _best_num_elements);
+
+  void write(FILE *output) const;
+  void read(FILE *input, const std::string &file_name);
+
+  bool is_finished() const;
+  std::size_t get_num_open() const;
+  std::size_t get_num_in_flight() const;
+  std::size_t get_num_screened() const;
+  std::size_t get_num_pruned() const;
+  std::size_t get_num_solved() const;
+};
+
+#endif
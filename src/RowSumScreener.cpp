@@ -0,0 +1,203 @@
+#include "RowSumScreener.h"
+#include <algorithm>
+#include <assert.h>
+
+//------------------------------------------------------------------------------
+// Constructor. Every free row (column) stands for a class of identical rows
+// (columns) whose size is given in 'row_weights' ('col_weights'), so the
+// numbers of valid rows and columns count class members.
+//------------------------------------------------------------------------------
+RowSumScreener::RowSumScreener(const BinContainer &_data,
+                               const std::vector<std::size_t> &_forced_one_rows,
+                               const std::vector<std::size_t> &_forced_one_cols,
+                               const std::vector<std::size_t> &_free_rows,
+                               const std::vector<std::size_t> &_free_cols,
+                               const std::vector<std::size_t> &_row_weights,
+                               const std::vector<std::size_t> &_col_weights,
+                               const Pairs &_row_pairs,
+                               const Pairs &_col_pairs) : data(&_data),
+                                                          forced_one_rows(&_forced_one_rows),
+                                                          forced_one_cols(&_forced_one_cols),
+                                                          free_rows(&_free_rows),
+                                                          free_cols(&_free_cols),
+                                                          row_weights(&_row_weights),
+                                                          col_weights(&_col_weights),
+                                                          row_pairs(&_row_pairs),
+                                                          col_pairs(&_col_pairs),
+                                                          max_cols_possible(calc_max_cols_possible(_data)),
+                                                          num_valid_rows(0),
+                                                          num_valid_cols(0) {}
+
+//------------------------------------------------------------------------------
+// Destructor.
+//------------------------------------------------------------------------------
+RowSumScreener::~RowSumScreener() {}
+
+//------------------------------------------------------------------------------
+// Calculates the maximum number of kept columns associated with keeping i rows
+// by subtracting the number of invalid elements of the i-th ordered row from
+// the number of columns.
+//------------------------------------------------------------------------------
+std::vector<std::size_t> RowSumScreener::calc_max_cols_possible(const BinContainer &data) {
+  const std::size_t num_rows = data.get_num_data_rows();
+  const std::size_t num_cols = data.get_num_data_cols();
+
+  std::vector<std::size_t> num_missing(num_rows);
+  for (std::size_t i = 0; i < num_rows; ++i) {
+    num_missing[i] = data.get_num_invalid_in_row(i);
+  }
+  std::sort(num_missing.begin(), num_missing.end());
+
+  std::vector<std::size_t> max_cols(num_rows);
+  for (std::size_t i = 0; i < num_rows; ++i) {
+    max_cols[i] = num_cols - num_missing[i];
+  }
+  return max_cols;
+}
+
+//------------------------------------------------------------------------------
+// Repeatedly removes free columns that cannot be part of a solution with
+// 'row_sum' rows and at least 'min_cols' columns, until no more columns are
+// removed.
+//------------------------------------------------------------------------------
+void RowSumScreener::reduce_cols(const std::size_t row_sum, const std::size_t min_cols) {
+  valid_col.assign(free_cols->size(), 1);
+  num_valid_cols = 0;
+  for (auto w : *col_weights) {
+    num_valid_cols += w;
+  }
+
+  const std::size_t min_free_cols = min_cols > forced_one_cols->size() ? min_cols - forced_one_cols->size() : 0;
+  bool set_new_col_to_zero = true;
+
+  // Remove the columns without enough valid elements compared to the row_sum
+  // first, so that no pair count is checked against a column that cannot be kept
+  for (std::size_t j = 0; j < free_cols->size(); ++j) {
+    if (data->get_num_valid_in_col(free_cols->at(j)) < row_sum) {
+      valid_col[j] = 0;
+      num_valid_cols -= col_weights->at(j);
+    }
+  }
+
+  while(set_new_col_to_zero && min_free_cols > 1) {
+    set_new_col_to_zero = false;
+
+    // Loop through all free columns
+    for (std::size_t j = 0; j < free_cols->size(); ++j) {
+      if (!valid_col[j]) continue; // If current column is already not valid, continue to next column
+
+      // Get the number of pairs, from valid columns, that are >= the threshold.
+      // The other columns of the same class pair with this one
+      std::size_t count = col_pairs->getNumPairsGteThresh(j, row_sum, valid_col, *col_weights, num_valid_cols) + col_weights->at(j) - 1;
+
+      // Check if the number of valid columns is below the cutoff
+      // We subtract 1 to account for the current column contributing to the cutoff
+      if (count < min_free_cols - 1) {
+        set_new_col_to_zero = true;
+        valid_col[j] = 0;
+        num_valid_cols -= col_weights->at(j);
+      }
+    }
+
+    // If the number of remaining free columns is below the cuttoff, break from the loop
+    if (num_valid_cols < min_free_cols) {
+      break;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Repeatedly removes free rows that cannot be part of a solution with
+// 'row_sum' rows and at least 'min_cols' columns, until no more rows are
+// removed.
+//------------------------------------------------------------------------------
+void RowSumScreener::reduce_rows(const std::size_t row_sum, const std::size_t min_cols) {
+  valid_row.assign(free_rows->size(), 1);
+  num_valid_rows = 0;
+  for (auto w : *row_weights) {
+    num_valid_rows += w;
+  }
+
+  const std::size_t min_free_rows = row_sum - forced_one_rows->size();
+  bool set_new_row_to_zero = true;
+
+  // Remove the rows without enough valid elements compared to the min_cols first
+  for (std::size_t i = 0; i < free_rows->size(); ++i) {
+    if (data->get_num_valid_in_row(free_rows->at(i)) < min_cols) {
+      valid_row[i] = 0;
+      num_valid_rows -= row_weights->at(i);
+    }
+  }
+
+  while(set_new_row_to_zero && min_free_rows > 1) {
+    set_new_row_to_zero = false;
+
+    for (std::size_t i = 0; i < free_rows->size(); ++i) {
+      if (!valid_row[i]) continue;
+
+      std::size_t count = row_pairs->getNumPairsGteThresh(i, min_cols, valid_row, *row_weights, num_valid_rows) + row_weights->at(i) - 1;
+      if (count < min_free_rows - 1) {
+        set_new_row_to_zero = true;
+        valid_row[i] = 0;
+        num_valid_rows -= row_weights->at(i);
+      }
+    }
+
+    if (num_valid_rows < min_free_rows) {
+      break;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Applies the feasibility checks for a single row_sum problem. Returns false if
+// the problem cannot contain a solution with at least 'min_cols' columns. When
+// true is returned, 'valid_row' and 'valid_col' indicate which free rows and
+// free columns survived the reductions.
+//------------------------------------------------------------------------------
+bool RowSumScreener::screen(const std::size_t row_sum, const std::size_t min_cols) {
+  assert(row_sum > 0 && row_sum <= max_cols_possible.size());
+
+  valid_row.assign(free_rows->size(), 0);
+  valid_col.assign(free_cols->size(), 0);
+  num_valid_rows = 0;
+  num_valid_cols = 0;
+
+  // Check if 'min_cols' is greater than 'max_cols_possible'
+  if (min_cols > max_cols_possible[row_sum-1]) {
+    return false;
+  }
+
+  // Every row with no missing data would be kept, so the row_sum must cover them
+  if (row_sum < forced_one_rows->size()) {
+    return false;
+  }
+
+  reduce_cols(row_sum, min_cols);
+  if (num_valid_cols + forced_one_cols->size() < min_cols) {
+    return false;
+  }
+
+  reduce_rows(row_sum, min_cols);
+  if (num_valid_rows + forced_one_rows->size() < row_sum) {
+    return false;
+  }
+
+  return true;
+}
+
+const std::vector<int>& RowSumScreener::get_valid_rows() const {
+  return valid_row;
+}
+
+const std::vector<int>& RowSumScreener::get_valid_cols() const {
+  return valid_col;
+}
+
+std::size_t RowSumScreener::get_num_valid_rows() const {
+  return num_valid_rows;
+}
+
+std::size_t RowSumScreener::get_num_valid_cols() const {
+  return num_valid_cols;
+}
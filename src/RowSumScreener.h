@@ -0,0 +1,54 @@
+#ifndef ROW_SUM_SCREENER_H
+#define ROW_SUM_SCREENER_H
+
+#include <vector>
+
+#include "BinContainer.h"
+#include "Pairs.h"
+
+class RowSumScreener
+{
+private:
+  const BinContainer *data;
+  const std::vector<std::size_t> *forced_one_rows;
+  const std::vector<std::size_t> *forced_one_cols;
+  const std::vector<std::size_t> *free_rows;
+  const std::vector<std::size_t> *free_cols;
+  const std::vector<std::size_t> *row_weights;
+  const std::vector<std::size_t> *col_weights;
+  const Pairs *row_pairs;
+  const Pairs *col_pairs;
+
+  std::vector<std::size_t> max_cols_possible;
+
+  std::vector<int> valid_row;
+  std::vector<int> valid_col;
+  std::size_t num_valid_rows;
+  std::size_t num_valid_cols;
+
+  void reduce_cols(const std::size_t row_sum, const std::size_t min_cols);
+  void reduce_rows(const std::size_t row_sum, const std::size_t min_cols);
+
+public:
+  RowSumScreener(const BinContainer &_data,
+                 const std::vector<std::size_t> &_forced_one_rows,
+                 const std::vector<std::size_t> &_forced_one_cols,
+                 const std::vector<std::size_t> &_free_rows,
+                 const std::vector<std::size_t> &_free_cols,
+                 const std::vector<std::size_t> &_row_weights,
+                 const std::vector<std::size_t> &_col_weights,
+                 const Pairs &_row_pairs,
+                 const Pairs &_col_pairs);
+  ~RowSumScreener();
+
+  static std::vector<std::size_t> calc_max_cols_possible(const BinContainer &data);
+
+  bool screen(const std::size_t row_sum, const std::size_t min_cols);
+
+  const std::vector<int>& get_valid_rows() const;
+  const std::vector<int>& get_valid_cols() const;
+  std::size_t get_num_valid_rows() const;
+  std::size_t get_num_valid_cols() const;
+};
+
+#endif
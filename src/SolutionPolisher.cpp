@@ -0,0 +1,260 @@
+#include "SolutionPolisher.h"
+#include <algorithm>
+#include <cmath>
+#include "Timer.h"
+#include "Utils.h"
+
+//------------------------------------------------------------------------------
+// Constructor. The search stops after 'time_limit' seconds or 'max_moves'
+// moves, whichever comes first.
+//------------------------------------------------------------------------------
+SolutionPolisher::SolutionPolisher(const BinContainer &_data,
+                                   const double _time_limit,
+                                   const std::size_t _max_moves) : data(&_data),
+                                                                   num_rows(data->get_num_data_rows()),
+                                                                   num_cols(data->get_num_data_cols()),
+                                                                   time_limit(_time_limit),
+                                                                   max_moves(_max_moves),
+                                                                   tabu_tenure(std::max<std::size_t>(1, (num_rows + num_cols) / 10)),
+                                                                   row_kept(num_rows, false),
+                                                                   col_kept(num_cols, false),
+                                                                   num_rows_kept(0),
+                                                                   num_cols_kept(0),
+                                                                   row_conflicts(num_rows, 0),
+                                                                   col_conflicts(num_cols, 0),
+                                                                   row_tabu_until(num_rows, 0),
+                                                                   col_tabu_until(num_cols, 0),
+                                                                   num_moves(0),
+                                                                   num_accepted(0),
+                                                                   initial_num_elements(0),
+                                                                   best_num_elements(0),
+                                                                   best_rows_to_keep(num_rows, false),
+                                                                   best_cols_to_keep(num_cols, false),
+                                                                   rng(0) {}
+
+//------------------------------------------------------------------------------
+// Destructor.
+//------------------------------------------------------------------------------
+SolutionPolisher::~SolutionPolisher() {}
+
+//------------------------------------------------------------------------------
+// Makes 'rows' and 'cols' the current solution. Kept columns that conflict
+// with a kept row are dropped, so an invalid solution is repaired, and every
+// row and column that can be added for free is added.
+//------------------------------------------------------------------------------
+void SolutionPolisher::set_solution(const std::vector<bool> &rows, const std::vector<bool> &cols) {
+  row_kept = rows;
+  col_kept = cols;
+  num_rows_kept = std::count(row_kept.begin(), row_kept.end(), true);
+  num_cols_kept = std::count(col_kept.begin(), col_kept.end(), true);
+  row_conflicts.assign(num_rows, 0);
+  col_conflicts.assign(num_cols, 0);
+  free_rows.clear();
+  free_cols.clear();
+
+  for (std::size_t i = 0; i < num_rows; ++i) {
+    if (row_kept[i]) {
+      data->for_each_na_in_row(i, [this](const std::size_t j) { ++col_conflicts[j]; });
+    }
+  }
+  for (std::size_t j = 0; j < num_cols; ++j) {
+    if (col_kept[j]) {
+      data->for_each_na_in_col(j, [this](const std::size_t i) { ++row_conflicts[i]; });
+    }
+  }
+
+  for (std::size_t j = 0; j < num_cols; ++j) {
+    if (col_kept[j] && col_conflicts[j] > 0) {
+      drop_col(j);
+    }
+  }
+
+  for (std::size_t i = 0; i < num_rows; ++i) {
+    if (!row_kept[i] && row_conflicts[i] == 0) {
+      free_rows.push_back(i);
+    }
+  }
+  for (std::size_t j = 0; j < num_cols; ++j) {
+    if (!col_kept[j] && col_conflicts[j] == 0) {
+      free_cols.push_back(j);
+    }
+  }
+  add_free();
+}
+
+//------------------------------------------------------------------------------
+// Adds 'row' and drops every kept column missing it.
+//------------------------------------------------------------------------------
+void SolutionPolisher::add_row(const std::size_t row) {
+  row_kept[row] = true;
+  ++num_rows_kept;
+  data->for_each_na_in_row(row, [this](const std::size_t j) {
+    if (col_kept[j]) {
+      drop_col(j);
+    }
+    ++col_conflicts[j];
+  });
+}
+
+//------------------------------------------------------------------------------
+// Adds 'col' and drops every kept row missing it.
+//------------------------------------------------------------------------------
+void SolutionPolisher::add_col(const std::size_t col) {
+  col_kept[col] = true;
+  ++num_cols_kept;
+  data->for_each_na_in_col(col, [this](const std::size_t i) {
+    if (row_kept[i]) {
+      drop_row(i);
+    }
+    ++row_conflicts[i];
+  });
+}
+
+void SolutionPolisher::drop_row(const std::size_t row) {
+  row_kept[row] = false;
+  --num_rows_kept;
+  row_tabu_until[row] = num_moves + tabu_tenure;
+  data->for_each_na_in_row(row, [this](const std::size_t j) {
+    if (--col_conflicts[j] == 0 && !col_kept[j]) {
+      free_cols.push_back(j);
+    }
+  });
+}
+
+void SolutionPolisher::drop_col(const std::size_t col) {
+  col_kept[col] = false;
+  --num_cols_kept;
+  col_tabu_until[col] = num_moves + tabu_tenure;
+  data->for_each_na_in_col(col, [this](const std::size_t i) {
+    if (--row_conflicts[i] == 0 && !row_kept[i]) {
+      free_rows.push_back(i);
+    }
+  });
+}
+
+//------------------------------------------------------------------------------
+// Adds every row and column that no longer conflicts with the solution. Adding
+// one can make a queued one conflict again, so each is checked when popped.
+//------------------------------------------------------------------------------
+void SolutionPolisher::add_free() {
+  while (!free_rows.empty() || !free_cols.empty()) {
+    if (!free_rows.empty()) {
+      const std::size_t i = free_rows.back();
+      free_rows.pop_back();
+      if (!row_kept[i] && row_conflicts[i] == 0) {
+        add_row(i);
+      }
+    } else {
+      const std::size_t j = free_cols.back();
+      free_cols.pop_back();
+      if (!col_kept[j] && col_conflicts[j] == 0) {
+        add_col(j);
+      }
+    }
+  }
+}
+
+void SolutionPolisher::record_if_best() {
+  if (num_rows_kept * num_cols_kept > best_num_elements) {
+    best_num_elements = num_rows_kept * num_cols_kept;
+    best_rows_to_keep = row_kept;
+    best_cols_to_keep = col_kept;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Simulated annealing from the given solution. A move adds one row (column)
+// and drops the kept columns (rows) missing it, so its change in the number
+// of elements is known from the conflict counts before it is applied. Moves
+// that do not lose elements are always accepted and the others with
+// probability exp(delta / T), where T falls linearly to 0 over the budget.
+// A dropped row or column is tabu for a number of moves unless adding it back
+// gives a new best solution.
+//------------------------------------------------------------------------------
+void SolutionPolisher::polish(const std::vector<bool> &rows_to_keep, const std::vector<bool> &cols_to_keep) {
+  Timer timer(true);
+
+  num_moves = 0;
+  num_accepted = 0;
+  std::fill(row_tabu_until.begin(), row_tabu_until.end(), 0);
+  std::fill(col_tabu_until.begin(), col_tabu_until.end(), 0);
+
+  initial_num_elements = data->get_num_valid_data_kept(rows_to_keep, cols_to_keep);
+  set_solution(rows_to_keep, cols_to_keep);
+  best_num_elements = 0;
+  record_if_best();
+
+  const double start_temp = std::max(1.0, static_cast<double>(best_num_elements) / (num_rows_kept + num_cols_kept + 1));
+  std::uniform_int_distribution<std::size_t> pick(0, num_rows + num_cols - 1);
+  std::uniform_real_distribution<double> coin(0.0, 1.0);
+  double elapsed = 0.0;
+
+  while (num_moves < max_moves && elapsed < time_limit) {
+    if ((num_moves & 1023) == 0) {
+      elapsed = timer.elapsed_wall_time();
+    }
+    const double progress = std::max(static_cast<double>(num_moves) / max_moves, elapsed / time_limit);
+    const double temp = start_temp * (1.0 - progress);
+    ++num_moves;
+
+    const std::size_t k = pick(rng);
+    const bool is_row = k < num_rows;
+    const std::size_t idx = is_row ? k : k - num_rows;
+    if (is_row ? row_kept[idx] : col_kept[idx]) {
+      continue;
+    }
+
+    const std::size_t current = num_rows_kept * num_cols_kept;
+    const std::size_t candidate = is_row ? (num_rows_kept + 1) * (num_cols_kept - row_conflicts[idx]) :
+                                           (num_rows_kept - col_conflicts[idx]) * (num_cols_kept + 1);
+    const std::size_t tabu_until = is_row ? row_tabu_until[idx] : col_tabu_until[idx];
+    if (num_moves < tabu_until && candidate <= best_num_elements) {
+      continue;
+    }
+    if (candidate < current &&
+        (temp <= 0.0 || coin(rng) >= std::exp((static_cast<double>(candidate) - current) / temp))) {
+      continue;
+    }
+
+    if (is_row) {
+      add_row(idx);
+    } else {
+      add_col(idx);
+    }
+    add_free();
+    ++num_accepted;
+    record_if_best();
+  }
+}
+
+std::size_t SolutionPolisher::get_initial_num_elements() const {
+  return initial_num_elements;
+}
+
+std::size_t SolutionPolisher::get_best_num_elements() const {
+  return best_num_elements;
+}
+
+std::size_t SolutionPolisher::get_num_moves() const {
+  return num_moves;
+}
+
+std::size_t SolutionPolisher::get_num_accepted() const {
+  return num_accepted;
+}
+
+std::vector<bool> SolutionPolisher::get_rows_to_keep() const {
+  return best_rows_to_keep;
+}
+
+std::vector<bool> SolutionPolisher::get_cols_to_keep() const {
+  return best_cols_to_keep;
+}
+
+std::size_t SolutionPolisher::get_num_rows_to_keep() const {
+  return std::count(best_rows_to_keep.begin(), best_rows_to_keep.end(), true);
+}
+
+std::size_t SolutionPolisher::get_num_cols_to_keep() const {
+  return std::count(best_cols_to_keep.begin(), best_cols_to_keep.end(), true);
+}
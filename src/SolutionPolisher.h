@@ -0,0 +1,70 @@
+#ifndef SOLUTION_POLISHER_H
+#define SOLUTION_POLISHER_H
+
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "BinContainer.h"
+
+class SolutionPolisher
+{
+private:
+  const BinContainer *data;
+  const std::size_t num_rows;
+  const std::size_t num_cols;
+  const double time_limit;
+  const std::size_t max_moves;
+  const std::size_t tabu_tenure;
+
+  // Current solution, and for every row (column) the number of kept columns
+  // (rows) it conflicts with. A row or column with no conflicts can be added
+  // without dropping anything.
+  std::vector<bool> row_kept;
+  std::vector<bool> col_kept;
+  std::size_t num_rows_kept;
+  std::size_t num_cols_kept;
+  std::vector<std::size_t> row_conflicts;
+  std::vector<std::size_t> col_conflicts;
+  std::vector<std::size_t> free_rows;
+  std::vector<std::size_t> free_cols;
+
+  // Move number until which a dropped row or column may not be added back
+  std::vector<std::size_t> row_tabu_until;
+  std::vector<std::size_t> col_tabu_until;
+
+  std::size_t num_moves;
+  std::size_t num_accepted;
+  std::size_t initial_num_elements;
+  std::size_t best_num_elements;
+  std::vector<bool> best_rows_to_keep;
+  std::vector<bool> best_cols_to_keep;
+
+  std::mt19937 rng;
+
+  void set_solution(const std::vector<bool> &rows, const std::vector<bool> &cols);
+  void add_row(const std::size_t row);
+  void add_col(const std::size_t col);
+  void drop_row(const std::size_t row);
+  void drop_col(const std::size_t col);
+  void add_free();
+  void record_if_best();
+
+public:
+  SolutionPolisher(const BinContainer &_data,
+                   const double _time_limit,
+                   const std::size_t _max_moves);
+  ~SolutionPolisher();
+
+  void polish(const std::vector<bool> &rows_to_keep, const std::vector<bool> &cols_to_keep);
+
+  std::size_t get_initial_num_elements() const;
+  std::size_t get_best_num_elements() const;
+  std::size_t get_num_moves() const;
+  std::size_t get_num_accepted() const;
+  std::vector<bool> get_rows_to_keep() const;
+  std::vector<bool> get_cols_to_keep() const;
+  std::size_t get_num_rows_to_keep() const;
+  std::size_t get_num_cols_to_keep() const;
+};
+
+#endif
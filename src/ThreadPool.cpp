@@ -0,0 +1,78 @@
+#include "ThreadPool.h"
+
+//------------------------------------------------------------------------------
+// Constructor. Starts 'num_threads' threads that wait for jobs.
+//------------------------------------------------------------------------------
+ThreadPool::ThreadPool(const std::size_t num_threads) : num_submitted(0),
+                                                        num_running(0),
+                                                        stopping(false) {
+  for (std::size_t i = 0; i < num_threads; ++i) {
+    threads.emplace_back(&ThreadPool::run, this);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Destructor. Finishes the queued jobs and joins the threads.
+//------------------------------------------------------------------------------
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    stopping = true;
+  }
+  job_available.notify_all();
+
+  for (auto &t : threads) {
+    t.join();
+  }
+}
+
+//------------------------------------------------------------------------------
+// Loop executed by every thread of the pool.
+//------------------------------------------------------------------------------
+void ThreadPool::run() {
+  while (true) {
+    std::function<void()> job;
+    {
+      std::unique_lock<std::mutex> lock(mtx);
+      job_available.wait(lock, [this] { return stopping || !jobs.empty(); });
+      if (jobs.empty()) {
+        return;
+      }
+      job = jobs.top().run;
+      jobs.pop();
+      ++num_running;
+    }
+
+    job();
+
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      --num_running;
+    }
+    job_finished.notify_all();
+  }
+}
+
+//------------------------------------------------------------------------------
+// Queues a job to be executed by the first available thread. Queued jobs with
+// a higher 'priority' are started first.
+//------------------------------------------------------------------------------
+void ThreadPool::submit(const std::function<void()> &job, const std::size_t priority) {
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    jobs.push(Job{priority, num_submitted++, job});
+  }
+  job_available.notify_one();
+}
+
+//------------------------------------------------------------------------------
+// Blocks until every submitted job has finished.
+//------------------------------------------------------------------------------
+void ThreadPool::wait() {
+  std::unique_lock<std::mutex> lock(mtx);
+  job_finished.wait(lock, [this] { return jobs.empty() && num_running == 0; });
+}
+
+std::size_t ThreadPool::size() const {
+  return threads.size();
+}
@@ -0,0 +1,46 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+class ThreadPool
+{
+private:
+  // Jobs run by decreasing priority, and in the order they were submitted
+  // among equal priorities
+  struct Job {
+    std::size_t priority;
+    std::size_t order;
+    std::function<void()> run;
+
+    bool operator<(const Job &other) const {
+      return priority < other.priority || (priority == other.priority && order > other.order);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  std::priority_queue<Job> jobs;
+  std::size_t num_submitted;
+  std::mutex mtx;
+  std::condition_variable job_available;
+  std::condition_variable job_finished;
+  std::size_t num_running;
+  bool stopping;
+
+  void run();
+
+public:
+  ThreadPool(const std::size_t num_threads);
+  ~ThreadPool();
+
+  void submit(const std::function<void()> &job, const std::size_t priority = 0);
+  void wait();
+  std::size_t size() const;
+};
+
+#endif
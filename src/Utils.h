@@ -1,7 +1,10 @@
 #ifndef UTILS_H
 #define UTILS_H
 
+#include <algorithm>
+#include <cstdint>
 #include <utility>
+#include <vector>
 
 namespace utils {
   struct SortPairByFirstItemDecreasing {
@@ -31,6 +34,88 @@ namespace utils {
       return lhs.second < rhs.second;
     }
   };
+
+  // Number of set bits in a bitset stored as 64-bit words
+  inline std::size_t count_bits(const std::vector<std::uint64_t> &bits) {
+    std::size_t count = 0;
+    for (auto w : bits) {
+      count += __builtin_popcountll(w);
+    }
+    return count;
+  }
+
+  // Intersects 'bits' with 'mask' and returns the number of bits left set
+  inline std::size_t and_count_bits(std::vector<std::uint64_t> &bits, const std::vector<std::uint64_t> &mask) {
+    std::size_t count = 0;
+    for (std::size_t w = 0; w < bits.size(); ++w) {
+      bits[w] &= mask[w];
+      count += __builtin_popcountll(bits[w]);
+    }
+    return count;
+  }
+
+  // Calls 'f' with the index of every set bit
+  template<typename F>
+  inline void for_each_set_bit(const std::vector<std::uint64_t> &bits, F f) {
+    for (std::size_t w = 0; w < bits.size(); ++w) {
+      std::uint64_t set = bits[w];
+      while (set) {
+        f(w * 64 + __builtin_ctzll(set));
+        set &= set - 1;
+      }
+    }
+  }
+
+  // Calls 'f' with the index of every unset bit among the first 'num_bits'
+  template<typename F>
+  inline void for_each_unset_bit(const std::vector<std::uint64_t> &bits, const std::size_t num_bits, F f) {
+    for (std::size_t w = 0; w < bits.size(); ++w) {
+      std::uint64_t unset = ~bits[w];
+      if ((w + 1) * 64 > num_bits) {
+        unset &= (std::uint64_t(1) << (num_bits % 64)) - 1;
+      }
+      while (unset) {
+        f(w * 64 + __builtin_ctzll(unset));
+        unset &= unset - 1;
+      }
+    }
+  }
+
+  // Calls 'f' with every value common to the sorted ranges [a, a_end) and
+  // [b, b_end), merging them in O(|a| + |b|)
+  template<typename F>
+  inline void for_each_common(const std::size_t *a, const std::size_t *a_end,
+                              const std::size_t *b, const std::size_t *b_end, F f) {
+    while (a != a_end && b != b_end) {
+      if (*a < *b) {
+        ++a;
+      } else if (*b < *a) {
+        ++b;
+      } else {
+        f(*a);
+        ++a;
+        ++b;
+      }
+    }
+  }
+
+  // Same as for_each_common, but gallops through 'b' for every value of the
+  // much shorter 'a', which costs O(|a| log |b|)
+  template<typename F>
+  inline void for_each_common_gallop(const std::size_t *a, const std::size_t *a_end,
+                                     const std::size_t *b, const std::size_t *b_end, F f) {
+    for (; a != a_end && b != b_end; ++a) {
+      std::size_t step = 1;
+      while (step < static_cast<std::size_t>(b_end - b) && b[step] < *a) {
+        step *= 2;
+      }
+      b = std::lower_bound(b + step / 2, b + std::min(step + 1, static_cast<std::size_t>(b_end - b)), *a);
+      if (b != b_end && *b == *a) {
+        f(*a);
+        ++b;
+      }
+    }
+  }
 }
 
 #endif
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include <vector>
 #include "BinContainer.h"
 #include "NoMissSummary.h"
+#include "PhaseTimer.h"
 
 int main(int argc, char* argv[]) {
   // Check user input
@@ -69,6 +70,34 @@ int main(int argc, char* argv[]) {
     }
   }
 
+  std::string polished_sol = "Polished.sol";
+  if ((test = fopen(polished_sol.c_str(), "r")) != nullptr) {
+    fclose(test);
+    
+    noMissSummary::read_solution_from_file(polished_sol, rows_to_keep, cols_to_keep);
+
+    std::size_t tmp_num_elements = data.get_num_valid_data_kept(rows_to_keep, cols_to_keep);
+    if (tmp_num_elements > num_elements) {
+      best_rows_to_keep = rows_to_keep;
+      best_cols_to_keep = cols_to_keep;
+      num_elements = tmp_num_elements;
+    }
+  }
+
+  std::string decompose_sol = "Decompose.sol";
+  if ((test = fopen(decompose_sol.c_str(), "r")) != nullptr) {
+    fclose(test);
+    
+    noMissSummary::read_solution_from_file(decompose_sol, rows_to_keep, cols_to_keep);
+
+    std::size_t tmp_num_elements = data.get_num_valid_data_kept(rows_to_keep, cols_to_keep);
+    if (tmp_num_elements > num_elements) {
+      best_rows_to_keep = rows_to_keep;
+      best_cols_to_keep = cols_to_keep;
+      num_elements = tmp_num_elements;
+    }
+  }
+
   if (num_elements == 0) {
     fprintf(stderr, "ERROR - No valid solutions found\n");
     exit(1);
@@ -88,7 +117,8 @@ int main(int argc, char* argv[]) {
   for (auto c : best_cols_to_keep) {
     num_cols_kept += c;
   }
-  noMissSummary::write_stats_to_file("Best.csv", data_file, 0, num_elements, num_rows_kept, num_cols_kept);
+  noMissSummary::write_stats_to_file("Best.csv", data_file, 0, 0, num_elements, num_rows_kept, num_cols_kept);
+  PhaseTimer::write_to_file("WriteCleanedMatrix_phases.csv", data_file);
 
   return 0;
 }
\ No newline at end of file